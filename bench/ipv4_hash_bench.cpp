@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <nothing/ipv4_address.h>
+
+/*
+ * Compares std::hash<ipv4_address> with hashing the address as its integer
+ * value, on keys shaped like real traffic: a few hosts in each of many /24s,
+ * spread over the upper octets.
+ *
+ * Both are measured in std::unordered_map, which uses prime bucket counts,
+ * and in a linear-probing table with a power-of-two bucket count, where only
+ * the low bits of the hash pick the bucket.
+ */
+
+namespace {
+
+struct identity_hash {
+    std::size_t operator()(const nothing::ipv4_address &addr) const noexcept
+    {
+        return addr.to_uint();
+    }
+};
+
+// Open addressing on the low bits of the hash, like most flat hash maps.
+template <class Hash>
+class pow2_table {
+  public:
+    explicit pow2_table(std::size_t capacity)
+        : _slots(std::bit_ceil(2 * capacity)), _mask(_slots.size() - 1)
+    {
+    }
+
+    void insert(nothing::ipv4_address addr, int value)
+    {
+        std::size_t i = Hash{}(addr) & _mask;
+
+        while (_slots[i].used && _slots[i].addr != addr) {
+            i = (i + 1) & _mask;
+        }
+
+        _slots[i] = { addr, value, true };
+    }
+
+    const int *find(nothing::ipv4_address addr) const
+    {
+        std::size_t i = Hash{}(addr) & _mask;
+
+        for (; _slots[i].used; i = (i + 1) & _mask) {
+            if (_slots[i].addr == addr) {
+                return &_slots[i].value;
+            }
+        }
+
+        return nullptr;
+    }
+
+  private:
+    struct slot {
+        nothing::ipv4_address addr;
+        int value;
+        bool used;
+    };
+
+    std::vector<slot> _slots;
+    std::size_t _mask;
+};
+
+constexpr int rounds = 4;
+
+template <class Fn>
+double ns_per_op(std::size_t ops, Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double, std::nano> time =
+        std::chrono::steady_clock::now() - start;
+
+    return time.count() / ops;
+}
+
+template <class Hash>
+void run(const char *name, const std::vector<nothing::ipv4_address> &keys)
+{
+    long sum = 0;
+
+    std::unordered_map<nothing::ipv4_address, int, Hash> map;
+    double map_insert = ns_per_op(keys.size(), [&] {
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            map[keys[i]] = i;
+        }
+    });
+    double map_find = ns_per_op(rounds * keys.size(), [&] {
+        for (int r = 0; r < rounds; r++) {
+            for (auto addr : keys) {
+                sum += map.find(addr)->second;
+            }
+        }
+    });
+
+    pow2_table<Hash> table(keys.size());
+    double table_insert = ns_per_op(keys.size(), [&] {
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            table.insert(keys[i], i);
+        }
+    });
+    double table_find = ns_per_op(rounds * keys.size(), [&] {
+        for (int r = 0; r < rounds; r++) {
+            for (auto addr : keys) {
+                sum += *table.find(addr);
+            }
+        }
+    });
+
+    std::printf("%-10s unordered_map insert %6.1f ns find %6.1f ns | "
+                "pow2 table insert %8.1f ns find %8.1f ns (%ld)\n",
+                name, map_insert, map_find, table_insert, table_find, sum);
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(2);
+    std::vector<nothing::ipv4_address> keys;
+
+    // Kept small enough that the identity hash, whose keys all probe from a
+    // few hundred buckets of the power-of-two table, still finishes quickly.
+    for (int i = 0; i < 40000; i++) {
+        uint32_t net = rng() % 4096 << 20 | rng() % 64 << 8;
+        keys.push_back(net | (1 + rng() % 4));
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::printf("%zu keys\n", keys.size());
+
+    run<identity_hash>("identity", keys);
+    run<std::hash<nothing::ipv4_address>>("std::hash", keys);
+}
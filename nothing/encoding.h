@@ -5,12 +5,30 @@
 #define NOTHING_ENCODING_H_
 
 #include <iostream>
+#include <array>
+#include <bit>
+#include <new>
+#include <numeric>
 #include <string>
 #include <algorithm>
 #include <iterator>
 #include <concepts>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <system_error>
 #include <string_view>
 #include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <nothing/ascii.h>
+#include <nothing/unaligned.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace nothing {
 
@@ -30,6 +48,34 @@ template <class R>
 concept input_byte_range = std::ranges::range<R> &&
     input_byte_iterator<std::ranges::iterator_t<R>>;
 
+// Result of the non-throwing decoders. On failure `ec` is set, `in` points
+// at the offending character (or the end of input, if the input was
+// truncated) and `offset` is its distance from the start of the input.
+// Exceptions thrown by the output iterator still propagate.
+template <class I, class O>
+struct decode_result : std::ranges::in_out_result<I, O> {
+    std::errc ec;
+    std::size_t offset;
+};
+
+// Result of the validate-only functions.
+template <class I>
+struct validate_result {
+    [[no_unique_address]] I in;
+    std::errc ec;
+    std::size_t offset;
+};
+
+// Selects the multi-threaded overloads of the codecs, which split contiguous
+// input on group boundaries and encode or decode the pieces concurrently
+// into one preallocated output. A thread count of zero uses
+// std::thread::hardware_concurrency().
+struct parallel_policy {
+    unsigned threads = 0;
+};
+
+inline constexpr parallel_policy parallel{};
+
 enum class hex_mode {
     upper,
     lower,
@@ -37,37 +83,455 @@ enum class hex_mode {
 
 namespace detail {
 
+// Builds the reverse lookup table of a charset, mapping each character to its
+// index and every other character to 0xFF. Characters of `alternate` map to
+// the index of the character at the same position, e.g. for case-insensitive
+// alphabets.
+constexpr std::array<uint8_t, 256>
+make_charset_values(std::string_view charset,
+                    std::string_view alternate = {}) noexcept
+{
+    std::array<uint8_t, 256> values{};
+    values.fill(0xFF);
+
+    for (std::size_t i = 0; i < alternate.size(); i++) {
+        values[static_cast<unsigned char>(alternate[i])] = i;
+    }
+
+    for (std::size_t i = 0; i < charset.size(); i++) {
+        values[static_cast<unsigned char>(charset[i])] = i;
+    }
+
+    return values;
+}
+
+template <const std::string_view &Charset>
+inline constexpr std::array<uint8_t, 256> charset_values =
+    make_charset_values(Charset);
+
 template <hex_mode Mode>
 inline constexpr std::string_view hex_charset =
     Mode == hex_mode::upper ? "0123456789ABCDEF" : "0123456789abcdef";
 
-inline constexpr uint8_t hex_values[256]{
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF,
+inline constexpr std::array<uint8_t, 256> hex_values = make_charset_values(
+    hex_charset<hex_mode::upper>, hex_charset<hex_mode::lower>);
+
+// Byte-sized contiguous ranges that the bulk kernels below may access through
+// raw pointers.
+template <class I>
+concept contiguous_byte_iterator = std::contiguous_iterator<I> &&
+    sizeof(std::iter_value_t<I>) == 1;
+
+template <class I, class S>
+concept contiguous_byte_input =
+    contiguous_byte_iterator<I> && std::sized_sentinel_for<S, I>;
+
+template <class O>
+concept contiguous_byte_output = contiguous_byte_iterator<O> &&
+    !std::is_const_v<std::remove_reference_t<std::iter_reference_t<O>>>;
+
+// Whether values of type `T` can be written through `O` without throwing.
+// The non-throwing decoders are only noexcept when this holds.
+template <class O, class T>
+inline constexpr bool nothrow_output =
+    std::is_nothrow_move_constructible_v<O> &&
+    noexcept(*std::declval<O &>()++ = std::declval<T>());
+
+template <class T, class I>
+T *byte_pointer(I pos) noexcept
+{
+    return reinterpret_cast<T *>(std::to_address(pos));
+}
+
+// Output iterator that drops everything written through it, used to run the
+// decoders in validate-only mode.
+struct discard_iterator {
+    using difference_type = std::ptrdiff_t;
+
+    constexpr discard_iterator &operator*() noexcept { return *this; }
+    constexpr discard_iterator &operator++() noexcept { return *this; }
+    constexpr discard_iterator operator++(int) noexcept { return *this; }
+
+    template <class T>
+    constexpr discard_iterator &operator=(const T &) noexcept
+    {
+        return *this;
+    }
+};
+
+// Output iterator that breaks its output into lines of `width` characters.
+// Line breaks only ever go between lines, so no newline follows the last one.
+// A width of zero disables wrapping.
+template <class O>
+class line_wrap_iterator {
+  public:
+    using difference_type = std::ptrdiff_t;
+
+    constexpr line_wrap_iterator(O dest, std::size_t width,
+                                 std::string_view newline) noexcept
+        : _dest(std::move(dest)), _width(width), _newline(newline)
+    {
+    }
+
+    constexpr line_wrap_iterator &operator*() noexcept { return *this; }
+    constexpr line_wrap_iterator &operator++() noexcept { return *this; }
+    constexpr line_wrap_iterator &operator++(int) noexcept { return *this; }
+
+    constexpr line_wrap_iterator &operator=(char c)
+    {
+        if (_width && _column == _width) {
+            _dest = std::ranges::copy(_newline, std::move(_dest)).out;
+            _column = 0;
+        }
+
+        *_dest++ = c;
+        _column++;
+
+        return *this;
+    }
+
+    constexpr O base() && { return std::move(_dest); }
+
+  private:
+    O _dest;
+    std::size_t _width;
+    std::size_t _column = 0;
+    std::string_view _newline;
 };
 
+// Runs a bulk decode kernel ahead of the generic loop. Output is written
+// directly when `dest` is contiguous and through a scratch buffer when it is
+// discarded, so validation also gets the vector kernels.
+template <std::size_t Chars, std::size_t Bytes, class Bulk, class I, class S,
+          class O>
+constexpr void
+decode_bulk(Bulk bulk, I &first, S last, O &dest, std::size_t &offset) noexcept
+{
+    if constexpr (contiguous_byte_input<I, S>) {
+        if (std::is_constant_evaluated()) {
+            return;
+        }
+
+        const char *src = byte_pointer<const char>(first);
+        std::size_t size = last - first;
+        std::size_t count = 0;
+
+        if constexpr (contiguous_byte_output<O>) {
+            count = bulk(src, size, byte_pointer<uint8_t>(dest));
+            dest += count / Chars * Bytes;
+        } else if constexpr (std::same_as<O, discard_iterator>) {
+            constexpr std::size_t block = 128 * Chars;
+            uint8_t scratch[128 * Bytes];
+
+            while (size - count >= block) {
+                std::size_t done = bulk(src + count, block, scratch);
+                count += done;
+
+                if (done != block) {
+                    break;
+                }
+            }
+
+            if (size - count < block) {
+                count += bulk(src + count, size - count, scratch);
+            }
+        }
+
+        first += count;
+        offset += count;
+    }
+}
+
+template <class A>
+concept char_allocator = std::same_as<typename A::value_type, char> &&
+    requires(A &alloc, std::size_t size) { alloc.allocate(size); };
+
+// Builds a string of at most `size` characters in one allocation. `fill`
+// writes through a raw pointer and returns the number of characters written;
+// it must not throw.
+template <class String, class Fill>
+String make_string(std::size_t size,
+                   const typename String::allocator_type &alloc, Fill fill)
+{
+    String str(alloc);
+
+#if defined(__cpp_lib_string_resize_and_overwrite)
+    str.resize_and_overwrite(
+        size, [&](char *data, std::size_t) noexcept { return fill(data); });
+#else
+    str.resize(size);
+    str.resize(fill(str.data()));
+#endif
+
+    return str;
+}
+
+template <class R>
+concept contiguous_byte_range = std::ranges::contiguous_range<R> &&
+    std::ranges::sized_range<R> &&
+    sizeof(std::ranges::range_value_t<R>) == 1;
+
+// Below this many input units per thread, the cost of starting a thread
+// outweighs the work it takes over.
+inline constexpr std::size_t parallel_min_chunk = 1 << 16;
+
+// Chunk length for splitting `size` input units across the threads of
+// `policy`, rounded to a multiple of `Group` so only the final chunk can
+// hold a partial group.
+template <std::size_t Group>
+std::size_t parallel_chunk_size(parallel_policy policy, std::size_t size)
+{
+    std::size_t threads = policy.threads ? policy.threads
+                                         : std::thread::hardware_concurrency();
+    std::size_t groups = size / Group;
+
+    threads = std::max<std::size_t>(threads, 1);
+
+    return std::max((groups + threads - 1) / threads * Group,
+                    parallel_min_chunk / Group * Group);
+}
+
+// Runs `fn(begin, end)` over consecutive chunks of [0, size), the first on
+// the calling thread and the rest on their own threads. `fn` must not throw.
+template <class Fn>
+void parallel_chunks(std::size_t size, std::size_t chunk, Fn fn)
+{
+    std::vector<std::jthread> workers;
+
+    for (std::size_t begin = chunk; begin < size; begin += chunk) {
+        workers.emplace_back(fn, begin, std::min(begin + chunk, size));
+    }
+
+    fn(0, std::min(chunk, size));
+}
+
+#if defined(__SSE2__)
+
+template <hex_mode Mode>
+inline __m128i hex_encode_nibbles(__m128i nibbles) noexcept
+{
+    constexpr char offset = hex_charset<Mode>[10] - '0' - 10;
+
+    __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+
+    return _mm_add_epi8(
+        _mm_add_epi8(nibbles, _mm_set1_epi8('0')),
+        _mm_and_si128(letters, _mm_set1_epi8(offset)));
+}
+
+// Maps sixteen hex characters to their values, accumulating any character
+// that is not a hex digit into `invalid`.
+inline __m128i hex_decode_chars(__m128i chars, __m128i &invalid) noexcept
+{
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    __m128i is_digit = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    __m128i is_alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    invalid = _mm_or_si128(
+        invalid, _mm_andnot_si128(_mm_or_si128(is_digit, is_alpha),
+                                  _mm_set1_epi8(-1)));
+
+    return _mm_or_si128(
+        _mm_and_si128(is_digit, _mm_sub_epi8(chars, _mm_set1_epi8('0'))),
+        _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+// Joins adjacent nibble pairs into one byte per 16-bit lane.
+inline __m128i hex_join_nibbles(__m128i values) noexcept
+{
+    return _mm_or_si128(
+        _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0xFF)), 4),
+        _mm_srli_epi16(values, 8));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline __m256i hex_decode_chars(__m256i chars, __m256i &invalid) noexcept
+{
+    __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+    __m256i is_digit = _mm256_andnot_si256(
+        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('9')),
+        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)));
+    __m256i is_alpha = _mm256_andnot_si256(
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('f')),
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)));
+
+    invalid = _mm256_or_si256(
+        invalid, _mm256_andnot_si256(_mm256_or_si256(is_digit, is_alpha),
+                                     _mm256_set1_epi8(-1)));
+
+    return _mm256_or_si256(
+        _mm256_and_si256(is_digit,
+                         _mm256_sub_epi8(chars, _mm256_set1_epi8('0'))),
+        _mm256_and_si256(is_alpha,
+                         _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+}
+
+inline __m256i hex_join_nibbles(__m256i values) noexcept
+{
+    return _mm256_or_si256(
+        _mm256_slli_epi16(_mm256_and_si256(values, _mm256_set1_epi16(0xFF)),
+                          4),
+        _mm256_srli_epi16(values, 8));
+}
+
+#endif
+
+// Encodes the longest prefix of `src` that the vector (or SWAR) kernels can
+// handle and returns the number of bytes consumed. The caller finishes the
+// remainder with the generic loop.
+template <hex_mode Mode>
+inline std::size_t
+hex_encode_bulk(const uint8_t *src, std::size_t size, char *dest) noexcept
+{
+    constexpr auto charset = hex_charset<Mode>;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i lut = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(charset.data())));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    for (; size - i >= 32; i += 32) {
+        __m256i in = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + i));
+        __m256i hi = _mm256_shuffle_epi8(
+            lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + 2 * i),
+                            _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + 2 * i + 32),
+                            _mm256_permute2x128_si256(a, b, 0x31));
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; size - i >= 16; i += 16) {
+        __m128i in =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i hi = hex_encode_nibbles<Mode>(
+            _mm_and_si128(_mm_srli_epi16(in, 4), _mm_set1_epi8(0x0F)));
+        __m128i lo = hex_encode_nibbles<Mode>(
+            _mm_and_si128(in, _mm_set1_epi8(0x0F)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i),
+                         _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 2 * i + 16),
+                         _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+
+    // SWAR: spread four bytes into eight nibble lanes, then add '0' and the
+    // letter offset to every lane holding a value above nine.
+    constexpr uint64_t offset = charset[10] - '0' - 10;
+
+    for (; size - i >= 4; i += 4) {
+        uint64_t x = unaligned_load_le32(src + i);
+
+        x = (x | x << 16) & 0x0000FFFF0000FFFF;
+        x = (x | x << 8) & 0x00FF00FF00FF00FF;
+        x = (x >> 4 & 0x000F000F000F000F) | (x << 8 & 0x0F000F000F000F00);
+
+        uint64_t letters = (x + 0x0606060606060606) >> 4 & 0x0101010101010101;
+        unaligned_store_le64(x + 0x3030303030303030 + letters * offset,
+                             dest + 2 * i);
+    }
+
+    return i;
+}
+
+// Decodes whole character pairs from `src` until the input is exhausted or a
+// block contains a non-hex character, and returns the number of characters
+// consumed. Invalid input is left for the generic loop to report.
+inline std::size_t
+hex_decode_bulk(const char *src, std::size_t size, uint8_t *dest) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; size - i >= 64; i += 64) {
+        __m256i invalid = _mm256_setzero_si256();
+        __m256i a = hex_decode_chars(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)),
+            invalid);
+        __m256i b = hex_decode_chars(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32)),
+            invalid);
+
+        if (!_mm256_testz_si256(invalid, invalid)) {
+            return i;
+        }
+
+        __m256i out = _mm256_packus_epi16(hex_join_nibbles(a),
+                                          hex_join_nibbles(b));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i / 2),
+                            _mm256_permute4x64_epi64(out, 0xD8));
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; size - i >= 32; i += 32) {
+        __m128i invalid = _mm_setzero_si128();
+        __m128i a = hex_decode_chars(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+            invalid);
+        __m128i b = hex_decode_chars(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16)),
+            invalid);
+
+        if (_mm_movemask_epi8(invalid)) {
+            return i;
+        }
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(dest + i / 2),
+            _mm_packus_epi16(hex_join_nibbles(a), hex_join_nibbles(b)));
+    }
+#endif
+
+    for (; size - i >= 8; i += 8) {
+        uint8_t values[8];
+        uint8_t check = 0;
+
+        for (int j = 0; j < 8; j++) {
+            values[j] = hex_values[static_cast<unsigned char>(src[i + j])];
+            check |= values[j];
+        }
+
+        if (check > 15) {
+            return i;
+        }
+
+        for (int j = 0; j < 4; j++) {
+            dest[i / 2 + j] = values[2 * j] << 4 | values[2 * j + 1];
+        }
+    }
+
+    return i;
+}
+
 } // namespace detail
 
+constexpr std::size_t hex_encoded_size(std::size_t size) noexcept
+{
+    return 2 * size;
+}
+
+constexpr std::size_t hex_decoded_size(std::size_t size) noexcept
+{
+    return (size + 1) / 2;
+}
+
 template <hex_mode Mode = hex_mode::upper, std::output_iterator<char> O>
 constexpr auto hex_encode(uint8_t value, O dest)
 {
@@ -85,6 +549,18 @@ template <hex_mode Mode = hex_mode::upper, input_byte_iterator I,
           std::sentinel_for<I> S, std::output_iterator<char> O>
 constexpr std::ranges::in_out_result<I, O> hex_encode(I first, S last, O dest)
 {
+    if constexpr (detail::contiguous_byte_input<I, S> &&
+                  detail::contiguous_byte_output<O>) {
+        if (!std::is_constant_evaluated()) {
+            std::size_t count = detail::hex_encode_bulk<Mode>(
+                detail::byte_pointer<const uint8_t>(first), last - first,
+                detail::byte_pointer<char>(dest));
+
+            first += count;
+            dest += 2 * count;
+        }
+    }
+
     for (; first != last; ++first) {
         uint8_t value = *first;
         dest = hex_encode<Mode>(value, dest);
@@ -109,21 +585,69 @@ constexpr uint8_t hex_decode(char c)
 
 template <input_string_iterator I, std::sentinel_for<I> S,
           std::output_iterator<uint8_t> O>
-constexpr std::ranges::in_out_result<I, O> hex_decode(I first, S last, O dest)
+constexpr decode_result<I, O>
+hex_decode(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
 {
-    while(first != last) {
-        uint8_t a = hex_decode(*first++);
-        uint8_t b = first != last ? hex_decode(*first++) : 0;
+    std::size_t offset = 0;
+
+    detail::decode_bulk<2, 1>(
+        [](const char *src, std::size_t size, uint8_t *out) {
+            return detail::hex_decode_bulk(src, size, out);
+        },
+        first, last, dest, offset);
+
+    while (first != last) {
+        uint8_t a = hex_decode(*first);
+
+        if (a > 15) {
+            return { { first, dest }, std::errc::invalid_argument, offset };
+        }
 
-        if(a > 15  || b > 15) {
-            throw std::invalid_argument(
-                "nothing::hex_decode: Invalid hex input");
+        ++first;
+        ++offset;
+
+        uint8_t b = 0;
+
+        if (first != last) {
+            b = hex_decode(*first);
+
+            if (b > 15) {
+                return { { first, dest }, std::errc::invalid_argument, offset };
+            }
+
+            ++first;
+            ++offset;
         }
 
         *dest++ = (a << 4) | b;
     }
 
-    return { first, dest };
+    return { { first, dest }, std::errc{}, offset };
+}
+
+template <input_string_range R, std::output_iterator<uint8_t> O>
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+hex_decode(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return hex_decode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
+}
+
+template <input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<I, O> hex_decode(I first, S last, O dest)
+{
+    auto res = hex_decode(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if(res.ec != std::errc{}) {
+        throw std::invalid_argument("nothing::hex_decode: Invalid hex input");
+    }
+
+    return { std::move(res.in), std::move(res.out) };
 }
 
 template <input_string_range R, std::output_iterator<uint8_t> O>
@@ -134,6 +658,106 @@ hex_decode(R &&r, O dest)
         std::ranges::begin(r), std::ranges::end(r), std::move(dest));
 }
 
+template <input_string_iterator I, std::sentinel_for<I> S>
+constexpr validate_result<I> hex_validate(I first, S last) noexcept
+{
+    auto res = hex_decode(
+        std::move(first), std::move(last), detail::discard_iterator{},
+        std::nothrow);
+
+    return { std::move(res.in), res.ec, res.offset };
+}
+
+template <input_string_range R>
+constexpr validate_result<std::ranges::borrowed_iterator_t<R>>
+hex_validate(R &&r) noexcept
+{
+    return hex_validate(std::ranges::begin(r), std::ranges::end(r));
+}
+
+template <hex_mode Mode = hex_mode::upper, input_byte_range R,
+          detail::char_allocator Allocator = std::allocator<char>>
+    requires std::ranges::sized_range<R>
+auto hex_encode(R &&r, const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    return detail::make_string<string_type>(
+        hex_encoded_size(std::ranges::size(r)), alloc, [&](char *data) {
+            return hex_encode<Mode>(r, data).out - data;
+        });
+}
+
+template <detail::char_allocator Allocator = std::allocator<char>>
+auto hex_decode(std::string_view src, const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    std::errc ec{};
+    string_type str = detail::make_string<string_type>(
+        hex_decoded_size(src.size()), alloc, [&](char *data) {
+            auto res = hex_decode(src, data, std::nothrow);
+            ec = res.ec;
+            return res.out - data;
+        });
+
+    if (ec != std::errc{}) {
+        throw std::invalid_argument("nothing::hex_decode: Invalid hex input");
+    }
+
+    return str;
+}
+
+template <hex_mode Mode = hex_mode::upper, input_byte_range R,
+          std::output_iterator<char> O>
+    requires detail::contiguous_byte_range<R> &&
+        detail::contiguous_byte_output<O>
+std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+hex_encode(parallel_policy policy, R &&r, O dest)
+{
+    std::size_t size = std::ranges::size(r);
+    const uint8_t *src = detail::byte_pointer<const uint8_t>(
+        std::ranges::begin(r));
+    char *out = detail::byte_pointer<char>(dest);
+
+    detail::parallel_chunks(
+        size, detail::parallel_chunk_size<1>(policy, size),
+        [=](std::size_t begin, std::size_t end) {
+            hex_encode<Mode>(src + begin, src + end, out + 2 * begin);
+        });
+
+    return { std::ranges::begin(r) + size, dest + hex_encoded_size(size) };
+}
+
+template <input_string_range R, std::output_iterator<uint8_t> O>
+    requires detail::contiguous_byte_range<R> &&
+        detail::contiguous_byte_output<O>
+std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+hex_decode(parallel_policy policy, R &&r, O dest)
+{
+    std::size_t size = std::ranges::size(r);
+    const char *src = detail::byte_pointer<const char>(std::ranges::begin(r));
+    uint8_t *out = detail::byte_pointer<uint8_t>(dest);
+    std::size_t chunk = detail::parallel_chunk_size<2>(policy, size);
+    std::vector<std::errc> errors(size / chunk + 1);
+
+    detail::parallel_chunks(
+        size, chunk, [&](std::size_t begin, std::size_t end) {
+            errors[begin / chunk] =
+                hex_decode(src + begin, src + end, out + begin / 2,
+                           std::nothrow)
+                    .ec;
+        });
+
+    if (std::ranges::any_of(errors, [](std::errc ec) { return bool(ec); })) {
+        throw std::invalid_argument("nothing::hex_decode: Invalid hex input");
+    }
+
+    return { std::ranges::begin(r) + size, dest + hex_decoded_size(size) };
+}
+
 enum class base64_mode {
     regular,
     url,
@@ -153,119 +777,700 @@ inline constexpr std::string_view base64_charset =
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" :
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
 
-inline constexpr uint8_t base64_values[256]{
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
-    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
-    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
-    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
-    0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
-    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF,
-};
+inline constexpr const auto &base64_values =
+    charset_values<base64_charset<base64_mode::regular>>;
 
-inline constexpr uint8_t base64url_values[256]{
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
-    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
-    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
-    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
-    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
-    0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
-    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF,
-};
+inline constexpr const auto &base64url_values =
+    charset_values<base64_charset<base64_mode::url>>;
 
-class base64_decode_error : public std::invalid_argument {
-    const char* what() const noexcept override
+// Codec engine for alphabets of 2^N characters. Input is taken in groups of
+// `group_bytes` bytes, each written as `group_chars` characters of N bits;
+// a short final group is padded with '=' up to `group_chars` when padding is
+// enabled. All group arithmetic is resolved at compile time per alphabet.
+template <const std::string_view &Charset>
+struct block_codec {
+    static_assert(std::has_single_bit(Charset.size()) && Charset.size() > 1 &&
+                  Charset.size() <= 256);
+
+    static constexpr int bits = std::countr_zero(Charset.size());
+    static constexpr int group_bytes = std::lcm(8, bits) / 8;
+    static constexpr int group_chars = std::lcm(8, bits) / bits;
+    static constexpr uint64_t mask = (uint64_t{ 1 } << bits) - 1;
+    static constexpr const auto &values = charset_values<Charset>;
+
+    template <bool Pad, class I, class S, class O>
+    static constexpr std::ranges::in_out_result<I, O>
+    encode(I first, S last, O dest)
     {
-        return "nothing::base64_decode: Invalid base64 input";
-    }
-};
+        for (;;) {
+            uint64_t group = 0;
+            int size = 0;
 
-} // namespace detail
+            for (; size < group_bytes && first != last; ++first, ++size) {
+                uint8_t value = *first;
+                group = group << 8 | value;
+            }
 
-template <base64_mode Mode = base64_mode::regular,
-          base64_padding Padding = base64_padding::optional,
-          input_byte_iterator I, std::sentinel_for<I> S,
-          std::output_iterator<char> O>
-constexpr std::ranges::in_out_result<I, O>
-base64_encode(I first, S last, O dest)
-{
-    constexpr auto charset = detail::base64_charset<Mode>;
-    constexpr auto padding = Padding != base64_padding::none;
+            if (size == 0) {
+                break;
+            }
 
-    for(; first != last ;) {
-        uint8_t a = *first++;
+            group <<= 8 * (group_bytes - size);
 
-        if(first == last) {
-            *dest++ = charset[a >> 2];
-            *dest++ = charset[(a & 0x3) << 4];
+            int chars = (8 * size + bits - 1) / bits;
 
-            if constexpr (padding) {
-                *dest++ = '=';
-                *dest++ = '=';
+            for (int i = 0; i < chars; i++) {
+                *dest++ = Charset[group >> bits * (group_chars - 1 - i) & mask];
             }
 
-            break;
+            if (size < group_bytes) {
+                if constexpr (Pad) {
+                    for (int i = chars; i < group_chars; i++) {
+                        *dest++ = '=';
+                    }
+                }
+
+                break;
+            }
         }
 
-        uint8_t b = *first++;
+        return { first, dest };
+    }
 
-        if(first == last) {
-            *dest++ = charset[a >> 2];
-            *dest++ = charset[(a & 0x3) << 4 | b >> 4];
-            *dest++ = charset[(b & 0xF) << 2];
+    // `offset` is the position of `first` within the whole input, used for
+    // error reporting. With `SkipSpace`, characters matching ascii_isspace()
+    // are ignored wherever they appear.
+    template <base64_padding Padding, bool SkipSpace = false, class I, class S,
+              class O>
+    static constexpr decode_result<I, O>
+    decode(I first, S last, O dest, std::size_t offset = 0) noexcept(
+        nothrow_output<O, uint8_t>)
+    {
+        for (;;) {
+            uint64_t group = 0;
+            int size = 0;
+            std::size_t mark = offset;
 
-            if constexpr (padding) {
-                *dest++ = '=';
-            }
+            for (; size < group_chars && first != last; ++first, ++offset) {
+                char c = *first;
 
-            break;
-        }
+                if (c == '=') {
+                    break;
+                }
 
-        uint8_t c = *first++;
-        *dest++ = charset[a >> 2];
-        *dest++ = charset[(a & 0x3) << 4 | b >> 4];
-        *dest++ = charset[(b & 0xF) << 2 | c >> 6];
-        *dest++ = charset[c & 0x3F];
-    }
+                if constexpr (SkipSpace) {
+                    if (ascii_isspace(c)) {
+                        continue;
+                    }
+                }
 
-    return { first, dest };
-}
+                uint8_t value = values[static_cast<unsigned char>(c)];
 
-template <base64_mode Mode = base64_mode::regular,
-          base64_padding Padding = base64_padding::optional,
-          input_byte_range R, std::output_iterator<char> O>
-constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
-base64_encode(R &&r, O dest)
+                if (value == 0xFF) {
+                    return { { first, dest }, std::errc::invalid_argument,
+                             offset };
+                }
+
+                group = group << bits | value;
+                mark = offset;
+                size++;
+            }
+
+            if (size == group_chars) {
+                for (int i = group_bytes - 1; i >= 0; i--) {
+                    *dest++ = static_cast<uint8_t>(group >> 8 * i);
+                }
+
+                continue;
+            }
+
+            if (size == 0 && first == last) {
+                break;
+            }
+
+            // A short group must hold a whole number of bytes, written with
+            // the fewest characters and no set bits past the last byte.
+            int bytes = size * bits / 8;
+            int extra = size * bits - 8 * bytes;
+
+            if (!bytes || (8 * bytes + bits - 1) / bits != size) {
+                return { { first, dest }, std::errc::invalid_argument, offset };
+            }
+
+            if (group & ((uint64_t{ 1 } << extra) - 1)) {
+                return { { first, dest }, std::errc::invalid_argument, mark };
+            }
+
+            int padding = 0;
+
+            for (; first != last; ++first, ++offset) {
+                char c = *first;
+
+                if constexpr (SkipSpace) {
+                    if (ascii_isspace(c)) {
+                        continue;
+                    }
+                }
+
+                if (c != '=' || Padding == base64_padding::none ||
+                    size + padding == group_chars) {
+                    return { { first, dest }, std::errc::invalid_argument,
+                             offset };
+                }
+
+                padding++;
+            }
+
+            if (padding ? size + padding != group_chars
+                        : Padding == base64_padding::required) {
+                return { { first, dest }, std::errc::invalid_argument, offset };
+            }
+
+            group >>= extra;
+
+            for (int i = bytes - 1; i >= 0; i--) {
+                *dest++ = static_cast<uint8_t>(group >> 8 * i);
+            }
+
+            break;
+        }
+
+        return { { first, dest }, std::errc{}, offset };
+    }
+};
+
+// Codec engine for alphabets of any size, treating the whole input as one
+// big-endian number written in base `Charset.size()`. Leading zero bytes map
+// one-to-one to leading `Charset[0]` characters. Arithmetic runs on 32-bit
+// limbs, each step folding in as many digits or bytes as fit in 64 bits.
+template <const std::string_view &Charset>
+struct bignum_codec {
+    static_assert(Charset.size() > 1 && Charset.size() <= 256);
+
+    static constexpr uint64_t radix = Charset.size();
+    static constexpr const auto &values = charset_values<Charset>;
+
+    // Largest power of the radix below 2^32, and its exponent.
+    static constexpr int limb_digits = [] {
+        int digits = 0;
+
+        for (uint64_t power = radix; power < (uint64_t{ 1 } << 32);
+             power *= radix) {
+            digits++;
+        }
+
+        return digits;
+    }();
+
+    static constexpr uint64_t limb_radix = [] {
+        uint64_t power = 1;
+
+        for (int i = 0; i < limb_digits; i++) {
+            power *= radix;
+        }
+
+        return power;
+    }();
+
+    template <class I, class S, class O>
+    static constexpr std::ranges::in_out_result<I, O>
+    encode(I first, S last, O dest)
+    {
+        // Little-endian limbs in base `limb_radix`.
+        std::vector<uint32_t> limbs;
+
+        for (; first != last; ++first) {
+            uint8_t value = *first;
+
+            if (value) {
+                break;
+            }
+
+            *dest++ = Charset[0];
+        }
+
+        while (first != last) {
+            uint64_t carry = 0;
+            int size = 0;
+
+            for (; size < 4 && first != last; ++first, ++size) {
+                uint8_t value = *first;
+                carry = carry << 8 | value;
+            }
+
+            for (uint32_t &limb : limbs) {
+                carry += static_cast<uint64_t>(limb) << 8 * size;
+                limb = carry % limb_radix;
+                carry /= limb_radix;
+            }
+
+            for (; carry; carry /= limb_radix) {
+                limbs.push_back(carry % limb_radix);
+            }
+        }
+
+        for (auto it = limbs.rbegin(); it != limbs.rend(); ++it) {
+            char digits[limb_digits];
+            uint32_t limb = *it;
+
+            for (int i = limb_digits - 1; i >= 0; i--, limb /= radix) {
+                digits[i] = Charset[limb % radix];
+            }
+
+            // The most significant limb is written without leading zeros.
+            int skip = 0;
+
+            if (it == limbs.rbegin()) {
+                while (skip < limb_digits - 1 && digits[skip] == Charset[0]) {
+                    skip++;
+                }
+            }
+
+            dest = std::copy(digits + skip, digits + limb_digits, dest);
+        }
+
+        return { first, dest };
+    }
+
+    template <class I, class S, class O>
+    static constexpr decode_result<I, O>
+    decode(I first, S last, O dest) noexcept(nothrow_output<O, uint8_t>)
+    {
+        std::size_t offset = 0;
+
+        for (; first != last && *first == Charset[0]; ++first, ++offset) {
+            *dest++ = uint8_t{ 0 };
+        }
+
+        // Little-endian limbs in base 2^32. Growing them is the only step
+        // that allocates; running out of memory is reported like bad input.
+        std::vector<uint32_t> limbs;
+
+        while (first != last) {
+            uint64_t carry = 0;
+            uint64_t scale = 1;
+
+            for (int i = 0; i < limb_digits && first != last;
+                 i++, ++first, ++offset) {
+                uint8_t value = values[static_cast<unsigned char>(*first)];
+
+                if (value == 0xFF) {
+                    return { { first, dest }, std::errc::invalid_argument,
+                             offset };
+                }
+
+                carry = carry * radix + value;
+                scale *= radix;
+            }
+
+            for (uint32_t &limb : limbs) {
+                carry += limb * scale;
+                limb = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+
+            if (carry) {
+                try {
+                    limbs.push_back(carry);
+                } catch (const std::bad_alloc &) {
+                    return { { first, dest }, std::errc::not_enough_memory,
+                             offset };
+                }
+            }
+        }
+
+        for (auto it = limbs.rbegin(); it != limbs.rend(); ++it) {
+            int shift = 24;
+
+            if (it == limbs.rbegin()) {
+                while (shift && !(*it >> shift)) {
+                    shift -= 8;
+                }
+            }
+
+            for (; shift >= 0; shift -= 8) {
+                *dest++ = static_cast<uint8_t>(*it >> shift);
+            }
+        }
+
+        return { { first, dest }, std::errc{}, offset };
+    }
+};
+
+class base64_decode_error : public std::invalid_argument {
+  public:
+    base64_decode_error()
+        : std::invalid_argument("nothing::base64_decode: Invalid base64 input")
+    {
+    }
+
+    const char *what() const noexcept override
+    {
+        return "nothing::base64_decode: Invalid base64 input";
+    }
+};
+
+template <base64_mode Mode>
+inline constexpr const auto &base64_mode_values =
+    charset_values<base64_charset<Mode>>;
+
+#if defined(__AVX2__)
+
+// Maps thirty-two base64 characters to their 6-bit values, accumulating any
+// character outside the alphabet of `Mode` (including '=') into `invalid`.
+template <base64_mode Mode>
+inline __m256i base64_decode_chars(__m256i chars, __m256i &invalid) noexcept
+{
+    constexpr char char62 = base64_charset<Mode>[62];
+    constexpr char char63 = base64_charset<Mode>[63];
+
+    auto in_range = [chars](char low, char high) {
+        return _mm256_andnot_si256(
+            _mm256_cmpgt_epi8(chars, _mm256_set1_epi8(high)),
+            _mm256_cmpgt_epi8(chars, _mm256_set1_epi8(low - 1)));
+    };
+
+    __m256i upper = in_range('A', 'Z');
+    __m256i lower = in_range('a', 'z');
+    __m256i digit = in_range('0', '9');
+    __m256i is62 = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(char62));
+    __m256i is63 = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(char63));
+
+    __m256i valid = _mm256_or_si256(
+        _mm256_or_si256(upper, lower),
+        _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+
+    __m256i offset = _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+            _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+        _mm256_or_si256(
+            _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+            _mm256_or_si256(
+                _mm256_and_si256(is62, _mm256_set1_epi8(62 - char62)),
+                _mm256_and_si256(is63, _mm256_set1_epi8(63 - char63)))));
+
+    invalid = _mm256_or_si256(
+        invalid, _mm256_andnot_si256(valid, _mm256_set1_epi8(-1)));
+
+    return _mm256_add_epi8(chars, offset);
+}
+
+// Packs thirty-two 6-bit values into twenty-four bytes, leaving them in the
+// low bytes of the result.
+inline __m256i base64_pack_values(__m256i values) noexcept
+{
+    values = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    values = _mm256_madd_epi16(values, _mm256_set1_epi32(0x00011000));
+    values = _mm256_shuffle_epi8(
+        values,
+        _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                         2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1,
+                         -1));
+
+    return _mm256_permutevar8x32_epi32(
+        values, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+}
+
+#endif
+
+#if defined(__SSSE3__)
+
+// Splits each group of three bytes, arranged by the caller as [b1 b0 b2 b1]
+// in a 32-bit lane, into four 6-bit indices.
+inline __m128i base64_split_groups(__m128i in) noexcept
+{
+    __m128i hi = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i lo = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+                                 _mm_set1_epi32(0x01000010));
+
+    return _mm_or_si128(hi, lo);
+}
+
+// Translates 6-bit indices to the charset of `Mode` by selecting, per index
+// range, the offset to add.
+template <base64_mode Mode>
+inline __m128i base64_encode_shifts() noexcept
+{
+    constexpr auto charset = base64_charset<Mode>;
+
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, charset[62] - 62, charset[63] - 63, 'A', 0,
+                         0);
+}
+
+template <base64_mode Mode>
+inline __m128i base64_encode_indices(__m128i indices) noexcept
+{
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+    return _mm_add_epi8(
+        indices, _mm_shuffle_epi8(base64_encode_shifts<Mode>(), range));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline __m256i base64_split_groups(__m256i in) noexcept
+{
+    __m256i hi = _mm256_mulhi_epu16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)),
+        _mm256_set1_epi32(0x04000040));
+    __m256i lo = _mm256_mullo_epi16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)),
+        _mm256_set1_epi32(0x01000010));
+
+    return _mm256_or_si256(hi, lo);
+}
+
+template <base64_mode Mode>
+inline __m256i base64_encode_indices(__m256i indices) noexcept
+{
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+
+    range = _mm256_or_si256(range,
+                            _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+
+    return _mm256_add_epi8(
+        indices,
+        _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(base64_encode_shifts<Mode>()), range));
+}
+
+#endif
+
+// Encodes whole groups of three bytes from `src` and returns the number of
+// bytes consumed, always a multiple of three. The final partial group and its
+// padding are left to the generic loop.
+template <base64_mode Mode>
+inline std::size_t
+base64_encode_bulk(const uint8_t *src, std::size_t size, char *dest) noexcept
+{
+    constexpr auto charset = base64_charset<Mode>;
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    const __m128i arrange =
+        _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+#endif
+
+#if defined(__AVX2__)
+    // Each half is loaded as sixteen bytes of which twelve are used, so keep
+    // four bytes of slack past the second load.
+    for (; size - i >= 28; i += 24) {
+        __m256i in = _mm256_setr_m128i(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12)));
+
+        in = _mm256_shuffle_epi8(in, _mm256_broadcastsi128_si256(arrange));
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(dest + i / 3 * 4),
+            base64_encode_indices<Mode>(base64_split_groups(in)));
+    }
+#endif
+
+#if defined(__SSSE3__)
+    for (; size - i >= 16; i += 12) {
+        __m128i in = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+            arrange);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i / 3 * 4),
+                         base64_encode_indices<Mode>(base64_split_groups(in)));
+    }
+#endif
+
+    for (; size - i >= 3; i += 3) {
+        uint32_t group = src[i] << 16 | src[i + 1] << 8 | src[i + 2];
+        char *pos = dest + i / 3 * 4;
+
+        pos[0] = charset[group >> 18];
+        pos[1] = charset[group >> 12 & 0x3F];
+        pos[2] = charset[group >> 6 & 0x3F];
+        pos[3] = charset[group & 0x3F];
+    }
+
+    return i;
+}
+
+// Decodes whole groups of four characters from `src` until fewer than four
+// remain or a group contains a character outside the alphabet, and returns
+// the number of characters consumed. Padding, the final partial group and
+// error reporting are left to the generic loop.
+template <base64_mode Mode>
+inline std::size_t
+base64_decode_bulk(const char *src, std::size_t size, uint8_t *dest) noexcept
+{
+    constexpr auto values = base64_mode_values<Mode>;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; size - i >= 32; i += 32) {
+        __m256i invalid = _mm256_setzero_si256();
+        __m256i chars = base64_decode_chars<Mode>(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)),
+            invalid);
+
+        if (!_mm256_testz_si256(invalid, invalid)) {
+            break;
+        }
+
+        __m256i out = base64_pack_values(chars);
+        uint8_t *pos = dest + i / 4 * 3;
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pos),
+                         _mm256_castsi256_si128(out));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(pos + 16),
+                         _mm256_extracti128_si256(out, 1));
+    }
+#endif
+
+    for (; size - i >= 4; i += 4) {
+        uint8_t a = values[static_cast<unsigned char>(src[i])];
+        uint8_t b = values[static_cast<unsigned char>(src[i + 1])];
+        uint8_t c = values[static_cast<unsigned char>(src[i + 2])];
+        uint8_t d = values[static_cast<unsigned char>(src[i + 3])];
+
+        if ((a | b | c | d) > 63) {
+            break;
+        }
+
+        uint32_t group = a << 18 | b << 12 | c << 6 | d;
+        uint8_t *pos = dest + i / 4 * 3;
+
+        pos[0] = group >> 16;
+        pos[1] = group >> 8;
+        pos[2] = group;
+    }
+
+    return i;
+}
+
+// Decodes base64 from `src` that may be interrupted by whitespace, as in
+// line-wrapped MIME or PEM bodies, and returns the number of characters
+// consumed, always ending on a group boundary. The number of bytes written is
+// stored in `written`. Whitespace only appears at line ends, so the plain
+// kernel runs over each line and the one group spanning a break is stitched
+// together here; padding, the final group and error reporting are left to
+// the generic loop.
+template <base64_mode Mode>
+inline std::size_t base64_decode_wrapped_bulk(const char *src,
+                                              std::size_t size, uint8_t *dest,
+                                              std::size_t &written) noexcept
+{
+    constexpr auto values = base64_mode_values<Mode>;
+    std::size_t i = 0;
+    uint8_t *pos = dest;
+
+    for (;;) {
+        std::size_t count = base64_decode_bulk<Mode>(src + i, size - i, pos);
+
+        i += count;
+        pos += count / 4 * 3;
+
+        uint32_t group = 0;
+        int chars = 0;
+        std::size_t j = i;
+
+        for (; chars < 4 && j < size; j++) {
+            if (ascii_isspace(src[j])) {
+                continue;
+            }
+
+            uint8_t value = values[static_cast<unsigned char>(src[j])];
+
+            if (value > 63) {
+                break;
+            }
+
+            group = group << 6 | value;
+            chars++;
+        }
+
+        if (chars < 4) {
+            break;
+        }
+
+        pos[0] = group >> 16;
+        pos[1] = group >> 8;
+        pos[2] = group;
+        pos += 3;
+        i = j;
+    }
+
+    written = pos - dest;
+
+    return i;
+}
+
+} // namespace detail
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional>
+constexpr std::size_t base64_encoded_size(std::size_t size) noexcept
+{
+    if constexpr (Padding == base64_padding::none) {
+        return size / 3 * 4 + (size % 3 ? size % 3 + 1 : 0);
+    } else {
+        return (size + 2) / 3 * 4;
+    }
+}
+
+// Upper bound on the decoded size of `size` characters of base64.
+constexpr std::size_t base64_decoded_size_max(std::size_t size) noexcept
+{
+    return size / 4 * 3 + size % 4 * 3 / 4;
+}
+
+// Exact decoded size of `src`, provided it is valid base64.
+constexpr std::size_t base64_decoded_size(std::string_view src) noexcept
+{
+    std::size_t size = src.size();
+
+    for (int i = 0; i < 2 && size && src[size - 1] == '='; i++) {
+        size--;
+    }
+
+    return base64_decoded_size_max(size);
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+base64_encode(I first, S last, O dest)
+{
+    if constexpr (detail::contiguous_byte_input<I, S> &&
+                  detail::contiguous_byte_output<O>) {
+        if (!std::is_constant_evaluated()) {
+            std::size_t count = detail::base64_encode_bulk<Mode>(
+                detail::byte_pointer<const uint8_t>(first), last - first,
+                detail::byte_pointer<char>(dest));
+
+            first += count;
+            dest += count / 3 * 4;
+        }
+    }
+
+    return detail::block_codec<detail::base64_charset<Mode>>::template encode<
+        Padding != base64_padding::none>(std::move(first), std::move(last),
+                                         std::move(dest));
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_range R, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_encode(R &&r, O dest)
 {
     return base64_encode<Mode, Padding>(
         std::ranges::begin(r), std::ranges::end(r), std::move(dest));
@@ -275,20 +1480,1008 @@ template <base64_mode Mode = base64_mode::regular,
           base64_padding Padding = base64_padding::optional,
           input_string_iterator I, std::sentinel_for<I> S,
           std::output_iterator<uint8_t> O>
-constexpr std::ranges::in_out_result<I, O>
-base64_decode(I first, S last, O dest);
+constexpr decode_result<I, O>
+base64_decode(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    std::size_t offset = 0;
+
+    detail::decode_bulk<4, 3>(
+        [](const char *src, std::size_t size, uint8_t *out) {
+            return detail::base64_decode_bulk<Mode>(src, size, out);
+        },
+        first, last, dest, offset);
+
+    return detail::block_codec<detail::base64_charset<Mode>>::template decode<
+        Padding>(std::move(first), std::move(last), std::move(dest), offset);
+}
 
 template <base64_mode Mode = base64_mode::regular,
           base64_padding Padding = base64_padding::optional,
           input_string_range R, std::output_iterator<uint8_t> O>
-constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
-base64_decode(R &&r, O dest)
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_decode(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
 {
     return base64_decode<Mode, Padding>(
-        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
 }
 
-// clang-format on
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<I, O>
+base64_decode(I first, S last, O dest)
+{
+    auto res = base64_decode<Mode, Padding>(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if (res.ec != std::errc{}) {
+        throw detail::base64_decode_error{};
+    }
+
+    return { std::move(res.in), std::move(res.out) };
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_decode(R &&r, O dest)
+{
+    return base64_decode<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S>
+constexpr validate_result<I> base64_validate(I first, S last) noexcept
+{
+    auto res = base64_decode<Mode, Padding>(
+        std::move(first), std::move(last), detail::discard_iterator{},
+        std::nothrow);
+
+    return { std::move(res.in), res.ec, res.offset };
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R>
+constexpr validate_result<std::ranges::borrowed_iterator_t<R>>
+base64_validate(R &&r) noexcept
+{
+    return base64_validate<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r));
+}
+
+// Encodes base64 broken into lines of `width` characters, as in MIME (the
+// default) or PEM (64 characters, "\n"). No newline follows the last line.
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+base64_encode_wrapped(I first, S last, O dest, std::size_t width = 76,
+                      std::string_view newline = "\r\n")
+{
+    if (!width) {
+        return base64_encode<Mode, Padding>(
+            std::move(first), std::move(last), std::move(dest));
+    }
+
+    if constexpr (detail::contiguous_byte_input<I, S> &&
+                  detail::contiguous_byte_output<O>) {
+        // Lines holding whole groups are encoded straight into place.
+        if (!std::is_constant_evaluated() && width % 4 == 0) {
+            const uint8_t *src = detail::byte_pointer<const uint8_t>(first);
+            char *out = detail::byte_pointer<char>(dest);
+            std::size_t size = last - first;
+            std::size_t line = width / 4 * 3;
+            std::size_t i = 0;
+
+            for (; size - i > line; i += line) {
+                detail::base64_encode_bulk<Mode>(src + i, line, out);
+                out = std::ranges::copy(newline, out + width).out;
+            }
+
+            first += i;
+            dest += out - detail::byte_pointer<char>(dest);
+
+            return base64_encode<Mode, Padding>(
+                std::move(first), std::move(last), std::move(dest));
+        }
+    }
+
+    auto res = base64_encode<Mode, Padding>(
+        std::move(first), std::move(last),
+        detail::line_wrap_iterator<O>(std::move(dest), width, newline));
+
+    return { std::move(res.in), std::move(res.out).base() };
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_range R, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_encode_wrapped(R &&r, O dest, std::size_t width = 76,
+                      std::string_view newline = "\r\n")
+{
+    return base64_encode_wrapped<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest), width,
+        newline);
+}
+
+// Decodes base64 ignoring any whitespace, such as the line breaks of MIME or
+// PEM bodies.
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr decode_result<I, O>
+base64_decode_wrapped(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    std::size_t offset = 0;
+
+    if constexpr (detail::contiguous_byte_input<I, S> &&
+                  detail::contiguous_byte_output<O>) {
+        if (!std::is_constant_evaluated()) {
+            std::size_t written;
+            std::size_t count = detail::base64_decode_wrapped_bulk<Mode>(
+                detail::byte_pointer<const char>(first), last - first,
+                detail::byte_pointer<uint8_t>(dest), written);
+
+            first += count;
+            dest += written;
+            offset = count;
+        }
+    }
+
+    return detail::block_codec<detail::base64_charset<Mode>>::template decode<
+        Padding, true>(std::move(first), std::move(last), std::move(dest),
+                       offset);
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_decode_wrapped(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return base64_decode_wrapped<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<I, O>
+base64_decode_wrapped(I first, S last, O dest)
+{
+    auto res = base64_decode_wrapped<Mode, Padding>(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if (res.ec != std::errc{}) {
+        throw detail::base64_decode_error{};
+    }
+
+    return { std::move(res.in), std::move(res.out) };
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_decode_wrapped(R &&r, O dest)
+{
+    return base64_decode_wrapped<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_range R,
+          detail::char_allocator Allocator = std::allocator<char>>
+    requires std::ranges::sized_range<R>
+auto base64_encode(R &&r, const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    return detail::make_string<string_type>(
+        base64_encoded_size<Mode, Padding>(std::ranges::size(r)), alloc,
+        [&](char *data) {
+            return base64_encode<Mode, Padding>(r, data).out - data;
+        });
+}
+
+// Every character written is backed by a whole group or a validated final
+// group, so the exact size of a valid input also bounds invalid ones.
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          detail::char_allocator Allocator = std::allocator<char>>
+auto base64_decode(std::string_view src, const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    std::errc ec{};
+    string_type str = detail::make_string<string_type>(
+        base64_decoded_size(src), alloc, [&](char *data) {
+            auto res = base64_decode<Mode, Padding>(src, data, std::nothrow);
+            ec = res.ec;
+            return res.out - data;
+        });
+
+    if (ec != std::errc{}) {
+        throw detail::base64_decode_error{};
+    }
+
+    return str;
+}
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_range R, std::output_iterator<char> O>
+    requires detail::contiguous_byte_range<R> &&
+        detail::contiguous_byte_output<O>
+std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_encode(parallel_policy policy, R &&r, O dest)
+{
+    std::size_t size = std::ranges::size(r);
+    const uint8_t *src = detail::byte_pointer<const uint8_t>(
+        std::ranges::begin(r));
+    char *out = detail::byte_pointer<char>(dest);
+
+    detail::parallel_chunks(
+        size, detail::parallel_chunk_size<3>(policy, size),
+        [=](std::size_t begin, std::size_t end) {
+            base64_encode<Mode, Padding>(src + begin, src + end,
+                                         out + begin / 3 * 4);
+        });
+
+    return { std::ranges::begin(r) + size,
+             dest + base64_encoded_size<Mode, Padding>(size) };
+}
+
+// Every chunk but the last is decoded with padding disallowed, as only the
+// final group of the whole input may be short or padded.
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+    requires detail::contiguous_byte_range<R> &&
+        detail::contiguous_byte_output<O>
+std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base64_decode(parallel_policy policy, R &&r, O dest)
+{
+    std::size_t size = std::ranges::size(r);
+    const char *src = detail::byte_pointer<const char>(std::ranges::begin(r));
+    uint8_t *out = detail::byte_pointer<uint8_t>(dest);
+    std::size_t chunk = detail::parallel_chunk_size<4>(policy, size);
+    std::vector<std::errc> errors(size / chunk + 1);
+    uint8_t *last = out;
+
+    detail::parallel_chunks(
+        size, chunk, [&](std::size_t begin, std::size_t end) {
+            uint8_t *pos = out + begin / 4 * 3;
+
+            if (end != size) {
+                errors[begin / chunk] =
+                    base64_decode<Mode, base64_padding::none>(
+                        src + begin, src + end, pos, std::nothrow)
+                        .ec;
+                return;
+            }
+
+            auto res = base64_decode<Mode, Padding>(src + begin, src + end,
+                                                    pos, std::nothrow);
+            errors[begin / chunk] = res.ec;
+            last = res.out;
+        });
+
+    if (std::ranges::any_of(errors, [](std::errc ec) { return bool(ec); })) {
+        throw detail::base64_decode_error{};
+    }
+
+    return { std::ranges::begin(r) + size, dest + (last - out) };
+}
+
+enum class base32_mode {
+    regular,
+    hex,
+};
+
+namespace detail {
+
+template <base32_mode Mode>
+inline constexpr std::string_view base32_charset =
+    Mode == base32_mode::regular ? "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567" :
+                                   "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+inline constexpr std::string_view base58_charset =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+} // namespace detail
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+base32_encode(I first, S last, O dest)
+{
+    return detail::block_codec<detail::base32_charset<Mode>>::template encode<
+        Padding != base64_padding::none>(std::move(first), std::move(last),
+                                         std::move(dest));
+}
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_byte_range R, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base32_encode(R &&r, O dest)
+{
+    return base32_encode<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr decode_result<I, O>
+base32_decode(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return detail::block_codec<detail::base32_charset<Mode>>::template decode<
+        Padding>(std::move(first), std::move(last), std::move(dest));
+}
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+base32_decode(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return base32_decode<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
+}
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<I, O>
+base32_decode(I first, S last, O dest)
+{
+    auto res = base32_decode<Mode, Padding>(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if (res.ec != std::errc{}) {
+        throw std::invalid_argument(
+            "nothing::base32_decode: Invalid base32 input");
+    }
+
+    return { std::move(res.in), std::move(res.out) };
+}
+
+template <base32_mode Mode = base32_mode::regular,
+          base64_padding Padding = base64_padding::optional,
+          input_string_range R, std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base32_decode(R &&r, O dest)
+{
+    return base32_decode<Mode, Padding>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+template <input_byte_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+base58_encode(I first, S last, O dest)
+{
+    return detail::bignum_codec<detail::base58_charset>::encode(
+        std::move(first), std::move(last), std::move(dest));
+}
+
+template <input_byte_range R, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base58_encode(R &&r, O dest)
+{
+    return base58_encode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+// Decoding works on the whole number at once, in memory proportional to the
+// input. If that cannot be allocated `ec` is std::errc::not_enough_memory.
+template <input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr decode_result<I, O>
+base58_decode(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return detail::bignum_codec<detail::base58_charset>::decode(
+        std::move(first), std::move(last), std::move(dest));
+}
+
+template <input_string_range R, std::output_iterator<uint8_t> O>
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+base58_decode(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, uint8_t>)
+{
+    return base58_decode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
+}
+
+template <input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<I, O>
+base58_decode(I first, S last, O dest)
+{
+    auto res = base58_decode(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if (res.ec == std::errc::not_enough_memory) {
+        throw std::bad_alloc();
+    }
+
+    if (res.ec != std::errc{}) {
+        throw std::invalid_argument(
+            "nothing::base58_decode: Invalid base58 input");
+    }
+
+    return { std::move(res.in), std::move(res.out) };
+}
+
+template <input_string_range R, std::output_iterator<uint8_t> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+base58_decode(R &&r, O dest)
+{
+    return base58_decode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+// Set of characters escaped by percent_encode(). Bytes outside ASCII are
+// always escaped. ASCII characters are kept as a 16-entry table indexed by the
+// low nibble holding one bit per high nibble, which is what the vector scan
+// in span() looks up.
+class percent_encode_set {
+  public:
+    constexpr percent_encode_set() noexcept = default;
+
+    // Adds every ASCII character having any of the `ascii_property_*` bits in
+    // `properties`.
+    constexpr percent_encode_set &add(uint8_t properties) noexcept
+    {
+        for (int c = 0; c < 128; c++) {
+            if (::detail::ascii_property_table[c] & properties) {
+                _table[c & 15] |= 1 << (c >> 4);
+            }
+        }
+
+        return *this;
+    }
+
+    constexpr percent_encode_set &add(std::string_view chars) noexcept
+    {
+        for (unsigned char c : chars) {
+            if (c < 128) {
+                _table[c & 15] |= 1 << (c >> 4);
+            }
+        }
+
+        return *this;
+    }
+
+    constexpr percent_encode_set &remove(std::string_view chars) noexcept
+    {
+        for (unsigned char c : chars) {
+            if (c < 128) {
+                _table[c & 15] &= ~(1 << (c >> 4));
+            }
+        }
+
+        return *this;
+    }
+
+    constexpr bool contains(char c) const noexcept
+    {
+        auto value = static_cast<unsigned char>(c);
+        return value > 127 || _table[value & 15] >> (value >> 4) & 1;
+    }
+
+    // Returns the length of the leading run of `src` holding no character in
+    // the set.
+    constexpr std::size_t span(const char *src, std::size_t size) const noexcept
+    {
+        std::size_t i = 0;
+
+        if (!std::is_constant_evaluated()) {
+#if defined(__AVX2__)
+            const __m256i table = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&_table)));
+            const __m256i bits = _mm256_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4,
+                8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i nibble = _mm256_set1_epi8(15);
+
+            for (; size - i >= 32; i += 32) {
+                __m256i chars = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(src + i));
+                __m256i hits = _mm256_and_si256(
+                    _mm256_shuffle_epi8(table,
+                                        _mm256_and_si256(chars, nibble)),
+                    _mm256_shuffle_epi8(
+                        bits, _mm256_and_si256(_mm256_srli_epi16(chars, 4),
+                                               nibble)));
+                uint32_t clean = _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                                     hits, _mm256_setzero_si256())) &
+                                 ~_mm256_movemask_epi8(chars);
+
+                if (clean != 0xFFFFFFFF) {
+                    return i + std::countr_one(clean);
+                }
+            }
+#endif
+
+#if defined(__SSSE3__)
+            const __m128i table128 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&_table));
+            const __m128i bits128 =
+                _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0,
+                              0, 0);
+            const __m128i nibble128 = _mm_set1_epi8(15);
+
+            for (; size - i >= 16; i += 16) {
+                __m128i chars =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                __m128i hits = _mm_and_si128(
+                    _mm_shuffle_epi8(table128,
+                                     _mm_and_si128(chars, nibble128)),
+                    _mm_shuffle_epi8(
+                        bits128,
+                        _mm_and_si128(_mm_srli_epi16(chars, 4), nibble128)));
+                uint32_t clean = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                                     hits, _mm_setzero_si128())) &
+                                 ~_mm_movemask_epi8(chars);
+
+                if (clean != 0xFFFF) {
+                    return i + std::countr_one(clean);
+                }
+            }
+#endif
+        }
+
+        while (i < size && !contains(src[i])) {
+            i++;
+        }
+
+        return i;
+    }
+
+  private:
+    std::array<uint8_t, 16> _table{};
+};
+
+// Everything but the unreserved characters of RFC 3986.
+inline constexpr percent_encode_set percent_reserved =
+    percent_encode_set{}
+        .add(::detail::ascii_property_cntrl | ::detail::ascii_property_space |
+             ::detail::ascii_property_punct)
+        .remove("-._~");
+
+constexpr std::size_t percent_encoded_size_max(std::size_t size) noexcept
+{
+    return 3 * size;
+}
+
+template <hex_mode Mode = hex_mode::upper, input_string_iterator I,
+          std::sentinel_for<I> S, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+percent_encode(I first, S last, O dest,
+               const percent_encode_set &set = percent_reserved)
+{
+    for (;;) {
+        if constexpr (detail::contiguous_byte_input<I, S>) {
+            if (!std::is_constant_evaluated()) {
+                const char *src = detail::byte_pointer<const char>(first);
+                std::size_t count = set.span(src, last - first);
+
+                dest = std::ranges::copy(src, src + count, std::move(dest)).out;
+                first += count;
+            }
+        }
+
+        if (first == last) {
+            break;
+        }
+
+        char c = *first;
+        ++first;
+
+        if (set.contains(c)) {
+            *dest++ = '%';
+            dest = hex_encode<Mode>(static_cast<uint8_t>(c), std::move(dest));
+        } else {
+            *dest++ = c;
+        }
+    }
+
+    return { std::move(first), std::move(dest) };
+}
+
+template <hex_mode Mode = hex_mode::upper, input_string_range R,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+percent_encode(R &&r, O dest, const percent_encode_set &set = percent_reserved)
+{
+    return percent_encode<Mode>(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest), set);
+}
+
+// Decodes "%XX" escapes, copying every other character through unchanged. On
+// error `in` and `offset` point at the character that should have been a hex
+// digit.
+template <input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr decode_result<I, O>
+percent_decode(I first, S last, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, char>)
+{
+    std::size_t offset = 0;
+
+    for (;;) {
+        if constexpr (detail::contiguous_byte_input<I, S>) {
+            if (!std::is_constant_evaluated()) {
+                const char *src = detail::byte_pointer<const char>(first);
+                std::size_t size = last - first;
+                const char *pos = std::char_traits<char>::find(src, size, '%');
+                std::size_t count = pos ? pos - src : size;
+
+                dest = std::ranges::copy(src, src + count, std::move(dest)).out;
+                first += count;
+                offset += count;
+            }
+        }
+
+        if (first == last) {
+            break;
+        }
+
+        char c = *first;
+        ++first;
+        ++offset;
+
+        if (c != '%') {
+            *dest++ = c;
+            continue;
+        }
+
+        uint8_t value = 0;
+
+        for (int i = 0; i < 2; i++, ++first, ++offset) {
+            uint8_t digit = first == last ?
+                0xFF : detail::hex_values[static_cast<unsigned char>(*first)];
+
+            if (digit > 15) {
+                return { { first, dest }, std::errc::invalid_argument, offset };
+            }
+
+            value = value << 4 | digit;
+        }
+
+        *dest++ = static_cast<char>(value);
+    }
+
+    return { { first, dest }, std::errc{}, offset };
+}
+
+template <input_string_range R, std::output_iterator<char> O>
+constexpr decode_result<std::ranges::borrowed_iterator_t<R>, O>
+percent_decode(R &&r, O dest, std::nothrow_t)
+    noexcept(detail::nothrow_output<O, char>)
+{
+    return percent_decode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest),
+        std::nothrow);
+}
+
+template <input_string_iterator I, std::sentinel_for<I> S,
+          std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<I, O>
+percent_decode(I first, S last, O dest)
+{
+    auto res = percent_decode(
+        std::move(first), std::move(last), std::move(dest), std::nothrow);
+
+    if (res.ec != std::errc{}) {
+        throw std::invalid_argument(
+            "nothing::percent_decode: Invalid percent-encoded input");
+    }
+
+    return { std::move(res.in), std::move(res.out) };
+}
+
+template <input_string_range R, std::output_iterator<char> O>
+constexpr std::ranges::in_out_result<std::ranges::borrowed_iterator_t<R>, O>
+percent_decode(R &&r, O dest)
+{
+    return percent_decode(
+        std::ranges::begin(r), std::ranges::end(r), std::move(dest));
+}
+
+template <hex_mode Mode = hex_mode::upper,
+          detail::char_allocator Allocator = std::allocator<char>>
+auto percent_encode(std::string_view src,
+                    const percent_encode_set &set = percent_reserved,
+                    const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    return detail::make_string<string_type>(
+        percent_encoded_size_max(src.size()), alloc, [&](char *data) {
+            return percent_encode<Mode>(src, data, set).out - data;
+        });
+}
+
+template <detail::char_allocator Allocator = std::allocator<char>>
+auto percent_decode(std::string_view src, const Allocator &alloc = Allocator())
+{
+    using string_type =
+        std::basic_string<char, std::char_traits<char>, Allocator>;
+
+    std::errc ec{};
+    string_type str = detail::make_string<string_type>(
+        src.size(), alloc, [&](char *data) {
+            auto res = percent_decode(src, data, std::nothrow);
+            ec = res.ec;
+            return res.out - data;
+        });
+
+    if (ec != std::errc{}) {
+        throw std::invalid_argument(
+            "nothing::percent_decode: Invalid percent-encoded input");
+    }
+
+    return str;
+}
+
+// clang-format on
+
+// Streaming codecs. Each carries the partial group left at the end of one
+// `update()` call into the next, so input may be split at arbitrary points;
+// `finalize()` flushes the remainder with the same semantics as the one-shot
+// functions and resets the object for reuse.
+
+template <hex_mode Mode = hex_mode::upper>
+class hex_encoder {
+  public:
+    template <input_byte_range R, std::output_iterator<char> O>
+    constexpr O update(R &&r, O dest)
+    {
+        return hex_encode<Mode>(std::forward<R>(r), std::move(dest)).out;
+    }
+
+    template <std::output_iterator<char> O>
+    constexpr O finalize(O dest)
+    {
+        return dest;
+    }
+
+    // Nothing is buffered between calls, so there is nothing to discard.
+    constexpr void reset() noexcept {}
+};
+
+class hex_decoder {
+  public:
+    template <input_string_range R, std::output_iterator<uint8_t> O>
+    constexpr O update(R &&r, O dest)
+    {
+        auto first = std::ranges::begin(r);
+        auto last = std::ranges::end(r);
+
+        if (_size && first != last) {
+            _buf[_size++] = *first++;
+            dest = _flush(dest);
+        }
+
+        if constexpr (std::sized_sentinel_for<decltype(last),
+                                              decltype(first)>) {
+            auto whole = std::ranges::next(first, (last - first) / 2 * 2);
+            auto res = hex_decode(std::move(first), whole, std::move(dest));
+
+            first = std::move(res.in);
+            dest = std::move(res.out);
+        }
+
+        for (; first != last; ++first) {
+            _buf[_size++] = *first;
+
+            if (_size == 2) {
+                dest = _flush(dest);
+            }
+        }
+
+        return dest;
+    }
+
+    template <std::output_iterator<uint8_t> O>
+    constexpr O finalize(O dest)
+    {
+        return _flush(dest);
+    }
+
+    constexpr void reset() noexcept { _size = 0; }
+
+  private:
+    char _buf[2]{};
+    int _size = 0;
+
+    template <class O>
+    constexpr O _flush(O dest)
+    {
+        int size = std::exchange(_size, 0);
+        return hex_decode(_buf, _buf + size, std::move(dest)).out;
+    }
+};
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional>
+class base64_encoder {
+  public:
+    template <input_byte_range R, std::output_iterator<char> O>
+    constexpr O update(R &&r, O dest)
+    {
+        auto first = std::ranges::begin(r);
+        auto last = std::ranges::end(r);
+
+        for (; _size && first != last; ++first) {
+            _buf[_size++] = *first;
+
+            if (_size == 3) {
+                dest = _flush(dest);
+            }
+        }
+
+        if constexpr (std::sized_sentinel_for<decltype(last),
+                                              decltype(first)>) {
+            auto whole = std::ranges::next(first, (last - first) / 3 * 3);
+            auto res = base64_encode<Mode, Padding>(std::move(first), whole,
+                                                    std::move(dest));
+
+            first = std::move(res.in);
+            dest = std::move(res.out);
+        }
+
+        for (; first != last; ++first) {
+            _buf[_size++] = *first;
+
+            if (_size == 3) {
+                dest = _flush(dest);
+            }
+        }
+
+        return dest;
+    }
+
+    template <std::output_iterator<char> O>
+    constexpr O finalize(O dest)
+    {
+        return _flush(dest);
+    }
+
+    constexpr void reset() noexcept { _size = 0; }
+
+  private:
+    uint8_t _buf[3]{};
+    int _size = 0;
+
+    template <class O>
+    constexpr O _flush(O dest)
+    {
+        int size = std::exchange(_size, 0);
+        return base64_encode<Mode, Padding>(_buf, _buf + size, std::move(dest))
+            .out;
+    }
+};
+
+template <base64_mode Mode = base64_mode::regular,
+          base64_padding Padding = base64_padding::optional>
+class base64_decoder {
+  public:
+    template <input_string_range R, std::output_iterator<uint8_t> O>
+    constexpr O update(R &&r, O dest)
+    {
+        auto first = std::ranges::begin(r);
+        auto last = std::ranges::end(r);
+
+        for (; _size && first != last; ++first) {
+            _buf[_size++] = *first;
+
+            if (_size == 4) {
+                dest = _flush(dest);
+            }
+        }
+
+        // Decode the whole groups in place. A group ending in '=' must be the
+        // last one, which the next call enforces through `_padded`.
+        if constexpr (std::forward_iterator<decltype(first)> &&
+                      std::sized_sentinel_for<decltype(last),
+                                              decltype(first)>) {
+            auto count = (last - first) / 4 * 4;
+
+            if (count && !_padded) {
+                auto whole = std::ranges::next(first, count);
+                bool padded = *std::ranges::next(first, count - 1) == '=';
+
+                dest = base64_decode<Mode, Padding>(first, whole,
+                                                    std::move(dest))
+                           .out;
+                first = whole;
+                _padded = padded;
+            }
+        }
+
+        for (; first != last; ++first) {
+            _buf[_size++] = *first;
+
+            if (_size == 4) {
+                dest = _flush(dest);
+            }
+        }
+
+        return dest;
+    }
+
+    template <std::output_iterator<uint8_t> O>
+    constexpr O finalize(O dest)
+    {
+        dest = _flush(dest);
+        _padded = false;
+
+        return dest;
+    }
+
+    constexpr void reset() noexcept
+    {
+        _size = 0;
+        _padded = false;
+    }
+
+  private:
+    char _buf[4]{};
+    int _size = 0;
+    bool _padded = false;
+
+    template <class O>
+    constexpr O _flush(O dest)
+    {
+        // Both are cleared before anything can throw, so a failed call leaves
+        // the object reset.
+        int size = std::exchange(_size, 0);
+        bool padded = std::exchange(_padded, false);
+
+        if (padded && size) {
+            throw detail::base64_decode_error{};
+        }
+
+        dest = base64_decode<Mode, Padding>(_buf, _buf + size, std::move(dest))
+                   .out;
+        _padded = size == 4 && _buf[3] == '=';
+
+        return dest;
+    }
+};
 
 } // namespace nothing
 
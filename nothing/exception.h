@@ -1,3 +1,7 @@
+#ifndef NOTHING_EXCEPTION_H_
+#define NOTHING_EXCEPTION_H_
+
+#include <cerrno>
 #include <type_traits>
 #include <concepts>
 #include <system_error>
@@ -42,3 +46,5 @@ inline void check_errno()
 }
 
 } // namespace nothing
+
+#endif
@@ -5,12 +5,35 @@
 #define NOTHING_INTRUSIVE_LIST_H_
 
 #include <concepts>
+#include <functional>
 #include <iterator>
 #include <ranges>
+#include <type_traits>
+#include <utility>
+#include <nothing/prefetch.h>
 
 namespace nothing {
 
-template <class Tag>
+// Size policies for `intrusive_list`. By default nothing is stored and
+// `count()` walks the list.
+struct intrusive_list_untracked_size {};
+
+// Keeps the number of elements, so `size()` is constant time. Elements must
+// then only enter and leave the list through it: `insert` takes unlinked
+// elements and elements move between lists with `splice`. Such lists take
+// hooks that do not unlink themselves, since that would leave the count
+// stale.
+struct intrusive_list_tracked_size {};
+
+/*
+ * Hook for `intrusive_list`. With `AutoUnlink`, destroying a linked element
+ * removes it from its list and moving one hands its place in the list to
+ * the destination. Lists with a tracked size need hooks without
+ * `AutoUnlink`: those must be erased before they are destroyed, a copied
+ * element is a new, unlinked node, and assignment leaves both elements
+ * where they were.
+ */
+template <class Tag, bool AutoUnlink = true>
 class intrusive_list_member {
   public:
     using tag_type = Tag;
@@ -18,6 +41,7 @@ class intrusive_list_member {
     constexpr intrusive_list_member() noexcept : _next{ this }, _prev{ this } {}
 
     constexpr intrusive_list_member(intrusive_list_member &&other) noexcept
+        requires AutoUnlink
     {
         if (this != std::addressof(other)) {
             _link(*other._prev, *other._next);
@@ -25,25 +49,36 @@ class intrusive_list_member {
         }
     }
 
-    intrusive_list_member(const intrusive_list_member &) = delete;
+    constexpr intrusive_list_member(const intrusive_list_member &) noexcept
+        requires(!AutoUnlink)
+        : _next{ this }, _prev{ this }
+    {
+    }
 
-    ~intrusive_list_member() noexcept
+    constexpr ~intrusive_list_member() noexcept
     {
-        _cross();
-        _reset();
+        if constexpr (AutoUnlink) {
+            _cross();
+            _reset();
+        }
     }
 
     constexpr auto &operator=(intrusive_list_member &&other) noexcept
+        requires AutoUnlink
     {
         _cross();
         _link(*other._prev, *other._next);
         return *this;
     }
 
-    auto &operator=(const intrusive_list_member &) = delete;
+    constexpr auto &operator=(const intrusive_list_member &) noexcept
+        requires(!AutoUnlink)
+    {
+        return *this;
+    }
 
   private:
-    template <class, class>
+    template <class, class, class>
     friend class intrusive_list;
 
     intrusive_list_member *_next;
@@ -79,9 +114,15 @@ class intrusive_list_member {
     }
 };
 
-template <class T, class Tag>
-    requires std::derived_from<T, intrusive_list_member<Tag>> &&
-        std::same_as<T, std::remove_cv_t<T>>
+template <class T, class Tag,
+          class SizePolicy = intrusive_list_untracked_size>
+    requires std::derived_from<
+                 T, intrusive_list_member<
+                        Tag, !std::same_as<SizePolicy,
+                                           intrusive_list_tracked_size>>> &&
+        std::same_as<T, std::remove_cv_t<T>> &&
+        (std::same_as<SizePolicy, intrusive_list_untracked_size> ||
+         std::same_as<SizePolicy, intrusive_list_tracked_size>)
 class intrusive_list {
   public:
     using value_type = T;
@@ -92,6 +133,7 @@ class intrusive_list {
     using difference_type = std::ptrdiff_t;
     using size_type = std::size_t;
     using tag_type = Tag;
+    using size_policy = SizePolicy;
 
     class iterator;
     class const_iterator;
@@ -100,9 +142,35 @@ class intrusive_list {
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
   private:
-    using member_type = intrusive_list_member<Tag>;
+    static constexpr bool _tracked =
+        std::same_as<SizePolicy, intrusive_list_tracked_size>;
+
+    using member_type = intrusive_list_member<Tag, !_tracked>;
 
   public:
+    constexpr intrusive_list() noexcept = default;
+
+    constexpr intrusive_list(intrusive_list &&other) noexcept { swap(other); }
+
+    constexpr intrusive_list &operator=(intrusive_list &&other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            erase(begin(), end());
+            swap(other);
+        }
+
+        return *this;
+    }
+
+    // The hooks of a tracked list cannot unlink themselves from a destroyed
+    // root, so its elements are unlinked here.
+    constexpr ~intrusive_list()
+    {
+        if constexpr (_tracked) {
+            erase(begin(), end());
+        }
+    }
+
     constexpr void push_front(reference value) noexcept
     {
         insert(begin(), value);
@@ -110,8 +178,15 @@ class intrusive_list {
 
     constexpr void push_back(reference value) noexcept { insert(end(), value); }
 
-    constexpr void pop_front() noexcept { erase(*_root._next); }
-    constexpr void pop_back() noexcept { erase(*_root._prev); }
+    constexpr void pop_front() noexcept
+    {
+        erase(static_cast<reference>(*_root._next));
+    }
+
+    constexpr void pop_back() noexcept
+    {
+        erase(static_cast<reference>(*_root._prev));
+    }
 
     constexpr auto &front() noexcept
     {
@@ -143,6 +218,7 @@ class intrusive_list {
         if (pos_ptr != value_ptr) {
             value_ptr->_cross();
             value_ptr->_link(*pos_ptr->_prev, *pos_ptr);
+            _grow(1);
         }
 
         return iterator(value);
@@ -167,6 +243,7 @@ class intrusive_list {
                 curr->_cross();
                 curr->_link(*last_inserted, *last_inserted->_next);
                 last_inserted = curr;
+                _grow(1);
             }
         }
 
@@ -190,6 +267,7 @@ class intrusive_list {
 
         pos_member._cross();
         pos_member._reset();
+        _shrink(1);
 
         return ret;
     }
@@ -202,6 +280,7 @@ class intrusive_list {
         for (member_type *pos = prev->_next, *pos_next = pos->_next;
              pos != next; pos = pos_next, pos_next = pos->_next) {
             pos->_reset();
+            _shrink(1);
         }
 
         prev->_next = next;
@@ -243,7 +322,254 @@ class intrusive_list {
 
     constexpr size_type count() const noexcept
     {
-        return std::ranges::distance(*this);
+        if constexpr (_tracked) {
+            return _size;
+        } else {
+            return std::ranges::distance(*this);
+        }
+    }
+
+    constexpr size_type size() const noexcept
+        requires _tracked
+    {
+        return _size;
+    }
+
+    // Moves all elements of `other` before `pos`.
+    constexpr void splice(const_iterator pos, intrusive_list &other) noexcept
+    {
+        if (this == std::addressof(other) || other.empty()) {
+            return;
+        }
+
+        member_type *first = other._root._next;
+        member_type *last = other._root._prev;
+
+        other._root._reset();
+        _splice(_node(pos), *first, *last);
+
+        if constexpr (_tracked) {
+            _size += std::exchange(other._size, 0);
+        }
+    }
+
+    constexpr void splice(const_iterator pos, intrusive_list &&other) noexcept
+    {
+        splice(pos, other);
+    }
+
+    // Moves `[first, last)` of `other` before `pos`. `pos` must not be in
+    // `[first, last)`; `pos == last` leaves the list as is. Only the boundary
+    // nodes are relinked, though a tracked size must count the range when
+    // `other` is another list.
+    constexpr void splice(const_iterator pos, intrusive_list &other,
+                          const_iterator first, const_iterator last) noexcept
+    {
+        if (first == last || pos == last) {
+            return;
+        }
+
+        if constexpr (_tracked) {
+            if (this != std::addressof(other)) {
+                size_type n = std::ranges::distance(first, last);
+                _size += n;
+                other._size -= n;
+            }
+        }
+
+        member_type *first_ptr = _node(first);
+        member_type *last_ptr = _node(last)->_prev;
+
+        first_ptr->_prev->_next = last_ptr->_next;
+        last_ptr->_next->_prev = first_ptr->_prev;
+
+        _splice(_node(pos), *first_ptr, *last_ptr);
+    }
+
+    constexpr void splice(const_iterator pos, intrusive_list &&other,
+                          const_iterator first, const_iterator last) noexcept
+    {
+        splice(pos, other, first, last);
+    }
+
+    // Moves the element at `it` before `pos`; `pos` may be `it` or the
+    // position after it, which leave the list as is.
+    constexpr void splice(const_iterator pos, intrusive_list &other,
+                          const_iterator it) noexcept
+    {
+        const_iterator next = std::ranges::next(it);
+
+        if (pos == it || pos == next) {
+            return;
+        }
+
+        splice(pos, other, it, next);
+    }
+
+    constexpr void splice(const_iterator pos, intrusive_list &&other,
+                          const_iterator it) noexcept
+    {
+        splice(pos, other, it);
+    }
+
+    constexpr void swap(intrusive_list &other) noexcept
+    {
+        member_type *first = _root._next;
+        member_type *last = _root._prev;
+
+        _adopt(*other._root._next, *other._root._prev, other._root);
+        other._adopt(*first, *last, _root);
+
+        if constexpr (_tracked) {
+            std::swap(_size, other._size);
+        }
+    }
+
+    friend constexpr void swap(intrusive_list &lh, intrusive_list &rh) noexcept
+    {
+        lh.swap(rh);
+    }
+
+    // Stable merge sort that relinks the nodes in place. Runs of 2^i nodes
+    // wait in a fixed array of bins, as in a binary counter, so no memory is
+    // allocated. If `comp` throws, the elements are left in the list in an
+    // unspecified order.
+    template <class Compare = std::less<>>
+    constexpr void sort(Compare comp = Compare())
+    {
+        if (_root._next == _root._prev) {
+            return;
+        }
+
+        // Every node is always either in a bin or still in the chain at
+        // `node`, since `_merge` leaves both chains in its first on throwing.
+        member_type *bins[64] = {};
+        member_type *node = _root._next;
+
+        _root._prev->_next = nullptr;
+
+        try {
+            while (node) {
+                member_type *run = node;
+                std::size_t i = 0;
+
+                node = node->_next;
+                run->_next = nullptr;
+
+                for (; bins[i]; i++) {
+                    _merge(bins[i], run, comp);
+                    run = std::exchange(bins[i], nullptr);
+                }
+
+                bins[i] = run;
+            }
+
+            member_type *head = nullptr;
+
+            for (member_type *&run : bins) {
+                if (run) {
+                    _merge(run, head, comp);
+                    head = std::exchange(run, nullptr);
+                }
+            }
+
+            _relink(head);
+        } catch (...) {
+            member_type *head = node;
+
+            for (member_type *run : bins) {
+                _append(head, run);
+            }
+
+            _relink(head);
+            throw;
+        }
+    }
+
+    // Moves the elements of `other` into this list, both sorted by `comp`.
+    // Equivalent elements from this list come first. If `comp` throws, all
+    // the elements are left in this list in an unspecified order.
+    template <class Compare = std::less<>>
+    constexpr void merge(intrusive_list &other, Compare comp = Compare())
+    {
+        if (this == std::addressof(other) || other.empty()) {
+            return;
+        }
+
+        member_type *head = other._root._next;
+
+        other._root._prev->_next = nullptr;
+        other._root._reset();
+
+        if constexpr (_tracked) {
+            _size += std::exchange(other._size, 0);
+        }
+
+        if (empty()) {
+            _relink(head);
+            return;
+        }
+
+        member_type *merged = _root._next;
+
+        _root._prev->_next = nullptr;
+
+        try {
+            _merge(merged, head, comp);
+        } catch (...) {
+            _relink(merged);
+            throw;
+        }
+
+        _relink(merged);
+    }
+
+    template <class Compare = std::less<>>
+    constexpr void merge(intrusive_list &&other, Compare comp = Compare())
+    {
+        merge(other, std::move(comp));
+    }
+
+    // Erases all but the first of each run of consecutive elements equal by
+    // `pred`, and returns the number erased.
+    template <class BinaryPredicate = std::equal_to<>>
+    constexpr size_type unique(BinaryPredicate pred = BinaryPredicate())
+    {
+        size_type count = 0;
+
+        if (empty()) {
+            return count;
+        }
+
+        for (iterator prev = begin(), pos = std::ranges::next(prev);
+             pos != end();) {
+            if (pred(*prev, *pos)) {
+                pos = erase(pos);
+                count++;
+            } else {
+                prev = pos++;
+            }
+        }
+
+        return count;
+    }
+
+    // Erases the elements satisfying `pred`, and returns the number erased.
+    template <class Predicate>
+    constexpr size_type remove_if(Predicate pred)
+    {
+        size_type count = 0;
+
+        for (iterator pos = begin(); pos != end();) {
+            if (pred(*pos)) {
+                pos = erase(pos);
+                count++;
+            } else {
+                ++pos;
+            }
+        }
+
+        return count;
     }
 
     class iterator {
@@ -371,7 +697,127 @@ class intrusive_list {
     };
 
   private:
+    struct _untracked {};
+
     member_type _root;
+    [[no_unique_address]] std::conditional_t<_tracked, size_type, _untracked>
+        _size{};
+
+    static constexpr member_type *_node(const_iterator pos) noexcept
+    {
+        return const_cast<pointer>(std::addressof(*pos));
+    }
+
+    constexpr void _grow(size_type n) noexcept
+    {
+        if constexpr (_tracked) {
+            _size += n;
+        }
+    }
+
+    constexpr void _shrink(size_type n) noexcept
+    {
+        if constexpr (_tracked) {
+            _size -= n;
+        }
+    }
+
+    // Merges the sorted null-terminated chain `b` into `a` through `_next`,
+    // taking from `a` on ties. Loading the node taken next from a chain
+    // prefetches the one after it, so that miss overlaps the comparisons. If
+    // `comp` throws, `a` is left holding the nodes of both chains.
+    template <class Compare>
+    static constexpr void _merge(member_type *&a, member_type *b,
+                                 Compare &comp)
+    {
+        member_type *head;
+        member_type **tail = &head;
+        member_type *x = a;
+
+        try {
+            while (x && b) {
+                if (comp(static_cast<reference>(*b),
+                         static_cast<reference>(*x))) {
+                    *tail = b;
+                    tail = &b->_next;
+                    b = b->_next;
+
+                    if (b) {
+                        prefetch(b->_next);
+                    }
+                } else {
+                    *tail = x;
+                    tail = &x->_next;
+                    x = x->_next;
+
+                    if (x) {
+                        prefetch(x->_next);
+                    }
+                }
+            }
+        } catch (...) {
+            *tail = x;
+            _append(head, b);
+            a = head;
+            throw;
+        }
+
+        *tail = x ? x : b;
+        a = head;
+    }
+
+    // Appends the null-terminated chain `tail` to the one at `head`.
+    static constexpr void _append(member_type *&head,
+                                  member_type *tail) noexcept
+    {
+        member_type **pos = &head;
+
+        while (*pos) {
+            pos = &(*pos)->_next;
+        }
+
+        *pos = tail;
+    }
+
+    // Makes the null-terminated chain at `head` the elements of this list,
+    // restoring the `_prev` links.
+    constexpr void _relink(member_type *head) noexcept
+    {
+        member_type *prev = std::addressof(_root);
+
+        for (; head; prev = head, head = head->_next) {
+            prev->_next = head;
+            head->_prev = prev;
+        }
+
+        prev->_next = std::addressof(_root);
+        _root._prev = prev;
+    }
+
+    // Links the unowned chain `[first, last]` before `pos`.
+    static constexpr void _splice(member_type *pos, member_type &first,
+                                  member_type &last) noexcept
+    {
+        first._prev = pos->_prev;
+        last._next = pos;
+        pos->_prev->_next = std::addressof(first);
+        pos->_prev = std::addressof(last);
+    }
+
+    // Makes the chain `[first, last]` taken from the list rooted at `root` the
+    // elements of this list, where `first` is `root` when that list was empty.
+    constexpr void _adopt(member_type &first, member_type &last,
+                          const member_type &root) noexcept
+    {
+        if (std::addressof(first) == std::addressof(root)) {
+            _root._reset();
+        } else {
+            _root._next = std::addressof(first);
+            _root._prev = std::addressof(last);
+            first._prev = std::addressof(_root);
+            last._next = std::addressof(_root);
+        }
+    }
 };
 
 } // namespace nothing
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_INTRUSIVE_MPSC_QUEUE_H_
+#define NOTHING_INTRUSIVE_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <nothing/intrusive_slist.h>
+
+namespace nothing {
+
+/*
+ * Unbounded multi-producer, single-consumer queue of elements hooked by
+ * `intrusive_slist_member<Tag>`, after Dmitry Vyukov's intrusive MPSC node
+ * queue. `push` may be called from any thread and is one atomic exchange.
+ * `pop` and `pop_batch` belong to a single consumer and read the links with
+ * acquire loads. Only taking the last element written to the queue touches
+ * the producers' end: the stub node is pushed behind it, one exchange.
+ * `pop_batch` walks the links once and cuts the chain, so a batch costs at
+ * most that one exchange however many elements it takes.
+ *
+ * A producer preempted between its exchange and linking its node hides that
+ * node and those pushed after it; `pop` returns nothing until it finishes.
+ */
+template <class T, class Tag>
+    requires std::derived_from<T, intrusive_slist_member<Tag>> &&
+        std::same_as<T, std::remove_cv_t<T>>
+class intrusive_mpsc_queue {
+  public:
+    using value_type = T;
+    using reference = T &;
+    using pointer = T *;
+    using size_type = std::size_t;
+    using tag_type = Tag;
+    using batch_type = intrusive_slist<T, Tag>;
+
+  private:
+    using member_type = intrusive_slist_member<Tag>;
+    using link_type = std::atomic_ref<member_type *>;
+
+    static_assert(link_type::required_alignment <= alignof(member_type *));
+
+  public:
+    intrusive_mpsc_queue() noexcept
+        : _head{ std::addressof(_stub) }, _tail{ std::addressof(_stub) }
+    {
+    }
+
+    intrusive_mpsc_queue(const intrusive_mpsc_queue &) = delete;
+    intrusive_mpsc_queue &operator=(const intrusive_mpsc_queue &) = delete;
+
+    // Pushes `value`, which must not be in a list with this tag.
+    void push(reference value) noexcept { _push(std::addressof(value)); }
+
+    // Takes the oldest element, or returns null if there is none.
+    pointer pop() noexcept
+    {
+        member_type *tail = _tail;
+        member_type *next = _load_next(tail);
+
+        if (tail == std::addressof(_stub)) {
+            if (!next) {
+                return nullptr;
+            }
+
+            _tail = next;
+            tail = next;
+            next = _load_next(next);
+        }
+
+        if (next) {
+            _tail = next;
+            return _take(tail);
+        }
+
+        if (tail != _head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // `tail` is the last element; push the stub behind it so it can be
+        // taken without leaving the queue without a node.
+        _push(std::addressof(_stub));
+        next = _load_next(tail);
+
+        if (next) {
+            _tail = next;
+            return _take(tail);
+        }
+
+        return nullptr;
+    }
+
+    // Takes up to `max` of the oldest elements, in order.
+    batch_type pop_batch(
+        size_type max = std::numeric_limits<size_type>::max()) noexcept
+    {
+        batch_type batch;
+        auto pos = batch.before_begin();
+        size_type count = 0;
+        member_type *tail = _tail;
+        member_type *next = _load_next(tail);
+
+        // Every node with a published successor can be taken; the stub is
+        // skipped wherever it sits in the chain.
+        for (; next && count < max; tail = next, next = _load_next(next)) {
+            if (tail != std::addressof(_stub)) {
+                pos = batch.insert_after(pos, static_cast<reference>(*tail));
+                count++;
+            }
+        }
+
+        if (!next && count < max && tail != std::addressof(_stub) &&
+            tail == _head.load(std::memory_order_acquire)) {
+            _push(std::addressof(_stub));
+            next = _load_next(tail);
+
+            if (next) {
+                batch.insert_after(pos, static_cast<reference>(*tail));
+                tail = next;
+            }
+        }
+
+        _tail = tail;
+
+        return batch;
+    }
+
+  private:
+    alignas(64) std::atomic<member_type *> _head;
+    alignas(64) member_type *_tail;
+    member_type _stub;
+
+    static member_type *_load_next(member_type *node) noexcept
+    {
+        return link_type(node->_next).load(std::memory_order_acquire);
+    }
+
+    static pointer _take(member_type *node) noexcept
+    {
+        node->_next = nullptr;
+        return static_cast<pointer>(node);
+    }
+
+    void _push(member_type *node) noexcept
+    {
+        link_type(node->_next).store(nullptr, std::memory_order_relaxed);
+
+        member_type *prev = _head.exchange(node, std::memory_order_acq_rel);
+
+        link_type(prev->_next).store(node, std::memory_order_release);
+    }
+};
+
+} // namespace nothing
+
+#endif
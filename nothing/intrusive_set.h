@@ -0,0 +1,1015 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_INTRUSIVE_SET_H_
+#define NOTHING_INTRUSIVE_SET_H_
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace nothing {
+namespace detail {
+
+template <class Tag>
+class intrusive_tree_header;
+
+template <class T, class Tag, class Compare, bool Multi>
+class intrusive_tree;
+
+} // namespace detail
+
+/*
+ * Hook for `intrusive_set` and `intrusive_multiset`, which are red-black
+ * trees. A linked node unlinks itself on destruction, finding its tree by
+ * walking up to the header. Moving a node hands its place in the tree, and
+ * its color, to the destination, which keeps the tree ordered as long as the
+ * key moves with it; hooks cannot be copied.
+ */
+template <class Tag>
+class intrusive_set_member {
+  public:
+    using tag_type = Tag;
+
+    constexpr intrusive_set_member() noexcept = default;
+
+    constexpr intrusive_set_member(intrusive_set_member &&other) noexcept
+    {
+        _replace(other);
+    }
+
+    intrusive_set_member(const intrusive_set_member &) = delete;
+
+    constexpr ~intrusive_set_member() noexcept
+    {
+        if (_parent) {
+            _erase(*this, _header());
+        }
+    }
+
+    constexpr auto &operator=(intrusive_set_member &&other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            if (_parent) {
+                _erase(*this, _header());
+            }
+
+            _replace(other);
+        }
+
+        return *this;
+    }
+
+    auto &operator=(const intrusive_set_member &) = delete;
+
+  private:
+    template <class, class, class, bool>
+    friend class detail::intrusive_tree;
+
+    friend class detail::intrusive_tree_header<Tag>;
+
+    enum class _color_type : unsigned char { red, black, header };
+
+    intrusive_set_member *_parent = nullptr;
+    intrusive_set_member *_left = nullptr;
+    intrusive_set_member *_right = nullptr;
+    _color_type _color = _color_type::red;
+
+    static constexpr bool _is_red(const intrusive_set_member *node) noexcept
+    {
+        return node && node->_color == _color_type::red;
+    }
+
+    template <class Node>
+    static constexpr Node *_minimum(Node *node) noexcept
+    {
+        while (node->_left) {
+            node = node->_left;
+        }
+
+        return node;
+    }
+
+    template <class Node>
+    static constexpr Node *_maximum(Node *node) noexcept
+    {
+        while (node->_right) {
+            node = node->_right;
+        }
+
+        return node;
+    }
+
+    template <class Node>
+    static constexpr Node *_next(Node *node) noexcept
+    {
+        if (node->_right) {
+            return _minimum(node->_right);
+        }
+
+        Node *parent = node->_parent;
+
+        while (node == parent->_right) {
+            node = parent;
+            parent = parent->_parent;
+        }
+
+        // Leaving the maximum of a tree whose root has no right child ends
+        // at the header.
+        return node->_right != parent ? parent : node;
+    }
+
+    template <class Node>
+    static constexpr Node *_prev(Node *node) noexcept
+    {
+        if (node->_color == _color_type::header) {
+            return node->_right;
+        }
+
+        if (node->_left) {
+            return _maximum(node->_left);
+        }
+
+        Node *parent = node->_parent;
+
+        while (node == parent->_left) {
+            node = parent;
+            parent = parent->_parent;
+        }
+
+        return parent;
+    }
+
+    constexpr intrusive_set_member &_header() noexcept
+    {
+        intrusive_set_member *node = this;
+
+        while (node->_color != _color_type::header) {
+            node = node->_parent;
+        }
+
+        return *node;
+    }
+
+    // Links this unlinked node where `other` is, and unlinks `other`.
+    constexpr void _replace(intrusive_set_member &other) noexcept
+    {
+        if (!other._parent) {
+            return;
+        }
+
+        _parent = other._parent;
+        _left = other._left;
+        _right = other._right;
+        _color = other._color;
+
+        if (_left) {
+            _left->_parent = this;
+        }
+
+        if (_right) {
+            _right->_parent = this;
+        }
+
+        // The header's children are the extremes, not the root.
+        if (_parent->_color == _color_type::header) {
+            _parent->_parent = this;
+        } else if (_parent->_left == std::addressof(other)) {
+            _parent->_left = this;
+        } else {
+            _parent->_right = this;
+        }
+
+        intrusive_set_member &header = _header();
+
+        if (header._left == std::addressof(other)) {
+            header._left = this;
+        }
+
+        if (header._right == std::addressof(other)) {
+            header._right = this;
+        }
+
+        other._reset();
+    }
+
+    static constexpr void _rotate_left(intrusive_set_member *node,
+                                       intrusive_set_member *&root) noexcept
+    {
+        intrusive_set_member *child = node->_right;
+
+        node->_right = child->_left;
+
+        if (child->_left) {
+            child->_left->_parent = node;
+        }
+
+        child->_parent = node->_parent;
+
+        if (node == root) {
+            root = child;
+        } else if (node == node->_parent->_left) {
+            node->_parent->_left = child;
+        } else {
+            node->_parent->_right = child;
+        }
+
+        child->_left = node;
+        node->_parent = child;
+    }
+
+    static constexpr void _rotate_right(intrusive_set_member *node,
+                                        intrusive_set_member *&root) noexcept
+    {
+        intrusive_set_member *child = node->_left;
+
+        node->_left = child->_right;
+
+        if (child->_right) {
+            child->_right->_parent = node;
+        }
+
+        child->_parent = node->_parent;
+
+        if (node == root) {
+            root = child;
+        } else if (node == node->_parent->_right) {
+            node->_parent->_right = child;
+        } else {
+            node->_parent->_left = child;
+        }
+
+        child->_right = node;
+        node->_parent = child;
+    }
+
+    // Links `node` as the left or right child of `parent`, which is the
+    // header for an empty tree, and restores the red-black invariants.
+    static constexpr void _insert(intrusive_set_member &node,
+                                  intrusive_set_member *parent, bool left,
+                                  intrusive_set_member &header) noexcept
+    {
+        intrusive_set_member *x = std::addressof(node);
+        intrusive_set_member *&root = header._parent;
+
+        x->_parent = parent;
+        x->_left = nullptr;
+        x->_right = nullptr;
+        x->_color = _color_type::red;
+
+        if (left) {
+            parent->_left = x;
+
+            if (parent == std::addressof(header)) {
+                header._parent = x;
+                header._right = x;
+            } else if (parent == header._left) {
+                header._left = x;
+            }
+        } else {
+            parent->_right = x;
+
+            if (parent == header._right) {
+                header._right = x;
+            }
+        }
+
+        while (x != root && x->_parent->_color == _color_type::red) {
+            intrusive_set_member *grandparent = x->_parent->_parent;
+
+            if (x->_parent == grandparent->_left) {
+                intrusive_set_member *uncle = grandparent->_right;
+
+                if (_is_red(uncle)) {
+                    x->_parent->_color = _color_type::black;
+                    uncle->_color = _color_type::black;
+                    grandparent->_color = _color_type::red;
+                    x = grandparent;
+                } else {
+                    if (x == x->_parent->_right) {
+                        x = x->_parent;
+                        _rotate_left(x, root);
+                    }
+
+                    x->_parent->_color = _color_type::black;
+                    grandparent->_color = _color_type::red;
+                    _rotate_right(grandparent, root);
+                }
+            } else {
+                intrusive_set_member *uncle = grandparent->_left;
+
+                if (_is_red(uncle)) {
+                    x->_parent->_color = _color_type::black;
+                    uncle->_color = _color_type::black;
+                    grandparent->_color = _color_type::red;
+                    x = grandparent;
+                } else {
+                    if (x == x->_parent->_left) {
+                        x = x->_parent;
+                        _rotate_right(x, root);
+                    }
+
+                    x->_parent->_color = _color_type::black;
+                    grandparent->_color = _color_type::red;
+                    _rotate_left(grandparent, root);
+                }
+            }
+        }
+
+        root->_color = _color_type::black;
+        static_cast<intrusive_tree_header_type &>(header)._size++;
+    }
+
+    // Unlinks `node` from the tree headed by `header`, restores the red-black
+    // invariants, and leaves `node` unlinked.
+    static constexpr void _erase(intrusive_set_member &node,
+                                 intrusive_set_member &header) noexcept
+    {
+        intrusive_set_member *z = std::addressof(node);
+        intrusive_set_member *y = z;
+        intrusive_set_member *x = nullptr;
+        intrusive_set_member *x_parent = nullptr;
+        intrusive_set_member *&root = header._parent;
+        intrusive_set_member *&leftmost = header._left;
+        intrusive_set_member *&rightmost = header._right;
+
+        if (!y->_left) {
+            x = y->_right;
+        } else if (!y->_right) {
+            x = y->_left;
+        } else {
+            y = _minimum(y->_right);
+            x = y->_right;
+        }
+
+        if (y != z) {
+            // `z` has two children; its successor `y` takes its place.
+            z->_left->_parent = y;
+            y->_left = z->_left;
+
+            if (y != z->_right) {
+                x_parent = y->_parent;
+
+                if (x) {
+                    x->_parent = y->_parent;
+                }
+
+                y->_parent->_left = x;
+                y->_right = z->_right;
+                z->_right->_parent = y;
+            } else {
+                x_parent = y;
+            }
+
+            if (root == z) {
+                root = y;
+            } else if (z->_parent->_left == z) {
+                z->_parent->_left = y;
+            } else {
+                z->_parent->_right = y;
+            }
+
+            y->_parent = z->_parent;
+            std::swap(y->_color, z->_color);
+            y = z;
+        } else {
+            x_parent = y->_parent;
+
+            if (x) {
+                x->_parent = y->_parent;
+            }
+
+            if (root == z) {
+                root = x;
+            } else if (z->_parent->_left == z) {
+                z->_parent->_left = x;
+            } else {
+                z->_parent->_right = x;
+            }
+
+            if (leftmost == z) {
+                leftmost = z->_right ? _minimum(x) : z->_parent;
+            }
+
+            if (rightmost == z) {
+                rightmost = z->_left ? _maximum(x) : z->_parent;
+            }
+        }
+
+        if (y->_color != _color_type::red) {
+            while (x != root && !_is_red(x)) {
+                if (x == x_parent->_left) {
+                    intrusive_set_member *w = x_parent->_right;
+
+                    if (_is_red(w)) {
+                        w->_color = _color_type::black;
+                        x_parent->_color = _color_type::red;
+                        _rotate_left(x_parent, root);
+                        w = x_parent->_right;
+                    }
+
+                    if (!_is_red(w->_left) && !_is_red(w->_right)) {
+                        w->_color = _color_type::red;
+                        x = x_parent;
+                        x_parent = x_parent->_parent;
+                    } else {
+                        if (!_is_red(w->_right)) {
+                            w->_left->_color = _color_type::black;
+                            w->_color = _color_type::red;
+                            _rotate_right(w, root);
+                            w = x_parent->_right;
+                        }
+
+                        w->_color = x_parent->_color;
+                        x_parent->_color = _color_type::black;
+
+                        if (w->_right) {
+                            w->_right->_color = _color_type::black;
+                        }
+
+                        _rotate_left(x_parent, root);
+                        break;
+                    }
+                } else {
+                    intrusive_set_member *w = x_parent->_left;
+
+                    if (_is_red(w)) {
+                        w->_color = _color_type::black;
+                        x_parent->_color = _color_type::red;
+                        _rotate_right(x_parent, root);
+                        w = x_parent->_left;
+                    }
+
+                    if (!_is_red(w->_right) && !_is_red(w->_left)) {
+                        w->_color = _color_type::red;
+                        x = x_parent;
+                        x_parent = x_parent->_parent;
+                    } else {
+                        if (!_is_red(w->_left)) {
+                            w->_right->_color = _color_type::black;
+                            w->_color = _color_type::red;
+                            _rotate_left(w, root);
+                            w = x_parent->_left;
+                        }
+
+                        w->_color = x_parent->_color;
+                        x_parent->_color = _color_type::black;
+
+                        if (w->_left) {
+                            w->_left->_color = _color_type::black;
+                        }
+
+                        _rotate_right(x_parent, root);
+                        break;
+                    }
+                }
+            }
+
+            if (x) {
+                x->_color = _color_type::black;
+            }
+        }
+
+        z->_reset();
+        static_cast<intrusive_tree_header_type &>(header)._size--;
+    }
+
+    using intrusive_tree_header_type = detail::intrusive_tree_header<Tag>;
+
+    constexpr void _reset() noexcept
+    {
+        _parent = nullptr;
+        _left = nullptr;
+        _right = nullptr;
+        _color = _color_type::red;
+    }
+};
+
+namespace detail {
+
+// The root of a tree, with the header's parent, left and right being the
+// root, minimum and maximum. The size lives here so that nodes unlinking
+// themselves keep it current.
+template <class Tag>
+class intrusive_tree_header : public intrusive_set_member<Tag> {
+  public:
+    constexpr intrusive_tree_header() noexcept
+    {
+        this->_color = member_type::_color_type::header;
+        _clear();
+    }
+
+  private:
+    template <class, class, class, bool>
+    friend class intrusive_tree;
+
+    friend class intrusive_set_member<Tag>;
+
+    using member_type = intrusive_set_member<Tag>;
+
+    std::size_t _size = 0;
+
+    constexpr void _clear() noexcept
+    {
+        this->_parent = nullptr;
+        this->_left = this;
+        this->_right = this;
+        _size = 0;
+    }
+
+    // Points the root back at this header after its fields were swapped or
+    // moved in.
+    constexpr void _adopt() noexcept
+    {
+        if (this->_parent) {
+            this->_parent->_parent = this;
+        } else {
+            this->_left = this;
+            this->_right = this;
+        }
+    }
+};
+
+template <class T, class Tag, class Compare, bool Multi>
+class intrusive_tree {
+  public:
+    using key_type = T;
+    using value_type = T;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using difference_type = std::ptrdiff_t;
+    using size_type = std::size_t;
+    using tag_type = Tag;
+
+    class iterator;
+    class const_iterator;
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    using insert_return_type =
+        std::conditional_t<Multi, iterator, std::pair<iterator, bool>>;
+
+  private:
+    using member_type = intrusive_set_member<Tag>;
+    using header_type = intrusive_tree_header<Tag>;
+
+  public:
+    constexpr intrusive_tree() noexcept(
+        std::is_nothrow_default_constructible_v<Compare>) = default;
+
+    constexpr explicit intrusive_tree(const Compare &comp) : _comp{ comp } {}
+
+    constexpr intrusive_tree(intrusive_tree &&other) noexcept(
+        std::is_nothrow_move_constructible_v<Compare>)
+        : _comp{ std::move(other._comp) }
+    {
+        _swap_nodes(other);
+    }
+
+    intrusive_tree(const intrusive_tree &) = delete;
+
+    constexpr intrusive_tree &operator=(intrusive_tree &&other) noexcept(
+        std::is_nothrow_move_assignable_v<Compare>)
+    {
+        if (this != std::addressof(other)) {
+            clear();
+            _swap_nodes(other);
+            _comp = std::move(other._comp);
+        }
+
+        return *this;
+    }
+
+    intrusive_tree &operator=(const intrusive_tree &) = delete;
+
+    // Unlinks the elements, so they may outlive the tree.
+    constexpr ~intrusive_tree() { clear(); }
+
+    constexpr bool empty() const noexcept { return !_header._size; }
+    constexpr size_type size() const noexcept { return _header._size; }
+
+    constexpr key_compare key_comp() const { return _comp; }
+    constexpr value_compare value_comp() const { return _comp; }
+
+    // Links `value`, which must not be in a tree with this tag. A set leaves
+    // it unlinked if an equivalent element is present; a multiset places it
+    // after its equivalents.
+    constexpr insert_return_type insert(reference value)
+    {
+        member_type *parent = std::addressof(_header);
+        member_type *pos = _header._parent;
+        bool left = true;
+
+        while (pos) {
+            parent = pos;
+            left = _comp(value, _value(pos));
+            pos = left ? pos->_left : pos->_right;
+        }
+
+        if constexpr (!Multi) {
+            member_type *prev = parent;
+
+            if (left) {
+                if (parent == _header._left) {
+                    return { _insert(value, parent, left), true };
+                }
+
+                prev = member_type::_prev(parent);
+            }
+
+            if (!_comp(_value(prev), value)) {
+                return { iterator(prev), false };
+            }
+
+            return { _insert(value, parent, left), true };
+        } else {
+            return _insert(value, parent, left);
+        }
+    }
+
+    // Unlinks the element at `pos`, which may also be given by reference.
+    constexpr iterator erase(const_iterator pos) noexcept
+    {
+        member_type *node = const_cast<member_type *>(pos._pos);
+        iterator next(member_type::_next(node));
+
+        member_type::_erase(*node, _header);
+
+        return next;
+    }
+
+    constexpr iterator erase(const_iterator first,
+                             const_iterator last) noexcept
+    {
+        while (first != last) {
+            first = erase(first);
+        }
+
+        return iterator(const_cast<member_type *>(last._pos));
+    }
+
+    // Unlinks every element, in one pass without rebalancing.
+    constexpr void clear() noexcept
+    {
+        member_type *node = _header._parent;
+
+        while (node) {
+            member_type *next;
+
+            if (node->_left) {
+                next = std::exchange(node->_left, nullptr);
+            } else if (node->_right) {
+                next = std::exchange(node->_right, nullptr);
+            } else {
+                next = node->_parent;
+                node->_reset();
+            }
+
+            node = next != std::addressof(_header) ? next : nullptr;
+        }
+
+        _header._clear();
+    }
+
+    constexpr void swap(intrusive_tree &other) noexcept(
+        std::is_nothrow_swappable_v<Compare>)
+    {
+        using std::swap;
+
+        swap(_comp, other._comp);
+        _swap_nodes(other);
+    }
+
+    friend constexpr void
+    swap(intrusive_tree &lh, intrusive_tree &rh) noexcept(noexcept(lh.swap(rh)))
+    {
+        lh.swap(rh);
+    }
+
+    // Lookups take any `key` that `Compare` orders against the elements.
+    template <class K>
+    constexpr iterator lower_bound(const K &key)
+    {
+        return iterator(_lower_bound(key));
+    }
+
+    template <class K>
+    constexpr const_iterator lower_bound(const K &key) const
+    {
+        return const_iterator(_lower_bound(key));
+    }
+
+    template <class K>
+    constexpr iterator upper_bound(const K &key)
+    {
+        return iterator(_upper_bound(key));
+    }
+
+    template <class K>
+    constexpr const_iterator upper_bound(const K &key) const
+    {
+        return const_iterator(_upper_bound(key));
+    }
+
+    template <class K>
+    constexpr iterator find(const K &key)
+    {
+        return iterator(_find(key));
+    }
+
+    template <class K>
+    constexpr const_iterator find(const K &key) const
+    {
+        return const_iterator(_find(key));
+    }
+
+    template <class K>
+    constexpr bool contains(const K &key) const
+    {
+        return _find(key) != std::addressof(_header);
+    }
+
+    template <class K>
+    constexpr std::pair<iterator, iterator> equal_range(const K &key)
+    {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    template <class K>
+    constexpr std::pair<const_iterator, const_iterator>
+    equal_range(const K &key) const
+    {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    template <class K>
+    constexpr size_type count(const K &key) const
+    {
+        auto [first, last] = equal_range(key);
+        return std::ranges::distance(first, last);
+    }
+
+    constexpr auto begin() noexcept { return iterator(_header._left); }
+
+    constexpr auto begin() const noexcept
+    {
+        return const_iterator(_header._left);
+    }
+
+    constexpr auto end() noexcept
+    {
+        return iterator(std::addressof(_header));
+    }
+
+    constexpr auto end() const noexcept
+    {
+        return const_iterator(std::addressof(_header));
+    }
+
+    constexpr auto cbegin() const noexcept { return begin(); }
+    constexpr auto cend() const noexcept { return end(); }
+
+    constexpr auto rbegin() noexcept { return reverse_iterator(end()); }
+
+    constexpr auto rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    constexpr auto crbegin() const noexcept { return rbegin(); }
+
+    constexpr auto rend() noexcept { return reverse_iterator(begin()); }
+
+    constexpr auto rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr auto crend() const noexcept { return rend(); }
+
+    class iterator {
+      public:
+        using difference_type = intrusive_tree::difference_type;
+        using value_type = intrusive_tree::value_type;
+        using pointer = intrusive_tree::pointer;
+        using reference = intrusive_tree::reference;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_concept = std::bidirectional_iterator_tag;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr iterator(value_type &value) noexcept
+        {
+            _pos = std::addressof(value);
+        }
+
+        constexpr auto &operator++() noexcept
+        {
+            _pos = member_type::_next(_pos);
+            return *this;
+        }
+
+        constexpr auto &operator--() noexcept
+        {
+            _pos = member_type::_prev(_pos);
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept
+        {
+            iterator ret{ *this };
+            ++*this;
+            return ret;
+        }
+
+        constexpr auto operator--(int) noexcept
+        {
+            iterator ret{ *this };
+            --*this;
+            return ret;
+        }
+
+        constexpr auto &operator*() const noexcept
+        {
+            return static_cast<reference>(*_pos);
+        }
+
+        constexpr auto operator->() const noexcept
+        {
+            return static_cast<pointer>(_pos);
+        }
+
+        friend constexpr bool operator==(const iterator &lh,
+                                         const iterator &rh) noexcept = default;
+
+      private:
+        friend intrusive_tree;
+
+        member_type *_pos = nullptr;
+
+        constexpr explicit iterator(member_type *pos) noexcept : _pos{ pos } {}
+    };
+
+    class const_iterator {
+      public:
+        using difference_type = intrusive_tree::difference_type;
+        using value_type = intrusive_tree::value_type;
+        using pointer = intrusive_tree::const_pointer;
+        using reference = intrusive_tree::const_reference;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using iterator_concept = std::bidirectional_iterator_tag;
+
+        constexpr const_iterator() noexcept = default;
+
+        constexpr const_iterator(iterator pos) noexcept : _pos{ pos._pos } {}
+
+        constexpr const_iterator(const value_type &value) noexcept
+        {
+            _pos = std::addressof(value);
+        }
+
+        constexpr auto &operator++() noexcept
+        {
+            _pos = member_type::_next(_pos);
+            return *this;
+        }
+
+        constexpr auto &operator--() noexcept
+        {
+            _pos = member_type::_prev(_pos);
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept
+        {
+            const_iterator ret{ *this };
+            ++*this;
+            return ret;
+        }
+
+        constexpr auto operator--(int) noexcept
+        {
+            const_iterator ret{ *this };
+            --*this;
+            return ret;
+        }
+
+        constexpr auto &operator*() const noexcept
+        {
+            return static_cast<const_reference>(*_pos);
+        }
+
+        constexpr auto operator->() const noexcept
+        {
+            return static_cast<const_pointer>(_pos);
+        }
+
+        friend constexpr bool
+        operator==(const const_iterator &lh,
+                   const const_iterator &rh) noexcept = default;
+
+      private:
+        friend intrusive_tree;
+
+        const member_type *_pos = nullptr;
+
+        constexpr explicit const_iterator(const member_type *pos) noexcept
+            : _pos{ pos }
+        {
+        }
+    };
+
+  private:
+    header_type _header;
+    [[no_unique_address]] Compare _comp;
+
+    static constexpr const_reference _value(const member_type *node) noexcept
+    {
+        return static_cast<const_reference>(*node);
+    }
+
+    constexpr iterator _insert(reference value, member_type *parent,
+                               bool left) noexcept
+    {
+        member_type::_insert(value, parent, left, _header);
+        return iterator(value);
+    }
+
+    constexpr void _swap_nodes(intrusive_tree &other) noexcept
+    {
+        std::swap(_header._parent, other._header._parent);
+        std::swap(_header._left, other._header._left);
+        std::swap(_header._right, other._header._right);
+        std::swap(_header._size, other._header._size);
+        _header._adopt();
+        other._header._adopt();
+    }
+
+    template <class K>
+    constexpr member_type *_lower_bound(const K &key) const
+    {
+        const member_type *bound = std::addressof(_header);
+
+        for (const member_type *pos = _header._parent; pos;) {
+            if (_comp(_value(pos), key)) {
+                pos = pos->_right;
+            } else {
+                bound = pos;
+                pos = pos->_left;
+            }
+        }
+
+        return const_cast<member_type *>(bound);
+    }
+
+    template <class K>
+    constexpr member_type *_upper_bound(const K &key) const
+    {
+        const member_type *bound = std::addressof(_header);
+
+        for (const member_type *pos = _header._parent; pos;) {
+            if (_comp(key, _value(pos))) {
+                bound = pos;
+                pos = pos->_left;
+            } else {
+                pos = pos->_right;
+            }
+        }
+
+        return const_cast<member_type *>(bound);
+    }
+
+    template <class K>
+    constexpr member_type *_find(const K &key) const
+    {
+        member_type *pos = _lower_bound(key);
+        member_type *end = const_cast<header_type *>(std::addressof(_header));
+
+        return pos != end && _comp(key, _value(pos)) ? end : pos;
+    }
+};
+
+} // namespace detail
+
+template <class T, class Tag, class Compare = std::less<>>
+    requires std::derived_from<T, intrusive_set_member<Tag>> &&
+        std::same_as<T, std::remove_cv_t<T>>
+using intrusive_set = detail::intrusive_tree<T, Tag, Compare, false>;
+
+template <class T, class Tag, class Compare = std::less<>>
+    requires std::derived_from<T, intrusive_set_member<Tag>> &&
+        std::same_as<T, std::remove_cv_t<T>>
+using intrusive_multiset = detail::intrusive_tree<T, Tag, Compare, true>;
+
+} // namespace nothing
+
+#endif
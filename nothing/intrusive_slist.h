@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_INTRUSIVE_SLIST_H_
+#define NOTHING_INTRUSIVE_SLIST_H_
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace nothing {
+
+/*
+ * Hook for a singly linked list. A node cannot unlink itself without its
+ * predecessor, so unlike `intrusive_list_member` it is not removed on
+ * destruction: it must be erased from its list first. For the same reason a
+ * copy cannot take its source's place; a copied element is a new, unlinked
+ * node, and assigning one element to another leaves both where they were.
+ */
+template <class Tag>
+class intrusive_slist_member {
+  public:
+    using tag_type = Tag;
+
+    constexpr intrusive_slist_member() noexcept : _next{ nullptr } {}
+
+    constexpr intrusive_slist_member(const intrusive_slist_member &) noexcept
+        : _next{ nullptr }
+    {
+    }
+
+    constexpr auto &operator=(const intrusive_slist_member &) noexcept
+    {
+        return *this;
+    }
+
+  private:
+    template <class, class>
+    friend class intrusive_slist;
+
+    template <class, class>
+    friend class intrusive_mpsc_queue;
+
+    intrusive_slist_member *_next;
+
+    friend constexpr bool operator==(const intrusive_slist_member &lh,
+                                     const intrusive_slist_member &rh) noexcept
+    {
+        return std::addressof(lh) == std::addressof(rh);
+    }
+};
+
+template <class T, class Tag>
+    requires std::derived_from<T, intrusive_slist_member<Tag>> &&
+        std::same_as<T, std::remove_cv_t<T>>
+class intrusive_slist {
+  public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using difference_type = std::ptrdiff_t;
+    using size_type = std::size_t;
+    using tag_type = Tag;
+
+    class iterator;
+    class const_iterator;
+
+  private:
+    using member_type = intrusive_slist_member<Tag>;
+
+  public:
+    constexpr intrusive_slist() noexcept = default;
+
+    constexpr intrusive_slist(intrusive_slist &&other) noexcept
+    {
+        swap(other);
+    }
+
+    intrusive_slist(const intrusive_slist &) = delete;
+
+    constexpr intrusive_slist &operator=(intrusive_slist &&other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            clear();
+            swap(other);
+        }
+
+        return *this;
+    }
+
+    intrusive_slist &operator=(const intrusive_slist &) = delete;
+
+    constexpr void push_front(reference value) noexcept
+    {
+        insert_after(before_begin(), value);
+    }
+
+    constexpr void pop_front() noexcept { erase_after(before_begin()); }
+
+    constexpr auto &front() noexcept
+    {
+        return static_cast<reference>(*_root._next);
+    }
+
+    constexpr auto &front() const noexcept
+    {
+        return static_cast<const_reference>(*_root._next);
+    }
+
+    constexpr bool empty() const noexcept { return !_root._next; }
+
+    // Links `value`, which must not be in a list with this tag, after `pos`.
+    constexpr iterator insert_after(const_iterator pos,
+                                    reference value) noexcept
+    {
+        member_type *pos_ptr = const_cast<member_type *>(pos._pos);
+        member_type *value_ptr = std::addressof(value);
+
+        value_ptr->_next = pos_ptr->_next;
+        pos_ptr->_next = value_ptr;
+
+        return iterator(value_ptr);
+    }
+
+    constexpr iterator erase_after(const_iterator pos) noexcept
+    {
+        member_type *pos_ptr = const_cast<member_type *>(pos._pos);
+        member_type *erased = pos_ptr->_next;
+
+        pos_ptr->_next = erased->_next;
+        erased->_next = nullptr;
+
+        return iterator(pos_ptr->_next);
+    }
+
+    // Erases the elements in `(pos, last)`.
+    constexpr iterator erase_after(const_iterator pos,
+                                   const_iterator last) noexcept
+    {
+        member_type *pos_ptr = const_cast<member_type *>(pos._pos);
+        member_type *last_ptr = const_cast<member_type *>(last._pos);
+
+        for (member_type *curr = pos_ptr->_next, *next; curr != last_ptr;
+             curr = next) {
+            next = curr->_next;
+            curr->_next = nullptr;
+        }
+
+        pos_ptr->_next = last_ptr;
+
+        return iterator(last_ptr);
+    }
+
+    constexpr void clear() noexcept { erase_after(before_begin(), end()); }
+
+    constexpr void swap(intrusive_slist &other) noexcept
+    {
+        std::swap(_root._next, other._root._next);
+    }
+
+    friend constexpr void swap(intrusive_slist &lh,
+                               intrusive_slist &rh) noexcept
+    {
+        lh.swap(rh);
+    }
+
+    constexpr auto before_begin() noexcept
+    {
+        return iterator(std::addressof(_root));
+    }
+
+    constexpr auto before_begin() const noexcept
+    {
+        return const_iterator(std::addressof(_root));
+    }
+
+    constexpr auto begin() noexcept { return iterator(_root._next); }
+
+    constexpr auto begin() const noexcept
+    {
+        return const_iterator(_root._next);
+    }
+
+    constexpr auto end() noexcept { return iterator(); }
+    constexpr auto end() const noexcept { return const_iterator(); }
+
+    constexpr auto cbefore_begin() const noexcept { return before_begin(); }
+    constexpr auto cbegin() const noexcept { return begin(); }
+    constexpr auto cend() const noexcept { return end(); }
+
+    constexpr size_type count() const noexcept
+    {
+        return std::ranges::distance(*this);
+    }
+
+    class iterator {
+      public:
+        using difference_type = intrusive_slist::difference_type;
+        using value_type = intrusive_slist::value_type;
+        using pointer = intrusive_slist::pointer;
+        using reference = intrusive_slist::reference;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        constexpr iterator() noexcept = default;
+
+        constexpr iterator(value_type &value) noexcept
+        {
+            _pos = std::addressof(value);
+        }
+
+        constexpr auto &operator++() noexcept
+        {
+            _pos = _pos->_next;
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept
+        {
+            iterator ret{ *this };
+            _pos = _pos->_next;
+            return ret;
+        }
+
+        constexpr auto &operator*() const noexcept
+        {
+            return static_cast<reference>(*_pos);
+        }
+
+        constexpr auto operator->() const noexcept
+        {
+            return static_cast<pointer>(_pos);
+        }
+
+        friend constexpr bool operator==(const iterator &lh,
+                                         const iterator &rh) noexcept = default;
+
+      private:
+        friend intrusive_slist;
+
+        member_type *_pos = nullptr;
+
+        constexpr explicit iterator(member_type *pos) noexcept : _pos{ pos } {}
+    };
+
+    class const_iterator {
+      public:
+        using difference_type = intrusive_slist::difference_type;
+        using value_type = intrusive_slist::value_type;
+        using pointer = intrusive_slist::const_pointer;
+        using reference = intrusive_slist::const_reference;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        constexpr const_iterator() noexcept = default;
+
+        constexpr const_iterator(iterator pos) noexcept : _pos{ pos._pos } {}
+
+        constexpr const_iterator(const value_type &value) noexcept
+        {
+            _pos = std::addressof(value);
+        }
+
+        constexpr auto &operator++() noexcept
+        {
+            _pos = _pos->_next;
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept
+        {
+            const_iterator ret{ *this };
+            _pos = _pos->_next;
+            return ret;
+        }
+
+        constexpr auto &operator*() const noexcept
+        {
+            return static_cast<const_reference>(*_pos);
+        }
+
+        constexpr auto operator->() const noexcept
+        {
+            return static_cast<const_pointer>(_pos);
+        }
+
+        friend constexpr bool
+        operator==(const const_iterator &lh,
+                   const const_iterator &rh) noexcept = default;
+
+      private:
+        friend intrusive_slist;
+
+        const member_type *_pos = nullptr;
+
+        constexpr explicit const_iterator(const member_type *pos) noexcept
+            : _pos{ pos }
+        {
+        }
+    };
+
+  private:
+    member_type _root;
+};
+
+} // namespace nothing
+
+#endif
@@ -0,0 +1,660 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_INTRUSIVE_UNORDERED_SET_H_
+#define NOTHING_INTRUSIVE_UNORDERED_SET_H_
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace nothing {
+
+/*
+ * Hook for `intrusive_unordered_set`. Buckets are null-terminated chains in
+ * which each node points back at the link referring to it, so a node is
+ * unlinked in constant time without knowing its bucket. The hook also caches
+ * the element's hash. It is not unlinked on destruction: erase it first.
+ * Copying an element gives a node in no bucket and with no cached hash, and
+ * assignment touches neither the chain nor the hash of either side.
+ */
+template <class Tag>
+class intrusive_unordered_set_member {
+  public:
+    using tag_type = Tag;
+
+    constexpr intrusive_unordered_set_member() noexcept = default;
+
+    constexpr intrusive_unordered_set_member(
+        const intrusive_unordered_set_member &) noexcept
+    {
+    }
+
+    constexpr auto &operator=(const intrusive_unordered_set_member &) noexcept
+    {
+        return *this;
+    }
+
+  private:
+    template <class, class, class, class>
+    friend class intrusive_unordered_set;
+
+    intrusive_unordered_set_member *_next = nullptr;
+    intrusive_unordered_set_member **_pprev = nullptr;
+    std::size_t _hash = 0;
+
+    constexpr void _link(intrusive_unordered_set_member *&head) noexcept
+    {
+        _next = head;
+        _pprev = std::addressof(head);
+
+        if (head) {
+            head->_pprev = std::addressof(_next);
+        }
+
+        head = this;
+    }
+
+    constexpr void _unlink() noexcept
+    {
+        *_pprev = _next;
+
+        if (_next) {
+            _next->_pprev = _pprev;
+        }
+
+        _next = nullptr;
+        _pprev = nullptr;
+    }
+};
+
+/*
+ * Hash set of elements hooked by `intrusive_unordered_set_member<Tag>`, with
+ * a power of two buckets and a maximum load factor of one.
+ *
+ * Growing does not move the elements at once. Each insertion moves a few
+ * buckets of the old table over, finishing well before the next growth, and
+ * meanwhile a hash whose old bucket has not been moved still lives there.
+ * Large bucket arrays are mapped directly, so the system zeroes a page at a
+ * time as it is touched, and the moved-out front of the old array is
+ * unmapped a chunk at a time rather than all at once at the end.
+ *
+ * Inserting invalidates iterators. Erasing invalidates only iterators to the
+ * erased element.
+ */
+template <class T, class Tag, class Hash = std::hash<T>,
+          class KeyEqual = std::equal_to<>>
+    requires std::derived_from<T, intrusive_unordered_set_member<Tag>> &&
+        std::same_as<T, std::remove_cv_t<T>>
+class intrusive_unordered_set {
+  public:
+    using key_type = T;
+    using value_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using difference_type = std::ptrdiff_t;
+    using size_type = std::size_t;
+    using tag_type = Tag;
+
+    class iterator;
+    class const_iterator;
+
+  private:
+    using member_type = intrusive_unordered_set_member<Tag>;
+
+    // Buckets of the old table moved over per insertion while growing.
+    static constexpr size_type _rehash_step = 8;
+    static constexpr size_type _min_bucket_count = 16;
+
+    class _bucket_array {
+      public:
+        member_type **buckets = nullptr;
+        size_type size = 0;
+        int shift = 64;
+
+        _bucket_array() noexcept = default;
+
+        // Zeroed buckets; all-zero bytes are null pointers on every
+        // supported target.
+        explicit _bucket_array(size_type count)
+            : size{ count }, shift{ 64 - std::countr_zero(count) }
+        {
+            std::size_t bytes = count * sizeof(member_type *);
+            void *ptr = nullptr;
+
+#if __has_include(<sys/mman.h>)
+            if (bytes >= _chunk_size()) {
+                ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                _mapped = ptr != MAP_FAILED;
+                ptr = _mapped ? ptr : nullptr;
+            } else
+#endif
+            {
+                ptr = std::calloc(count, sizeof(member_type *));
+            }
+
+            if (!ptr) {
+                throw std::bad_alloc();
+            }
+
+            buckets = static_cast<member_type **>(ptr);
+        }
+
+        _bucket_array(_bucket_array &&other) noexcept
+            : buckets{ std::exchange(other.buckets, nullptr) },
+              size{ std::exchange(other.size, 0) },
+              shift{ std::exchange(other.shift, 64) },
+              _released{ std::exchange(other._released, 0) },
+              _mapped{ std::exchange(other._mapped, false) }
+        {
+        }
+
+        _bucket_array &operator=(_bucket_array &&other) noexcept
+        {
+            if (this != std::addressof(other)) {
+                _free();
+                buckets = std::exchange(other.buckets, nullptr);
+                size = std::exchange(other.size, 0);
+                shift = std::exchange(other.shift, 64);
+                _released = std::exchange(other._released, 0);
+                _mapped = std::exchange(other._mapped, false);
+            }
+
+            return *this;
+        }
+
+        ~_bucket_array() { _free(); }
+
+        // Fibonacci hashing, so that weak hashes such as the identity still
+        // spread over the high bits used as the index.
+        size_type index(size_type hash) const noexcept
+        {
+            return (uint64_t{ hash } * 0x9E3779B97F4A7C15) >> shift;
+        }
+
+        // Returns the whole chunks before bucket `end`, which will not be
+        // used again, to the system.
+        void release_front(size_type end) noexcept
+        {
+#if __has_include(<sys/mman.h>)
+            std::size_t chunk = _chunk_size();
+            std::size_t bytes = end * sizeof(member_type *) / chunk * chunk;
+
+            if (_mapped && bytes > _released) {
+                ::munmap(reinterpret_cast<char *>(buckets) + _released,
+                         bytes - _released);
+                _released = bytes;
+            }
+#else
+            static_cast<void>(end);
+#endif
+        }
+
+      private:
+        std::size_t _released = 0;
+        bool _mapped = false;
+
+#if __has_include(<sys/mman.h>)
+        static std::size_t _chunk_size() noexcept
+        {
+            static const std::size_t chunk = std::max<std::size_t>(
+                ::sysconf(_SC_PAGESIZE), std::size_t{ 1 } << 16);
+            return chunk;
+        }
+#endif
+
+        void _free() noexcept
+        {
+#if __has_include(<sys/mman.h>)
+            if (_mapped) {
+                std::size_t bytes = size * sizeof(member_type *);
+
+                if (bytes > _released) {
+                    ::munmap(reinterpret_cast<char *>(buckets) + _released,
+                             bytes - _released);
+                }
+
+                return;
+            }
+#endif
+            std::free(buckets);
+        }
+    };
+
+  public:
+    intrusive_unordered_set() = default;
+
+    explicit intrusive_unordered_set(size_type bucket_count,
+                                     const Hash &hash = Hash(),
+                                     const KeyEqual &equal = KeyEqual())
+        : _hash{ hash }, _equal{ equal }
+    {
+        reserve(bucket_count);
+    }
+
+    intrusive_unordered_set(intrusive_unordered_set &&other) noexcept(
+        std::is_nothrow_move_constructible_v<Hash> &&
+        std::is_nothrow_move_constructible_v<KeyEqual>)
+        : _table{ std::exchange(other._table, {}) },
+          _old{ std::exchange(other._old, {}) },
+          _rehash_pos{ std::exchange(other._rehash_pos, 0) },
+          _size{ std::exchange(other._size, 0) },
+          _hash{ std::move(other._hash) },
+          _equal{ std::move(other._equal) }
+    {
+    }
+
+    intrusive_unordered_set(const intrusive_unordered_set &) = delete;
+
+    intrusive_unordered_set &
+    operator=(intrusive_unordered_set &&other) noexcept(
+        std::is_nothrow_move_assignable_v<Hash> &&
+        std::is_nothrow_move_assignable_v<KeyEqual>)
+    {
+        if (this != std::addressof(other)) {
+            clear();
+            _table = std::exchange(other._table, {});
+            _old = std::exchange(other._old, {});
+            _rehash_pos = std::exchange(other._rehash_pos, 0);
+            _size = std::exchange(other._size, 0);
+            _hash = std::move(other._hash);
+            _equal = std::move(other._equal);
+        }
+
+        return *this;
+    }
+
+    intrusive_unordered_set &
+    operator=(const intrusive_unordered_set &) = delete;
+
+    // Unlinks the elements, so they may outlive the set.
+    ~intrusive_unordered_set() { clear(); }
+
+    bool empty() const noexcept { return !_size; }
+    size_type size() const noexcept { return _size; }
+    size_type bucket_count() const noexcept { return _table.size; }
+
+    float load_factor() const noexcept
+    {
+        return _table.size ? static_cast<float>(_size) / _table.size : 0;
+    }
+
+    // Whether the elements of an old table are still being moved over.
+    bool rehashing() const noexcept { return _old.size; }
+
+    hasher hash_function() const { return _hash; }
+    key_equal key_eq() const { return _equal; }
+
+    // Links `value`, which must not be in a set with this tag, unless an
+    // equal element is present.
+    std::pair<iterator, bool> insert(reference value)
+    {
+        size_type hash = _hash(value);
+
+        if (member_type *node = _find(value, hash)) {
+            return { iterator(this, node), false };
+        }
+
+        if (_size >= _table.size) {
+            _grow(std::max(2 * _table.size, _min_bucket_count));
+        }
+
+        _migrate(_rehash_step);
+
+        member_type *node = std::addressof(value);
+
+        node->_hash = hash;
+        node->_link(_bucket(hash));
+        _size++;
+
+        return { iterator(this, node), true };
+    }
+
+    iterator erase(const_iterator pos) noexcept
+    {
+        member_type *node = const_cast<member_type *>(pos._node);
+        iterator next(this, _next(node));
+
+        node->_unlink();
+        _size--;
+
+        return next;
+    }
+
+    // Unlinks `value`, which must be in this set.
+    void erase(reference value) noexcept
+    {
+        static_cast<member_type &>(value)._unlink();
+        _size--;
+    }
+
+    void clear() noexcept
+    {
+        _clear(_old, _rehash_pos);
+        _clear(_table, 0);
+        _old = {};
+        _rehash_pos = 0;
+        _size = 0;
+    }
+
+    // Makes room for `count` elements without growing, moving the elements
+    // over at once.
+    void reserve(size_type count)
+    {
+        _migrate(_old.size);
+
+        if (count > _table.size) {
+            _grow(std::max(std::bit_ceil(count), _min_bucket_count));
+            _migrate(_old.size);
+        }
+    }
+
+    // Lookups take any `key` that `Hash` and `KeyEqual` accept along with
+    // the elements.
+    template <class K>
+    iterator find(const K &key)
+    {
+        return iterator(this, _find(key, _hash(key)));
+    }
+
+    template <class K>
+    const_iterator find(const K &key) const
+    {
+        return const_iterator(this, _find(key, _hash(key)));
+    }
+
+    template <class K>
+    bool contains(const K &key) const
+    {
+        return _find(key, _hash(key));
+    }
+
+    template <class K>
+    size_type count(const K &key) const
+    {
+        return contains(key);
+    }
+
+    iterator begin() noexcept { return iterator(this, _first(&_old, 0)); }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, _first(&_old, 0));
+    }
+
+    iterator end() noexcept { return iterator(this, nullptr); }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, nullptr);
+    }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    class iterator {
+      public:
+        using difference_type = intrusive_unordered_set::difference_type;
+        using value_type = intrusive_unordered_set::value_type;
+        using pointer = intrusive_unordered_set::pointer;
+        using reference = intrusive_unordered_set::reference;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        iterator() noexcept = default;
+
+        auto &operator++() noexcept
+        {
+            _node = _set->_next(_node);
+            return *this;
+        }
+
+        auto operator++(int) noexcept
+        {
+            iterator ret{ *this };
+            ++*this;
+            return ret;
+        }
+
+        auto &operator*() const noexcept
+        {
+            return static_cast<reference>(*_node);
+        }
+
+        auto operator->() const noexcept
+        {
+            return static_cast<pointer>(_node);
+        }
+
+        friend bool operator==(const iterator &lh, const iterator &rh) noexcept
+        {
+            return lh._node == rh._node;
+        }
+
+      private:
+        friend intrusive_unordered_set;
+
+        const intrusive_unordered_set *_set = nullptr;
+        member_type *_node = nullptr;
+
+        iterator(const intrusive_unordered_set *set, member_type *node) noexcept
+            : _set{ set }, _node{ node }
+        {
+        }
+    };
+
+    class const_iterator {
+      public:
+        using difference_type = intrusive_unordered_set::difference_type;
+        using value_type = intrusive_unordered_set::value_type;
+        using pointer = intrusive_unordered_set::const_pointer;
+        using reference = intrusive_unordered_set::const_reference;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        const_iterator() noexcept = default;
+
+        const_iterator(iterator pos) noexcept
+            : _set{ pos._set }, _node{ pos._node }
+        {
+        }
+
+        auto &operator++() noexcept
+        {
+            _node = _set->_next(_node);
+            return *this;
+        }
+
+        auto operator++(int) noexcept
+        {
+            const_iterator ret{ *this };
+            ++*this;
+            return ret;
+        }
+
+        auto &operator*() const noexcept
+        {
+            return static_cast<reference>(*_node);
+        }
+
+        auto operator->() const noexcept
+        {
+            return static_cast<pointer>(_node);
+        }
+
+        friend bool operator==(const const_iterator &lh,
+                               const const_iterator &rh) noexcept
+        {
+            return lh._node == rh._node;
+        }
+
+      private:
+        friend intrusive_unordered_set;
+
+        const intrusive_unordered_set *_set = nullptr;
+        const member_type *_node = nullptr;
+
+        const_iterator(const intrusive_unordered_set *set,
+                       const member_type *node) noexcept
+            : _set{ set }, _node{ node }
+        {
+        }
+    };
+
+  private:
+    _bucket_array _table;
+    _bucket_array _old;
+    size_type _rehash_pos = 0;
+    size_type _size = 0;
+    [[no_unique_address]] Hash _hash;
+    [[no_unique_address]] KeyEqual _equal;
+
+    static const_reference _value(const member_type *node) noexcept
+    {
+        return static_cast<const_reference>(*node);
+    }
+
+    // Starts moving the elements to a table of `count` buckets, which is a
+    // power of two. An unfinished move is completed first.
+    void _grow(size_type count)
+    {
+        _migrate(_old.size);
+
+        _bucket_array table(count);
+
+        _old = std::exchange(_table, std::move(table));
+        _rehash_pos = 0;
+
+        if (!_old.size) {
+            _old = {};
+        }
+    }
+
+    // Moves up to `count` buckets of the old table over.
+    void _migrate(size_type count) noexcept
+    {
+        for (; _old.size && count; count--) {
+            member_type *node =
+                std::exchange(_old.buckets[_rehash_pos], nullptr);
+
+            while (node) {
+                member_type *next = node->_next;
+                node->_link(_table.buckets[_table.index(node->_hash)]);
+                node = next;
+            }
+
+            if (++_rehash_pos == _old.size) {
+                _old = {};
+                _rehash_pos = 0;
+            }
+        }
+
+        _old.release_front(_rehash_pos);
+    }
+
+    // Head of the chain holding `hash`; the table must have buckets.
+    member_type *&_bucket(size_type hash) const noexcept
+    {
+        if (_old.size) {
+            size_type i = _old.index(hash);
+
+            if (i >= _rehash_pos) {
+                return _old.buckets[i];
+            }
+        }
+
+        return _table.buckets[_table.index(hash)];
+    }
+
+    template <class K>
+    member_type *_find(const K &key, size_type hash) const
+    {
+        if (!_table.size) {
+            return nullptr;
+        }
+
+        for (member_type *node = _bucket(hash); node; node = node->_next) {
+            if (node->_hash == hash && _equal(_value(node), key)) {
+                return node;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // First node in the buckets from `i` of `table` on, continuing from the
+    // old table into the new one.
+    member_type *_first(const _bucket_array *table, size_type i) const noexcept
+    {
+        if (table == &_old) {
+            for (i = std::max(i, _rehash_pos); i < _old.size; i++) {
+                if (_old.buckets[i]) {
+                    return _old.buckets[i];
+                }
+            }
+
+            i = 0;
+        }
+
+        for (; i < _table.size; i++) {
+            if (_table.buckets[i]) {
+                return _table.buckets[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    member_type *_next(const member_type *node) const noexcept
+    {
+        if (node->_next) {
+            return node->_next;
+        }
+
+        if (_old.size) {
+            size_type i = _old.index(node->_hash);
+
+            if (i >= _rehash_pos) {
+                return _first(&_old, i + 1);
+            }
+        }
+
+        return _first(&_table, _table.index(node->_hash) + 1);
+    }
+
+    static void _clear(_bucket_array &table, size_type first) noexcept
+    {
+        for (size_type i = first; i < table.size; i++) {
+            member_type *node = std::exchange(table.buckets[i], nullptr);
+
+            while (node) {
+                member_type *next = node->_next;
+                node->_next = nullptr;
+                node->_pprev = nullptr;
+                node = next;
+            }
+        }
+    }
+};
+
+} // namespace nothing
+
+#endif
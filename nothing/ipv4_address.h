@@ -4,25 +4,171 @@
 #ifndef NOTHING_IPV4_ADDRESS_H_
 #define NOTHING_IPV4_ADDRESS_H_
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <functional>
 #include <iostream>
-#include <charconv>
+#include <iterator>
+#include <cstring>
 #include <memory_resource>
+#include <system_error>
+#include <nothing/bit.h>
 #include <nothing/unaligned.h>
 #include <nothing/ascii.h>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace nothing {
 
+namespace detail {
+
+#if defined(__SSSE3__)
+
+struct ipv4_parse_pattern {
+    std::array<int8_t, 16> shuffle;
+    std::array<int32_t, 4> min;
+};
+
+// Indexed by the lengths of the four octets, each in 1..3, as base-3 digits.
+// The shuffle right-aligns each octet's digits into its own 32-bit lane as
+// hundreds, tens, ones; `min` is the smallest value without a leading zero.
+inline constexpr auto ipv4_parse_patterns = [] {
+    std::array<ipv4_parse_pattern, 81> patterns{};
+
+    for (int key = 0; key < 81; key++) {
+        int start = 0;
+
+        for (int i = 0, scale = 27; i < 4; i++, scale /= 3) {
+            int size = key / scale % 3 + 1;
+
+            for (int j = 0; j < 3; j++) {
+                int pos = start + size - 3 + j;
+                patterns[key].shuffle[4 * i + j] = pos < start ? -1 : pos;
+            }
+
+            patterns[key].shuffle[4 * i + 3] = -1;
+            patterns[key].min[i] = size == 1 ? 0 : size == 2 ? 10 : 100;
+            start += size + 1;
+        }
+    }
+
+    return patterns;
+}();
+
+// Parses a dotted quad from the start of `src` with a single 16-byte load:
+// dots and digits are found by compare masks, and the octets are gathered
+// and converted together. Returns the number of characters consumed, or zero
+// for anything but a plain well-formed address, which is left to the scalar
+// parser so that every edge case keeps its exact behavior.
+inline std::size_t
+ipv4_parse_simd(const char *src, std::size_t size, uint32_t &octets) noexcept
+{
+    __m128i chars;
+
+    if (size >= 16) {
+        chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    } else if (size) {
+        char buf[16]{};
+        std::memcpy(buf, src, size);
+        chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+    } else {
+        return 0;
+    }
+
+    __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    unsigned digit_mask = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits));
+    unsigned dot_mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('.')));
+
+    unsigned p0 = std::countr_zero(dot_mask);
+    dot_mask &= dot_mask - 1;
+    unsigned p1 = std::countr_zero(dot_mask);
+    dot_mask &= dot_mask - 1;
+
+    if (!dot_mask) {
+        return 0;
+    }
+
+    unsigned p2 = std::countr_zero(dot_mask);
+    unsigned dots = 1u << p0 | 1u << p1 | 1u << p2;
+
+    unsigned l0 = p0 - 1;
+    unsigned l1 = p1 - p0 - 2;
+    unsigned l2 = p2 - p1 - 2;
+    unsigned l3 = std::countr_zero(~digit_mask >> (p2 + 1)) - 1;
+
+    if (l0 > 2 || l1 > 2 || l2 > 2 || l3 > 2) {
+        return 0;
+    }
+
+    unsigned end = p2 + l3 + 2;
+    unsigned range = (1u << end) - 1;
+
+    if ((digit_mask & range) != (range & ~dots)) {
+        return 0;
+    }
+
+    const auto &pattern = ipv4_parse_patterns[l0 * 27 + l1 * 9 + l2 * 3 + l3];
+    __m128i values = _mm_madd_epi16(
+        _mm_maddubs_epi16(
+            _mm_shuffle_epi8(digits,
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                                 pattern.shuffle.data()))),
+            _mm_set1_epi32(0x00010A64)),
+        _mm_set1_epi16(1));
+    __m128i invalid = _mm_or_si128(
+        _mm_cmpgt_epi32(values, _mm_set1_epi32(255)),
+        _mm_cmplt_epi32(values,
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                            pattern.min.data()))));
+
+    if (_mm_movemask_epi8(invalid)) {
+        return 0;
+    }
+
+    values = _mm_packs_epi32(values, values);
+    octets = _mm_cvtsi128_si32(_mm_packus_epi16(values, values));
+
+    return end;
+}
+
+#endif
+
+// Decimal digits of each octet value in the first three bytes, followed by
+// the number of digits, so an octet is emitted with one four-byte copy.
+inline constexpr auto ipv4_octet_digits = [] {
+    std::array<std::array<char, 4>, 256> table{};
+
+    for (int value = 0; value < 256; value++) {
+        auto &entry = table[value];
+        int size = value >= 100 ? 3 : value >= 10 ? 2 : 1;
+
+        for (int i = size - 1, rest = value; i >= 0; i--, rest /= 10) {
+            entry[i] = '0' + rest % 10;
+        }
+
+        entry[3] = size;
+    }
+
+    return table;
+}();
+
+} // namespace detail
+
 class ipv4_address {
   private:
     using bytes_base = std::array<uint8_t, 4>;
 
   public:
-    using uint_type = uint64_t;
+    using uint_type = uint32_t;
 
     struct bytes_type : bytes_base {
         template <std::convertible_to<uint8_t>... Args>
@@ -35,25 +181,28 @@ class ipv4_address {
     static constexpr size_t string_size = 16;
 
     constexpr ipv4_address() noexcept : _data{} {}
-    constexpr ipv4_address(const bytes_type &value) noexcept : _data{ value } {}
+
+    constexpr ipv4_address(const bytes_type &value) noexcept
+        : _data{ std::bit_cast<uint32_t>(value) }
+    {
+    }
+
     constexpr ipv4_address(uint_type value) noexcept
-        : _data{
-              (value >> 24) & 0xFF,
-              (value >> 16) & 0xFF,
-              (value >> 8) & 0xFF,
-              value & 0xFF,
-          }
+        : _data{ big_endian(value) }
     {
     }
 
-    constexpr auto to_uint() const noexcept
+    // Address from its network-order representation, as in `in_addr`.
+    static constexpr ipv4_address from_network_order(uint32_t value) noexcept
     {
-        return (static_cast<uint_type>(_data[0]) << 24) |
-               (static_cast<uint_type>(_data[1]) << 16) |
-               (static_cast<uint_type>(_data[2]) << 8) |
-               (static_cast<uint_type>(_data[3]));
+        ipv4_address addr;
+        addr._data = value;
+        return addr;
     }
 
+    constexpr uint_type to_uint() const noexcept { return big_endian(_data); }
+    constexpr uint32_t to_network_order() const noexcept { return _data; }
+
     template <class Allocator = std::allocator<char>>
     constexpr auto to_string(const Allocator &alloc = Allocator()) const
     {
@@ -61,7 +210,7 @@ class ipv4_address {
             std::basic_string<char, std::char_traits<char>, Allocator>;
 
         char buf[string_size];
-        char *end = to_chars(buf);
+        char *end = format(buf);
 
         return string_type(buf, end, alloc);
     }
@@ -69,17 +218,47 @@ class ipv4_address {
     template <std::output_iterator<char> Out>
     constexpr Out to_chars(Out dest) const
     {
-        for (int i = 0; i < 3; i++) {
-            dest = _to_chars_part(_data[i], dest);
-            *dest = '.';
-            ++dest;
+        bytes_type bytes = to_bytes();
+
+        for (int i = 0; i < 4; i++) {
+            const auto &digits = detail::ipv4_octet_digits[bytes[i]];
+
+            if (i) {
+                *dest = '.';
+                ++dest;
+            }
+
+            dest = std::copy_n(digits.begin(), digits[3], dest);
         }
 
-        dest = _to_chars_part(_data[3], dest);
         return dest;
     }
 
-    constexpr bytes_type to_bytes() const noexcept { return _data; }
+    // Writes the address to `dest` without branching on the octet values,
+    // and returns the end of the text. `dest` must have room for
+    // `string_size` characters, though the text itself may be shorter.
+    constexpr char *format(char *dest) const noexcept
+    {
+        bytes_type bytes = to_bytes();
+
+        for (int i = 0; i < 3; i++) {
+            const auto &digits = detail::ipv4_octet_digits[bytes[i]];
+
+            std::copy_n(digits.begin(), 4, dest);
+            dest += digits[3];
+            *dest++ = '.';
+        }
+
+        const auto &digits = detail::ipv4_octet_digits[bytes[3]];
+        std::copy_n(digits.begin(), 4, dest);
+
+        return dest + digits[3];
+    }
+
+    constexpr bytes_type to_bytes() const noexcept
+    {
+        return std::bit_cast<bytes_type>(_data);
+    }
 
     constexpr bool is_loopback() const noexcept
     {
@@ -94,7 +273,7 @@ class ipv4_address {
     constexpr bool is_private() const noexcept
     {
         uint32_t value = to_uint();
-        return (value & 0xFF000000) == 0xA0000000 || // 10.0.0.0/8
+        return (value & 0xFF000000) == 0x0A000000 || // 10.0.0.0/8
                (value & 0xFFC00000) == 0x64400000 || // 100.64.0.0/10
                (value & 0xFFF00000) == 0xAC100000 || // 172.16.0.0/12
                (value & 0xFFFFFF00) == 0xC0000000 || // 192.0.0.0/24
@@ -146,7 +325,7 @@ class ipv4_address {
     static ipv4_address from_string(std::string_view src,
                                     std::error_code &error) noexcept
     {
-        std::string_view::iterator last;
+        std::string_view::iterator last = src.begin();
         ipv4_address addr = from_string(src, last, error);
 
         if (last != src.end()) {
@@ -160,6 +339,18 @@ class ipv4_address {
                                     std::string_view::iterator &last,
                                     std::error_code &error) noexcept
     {
+#if defined(__SSSE3__)
+        uint32_t octets;
+
+        if (std::size_t count =
+                detail::ipv4_parse_simd(src.data(), src.size(), octets)) {
+            last = src.begin() + count;
+            error.clear();
+
+            return from_network_order(octets);
+        }
+#endif
+
         std::string_view::iterator pos = src.begin();
         std::string_view::iterator end = src.end();
         bytes_type data;
@@ -201,29 +392,366 @@ class ipv4_address {
         return ipv4_address{ data };
     }
 
+    // Parses each string of `src` into the matching element of `dest`,
+    // stopping at the first invalid one or when either span runs out. Returns
+    // the number of addresses parsed.
+    static std::size_t from_string(std::span<const std::string_view> src,
+                                   std::span<ipv4_address> dest)
+    {
+        std::error_code error;
+        std::size_t count = from_string(src, dest, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return count;
+    }
+
+    static std::size_t from_string(std::span<const std::string_view> src,
+                                   std::span<ipv4_address> dest,
+                                   std::error_code &error) noexcept
+    {
+        std::size_t size = std::min(src.size(), dest.size());
+
+        for (std::size_t i = 0; i < size; i++) {
+            dest[i] = from_string(src[i], error);
+
+            if (error) {
+                return i;
+            }
+        }
+
+        error.clear();
+        return size;
+    }
+
+    // Parses addresses from `src`, one per line, with lines ending in "\n" or
+    // "\r\n". Stops at the end of `src`, when `dest` is full or at the first
+    // invalid line, and returns the number of addresses parsed. `last` is set
+    // to the start of the first line not parsed.
+    static std::size_t from_lines(std::string_view src,
+                                  std::span<ipv4_address> dest,
+                                  std::string_view::iterator &last)
+    {
+        std::error_code error;
+        std::size_t count = from_lines(src, dest, last, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return count;
+    }
+
+    static std::size_t from_lines(std::string_view src,
+                                  std::span<ipv4_address> dest,
+                                  std::string_view::iterator &last,
+                                  std::error_code &error) noexcept
+    {
+        std::string_view::iterator pos = src.begin();
+        std::string_view::iterator end = src.end();
+        std::size_t count = 0;
+
+        error.clear();
+
+        for (; count < dest.size() && pos != end; count++) {
+            std::string_view::iterator next = pos;
+            ipv4_address addr = from_string({ pos, end }, next, error);
+
+            if (!error && next != end && *next == '\r') {
+                next++;
+            }
+
+            if (!error && next != end && *next++ != '\n') {
+                error = std::make_error_code(std::errc::invalid_argument);
+            }
+
+            if (error) {
+                break;
+            }
+
+            dest[count] = addr;
+            pos = next;
+        }
+
+        last = pos;
+        return count;
+    }
+
+    constexpr bool operator==(const ipv4_address &other) const noexcept
+    {
+        return _data == other._data;
+    }
+
     constexpr auto operator<=>(const ipv4_address &other) const noexcept
     {
         return to_uint() <=> other.to_uint();
     }
 
   private:
-    bytes_type _data;
+    // Network order, so the bytes in memory read as written.
+    uint32_t _data;
+};
 
-    constexpr auto _to_chars_part(uint8_t value,
-                                  std::output_iterator<char> auto dest) const
-    {
-        char buf[3];
-        auto res = std::to_chars(buf, std::end(buf), value);
-        return std::copy(buf, res.ptr, dest);
+// Writes `src` to `dest` with `sep` between addresses and returns the end of
+// the text. `dest` must have room for `src.size() * ipv4_address::string_size`
+// characters.
+inline char *format_many(std::span<const ipv4_address> src, char *dest,
+                         char sep = '\n') noexcept
+{
+    for (std::size_t i = 0; i < src.size(); i++) {
+        if (i) {
+            *dest++ = sep;
+        }
+
+        dest = src[i].format(dest);
     }
+
+    return dest;
+}
+
+enum class ipv4_class {
+    loopback,
+    link_local,
+    private_network,
+    multicast,
+};
+
+namespace detail {
+
+struct ipv4_rule {
+    uint32_t value;
+    uint32_t mask;
+};
+
+// The networks tested by each classifier of ipv4_address, in host order.
+inline constexpr ipv4_rule ipv4_loopback_rules[]{
+    { 0x7F000000, 0xFF000000 }, // 127.0.0.0/8
+};
+
+inline constexpr ipv4_rule ipv4_link_local_rules[]{
+    { 0xA9FE0000, 0xFFFF0000 }, // 169.254.0.0/16
+};
+
+inline constexpr ipv4_rule ipv4_private_rules[]{
+    { 0x0A000000, 0xFF000000 }, // 10.0.0.0/8
+    { 0x64400000, 0xFFC00000 }, // 100.64.0.0/10
+    { 0xAC100000, 0xFFF00000 }, // 172.16.0.0/12
+    { 0xC0000000, 0xFFFFFF00 }, // 192.0.0.0/24
+    { 0xC0A80000, 0xFFFF0000 }, // 192.168.0.0/16
+    { 0xC6120000, 0xFFFE0000 }, // 198.18.0.0/15
 };
 
+inline constexpr ipv4_rule ipv4_multicast_rules[]{
+    { 0xE0000000, 0xF0000000 }, // 224.0.0.0/4
+};
+
+template <ipv4_class Class>
+inline constexpr std::span<const ipv4_rule> ipv4_class_rules = [] {
+    if constexpr (Class == ipv4_class::loopback) {
+        return std::span{ ipv4_loopback_rules };
+    } else if constexpr (Class == ipv4_class::link_local) {
+        return std::span{ ipv4_link_local_rules };
+    } else if constexpr (Class == ipv4_class::private_network) {
+        return std::span{ ipv4_private_rules };
+    } else {
+        return std::span{ ipv4_multicast_rules };
+    }
+}();
+
+// Calls `fn` with `cls` as a template argument, so that the kernels are
+// compiled with their rules unrolled.
+template <class Fn>
+inline decltype(auto) ipv4_class_dispatch(ipv4_class cls, Fn fn)
+{
+    switch (cls) {
+    case ipv4_class::loopback:
+        return fn.template operator()<ipv4_class::loopback>();
+    case ipv4_class::link_local:
+        return fn.template operator()<ipv4_class::link_local>();
+    case ipv4_class::private_network:
+        return fn.template operator()<ipv4_class::private_network>();
+    default:
+        return fn.template operator()<ipv4_class::multicast>();
+    }
+}
+
+// Returns a mask of which of the `size` (at most 64) addresses of `src` are
+// in `Class`. The rules are applied in network order, so the addresses are
+// compared as loaded, eight at a time with AVX2.
+template <ipv4_class Class>
+inline uint64_t ipv4_classify_block(const ipv4_address *src,
+                                    std::size_t size) noexcept
+{
+    static_assert(sizeof(ipv4_address) == sizeof(uint32_t));
+
+    constexpr auto rules = ipv4_class_rules<Class>;
+    uint64_t bits = 0;
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; size - i >= 8; i += 8) {
+        __m256i addrs =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i hits = _mm256_setzero_si256();
+
+        for (const auto &rule : rules) {
+            hits = _mm256_or_si256(
+                hits,
+                _mm256_cmpeq_epi32(
+                    _mm256_and_si256(addrs,
+                                     _mm256_set1_epi32(big_endian(rule.mask))),
+                    _mm256_set1_epi32(big_endian(rule.value))));
+        }
+
+        bits |= static_cast<uint64_t>(
+                    _mm256_movemask_ps(_mm256_castsi256_ps(hits)))
+                << i;
+    }
+#elif defined(__SSE2__)
+    for (; size - i >= 4; i += 4) {
+        __m128i addrs =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i hits = _mm_setzero_si128();
+
+        for (const auto &rule : rules) {
+            hits = _mm_or_si128(
+                hits, _mm_cmpeq_epi32(
+                          _mm_and_si128(addrs,
+                                        _mm_set1_epi32(big_endian(rule.mask))),
+                          _mm_set1_epi32(big_endian(rule.value))));
+        }
+
+        bits |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hits)))
+                << i;
+    }
+#endif
+
+    for (; i < size; i++) {
+        uint32_t value = src[i].to_network_order();
+        bool hit = false;
+
+        for (const auto &rule : rules) {
+            hit |= (value & big_endian(rule.mask)) == big_endian(rule.value);
+        }
+
+        bits |= static_cast<uint64_t>(hit) << i;
+    }
+
+    return bits;
+}
+
+#if defined(__AVX2__)
+
+// Indices of the set bits of each byte, packed into the bytes of a word.
+inline constexpr auto ipv4_compress_indices = [] {
+    std::array<uint64_t, 256> table{};
+
+    for (int mask = 0; mask < 256; mask++) {
+        for (int i = 0, n = 0; i < 8; i++) {
+            if (mask >> i & 1) {
+                table[mask] |= static_cast<uint64_t>(i) << 8 * n++;
+            }
+        }
+    }
+
+    return table;
+}();
+
+#endif
+
+// Appends `base` plus the position of each set bit of `bits` to `dest`.
+// Up to 64 elements past the end may be written when `spill` allows it.
+inline uint32_t *ipv4_emit_indices(uint64_t bits, uint32_t base,
+                                   uint32_t *dest, bool spill) noexcept
+{
+#if defined(__AVX2__)
+    if (spill) {
+        for (int i = 0; i < 64; i += 8) {
+            unsigned byte = bits >> i & 0xFF;
+            __m256i indices = _mm256_add_epi32(
+                _mm256_cvtepu8_epi32(
+                    _mm_cvtsi64_si128(ipv4_compress_indices[byte])),
+                _mm256_set1_epi32(base + i));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest), indices);
+            dest += std::popcount(byte);
+        }
+
+        return dest;
+    }
+#else
+    static_cast<void>(spill);
+#endif
+
+    for (; bits; bits &= bits - 1) {
+        *dest++ = base + std::countr_zero(bits);
+    }
+
+    return dest;
+}
+
+} // namespace detail
+
+// Sets bit `i % 64` of `dest[i / 64]` to whether `src[i]` is in `cls`.
+// `dest` must hold a word for every 64 addresses.
+inline void classify_many(ipv4_class cls, std::span<const ipv4_address> src,
+                          std::span<uint64_t> dest) noexcept
+{
+    detail::ipv4_class_dispatch(cls, [&]<ipv4_class Class>() {
+        for (std::size_t i = 0; i < src.size(); i += 64) {
+            dest[i / 64] = detail::ipv4_classify_block<Class>(
+                src.data() + i, std::min<std::size_t>(64, src.size() - i));
+        }
+    });
+}
+
+// Writes the indices of the addresses of `src` in `cls` to the front of
+// `dest` and the rest after them, both in ascending order, and returns the
+// number in `cls`. `dest` must be at least as long as `src`.
+inline std::size_t partition_many(ipv4_class cls,
+                                  std::span<const ipv4_address> src,
+                                  std::span<uint32_t> dest) noexcept
+{
+    return detail::ipv4_class_dispatch(cls, [&]<ipv4_class Class>() {
+        std::size_t size = src.size();
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < size; i += 64) {
+            count += std::popcount(detail::ipv4_classify_block<Class>(
+                src.data() + i, std::min<std::size_t>(64, size - i)));
+        }
+
+        uint32_t *hit = dest.data();
+        uint32_t *miss = dest.data() + count;
+        uint32_t *hit_end = miss;
+        uint32_t *miss_end = dest.data() + size;
+
+        for (std::size_t i = 0; i < size; i += 64) {
+            std::size_t block = std::min<std::size_t>(64, size - i);
+            uint64_t bits =
+                detail::ipv4_classify_block<Class>(src.data() + i, block);
+            uint64_t all = block == 64 ? ~uint64_t{ 0 } :
+                                         (uint64_t{ 1 } << block) - 1;
+
+            // Full-width stores may run past a region only while there is
+            // room for them not to reach the next one.
+            hit = detail::ipv4_emit_indices(bits, i, hit, hit_end - hit >= 64);
+            miss = detail::ipv4_emit_indices(~bits & all, i, miss,
+                                             miss_end - miss >= 64);
+        }
+
+        return count;
+    });
+}
+
 template <class T, class CharT>
 std::basic_ostream<T, CharT> &
 operator<<(std::basic_ostream<T, CharT> &os, const ipv4_address &addr)
 {
-    addr.to_chars(std::ostream_iterator<char>{ os });
-    return os;
+    char buf[ipv4_address::string_size];
+    return os.write(buf, addr.format(buf) - buf);
 }
 
 } // namespace nothing
@@ -235,7 +763,12 @@ struct hash<nothing::ipv4_address> {
     constexpr std::size_t
     operator()(const nothing::ipv4_address &addr) const noexcept
     {
-        return addr.to_uint();
+        // Multiply and fold the high half down so that addresses differing
+        // only in their upper octets still spread over the low bits used by
+        // power-of-two bucket counts.
+        uint64_t value =
+            addr.to_network_order() * uint64_t{ 0x9E3779B97F4A7C15 };
+        return static_cast<std::size_t>(value ^ value >> 32);
     }
 };
 
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_ENDPOINT_H_
+#define NOTHING_IPV4_ENDPOINT_H_
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <nothing/bit.h>
+#include <nothing/ipv4_address.h>
+
+#if __has_include(<netinet/in.h>)
+#include <netinet/in.h>
+#endif
+
+namespace nothing {
+
+class ipv4_endpoint {
+  public:
+    static constexpr size_t string_size = 22;
+
+    constexpr ipv4_endpoint() noexcept : _address{}, _port{} {}
+
+    constexpr ipv4_endpoint(const ipv4_address &address,
+                            uint16_t port) noexcept
+        : _address{ address }, _port{ port }
+    {
+    }
+
+#if __has_include(<netinet/in.h>)
+    // Both `sockaddr_in` and `ipv4_address` keep the address in network
+    // order, so it is copied as is; only the port is swapped. The family is
+    // not checked.
+    static constexpr ipv4_endpoint
+    from_sockaddr(const sockaddr_in &addr) noexcept
+    {
+        return ipv4_endpoint{
+            ipv4_address::from_network_order(addr.sin_addr.s_addr),
+            big_endian<uint16_t>(addr.sin_port)
+        };
+    }
+
+    constexpr sockaddr_in to_sockaddr() const noexcept
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = big_endian(_port);
+        addr.sin_addr.s_addr = _address.to_network_order();
+        return addr;
+    }
+#endif
+
+    constexpr ipv4_address address() const noexcept { return _address; }
+    constexpr uint16_t port() const noexcept { return _port; }
+
+    template <class Allocator = std::allocator<char>>
+    constexpr auto to_string(const Allocator &alloc = Allocator()) const
+    {
+        using string_type =
+            std::basic_string<char, std::char_traits<char>, Allocator>;
+
+        char buf[string_size];
+        char *end = format(buf);
+
+        return string_type(buf, end, alloc);
+    }
+
+    template <std::output_iterator<char> Out>
+    constexpr Out to_chars(Out dest) const
+    {
+        char buf[5];
+        char *digits = _format_port(buf + 5);
+
+        dest = _address.to_chars(dest);
+        *dest = ':';
+        ++dest;
+
+        return std::copy(digits, buf + 5, dest);
+    }
+
+    // Writes "a.b.c.d:port" to `dest` and returns the end of the text. `dest`
+    // must have room for `string_size` characters.
+    constexpr char *format(char *dest) const noexcept
+    {
+        char buf[5];
+        char *digits = _format_port(buf + 5);
+
+        dest = _address.format(dest);
+        *dest++ = ':';
+
+        return std::copy(digits, buf + 5, dest);
+    }
+
+    static ipv4_endpoint from_string(std::string_view src)
+    {
+        std::error_code error;
+        ipv4_endpoint endpoint = from_string(src, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return endpoint;
+    }
+
+    static ipv4_endpoint from_string(std::string_view src,
+                                     std::string_view::iterator &last)
+    {
+        std::error_code error;
+        ipv4_endpoint endpoint = from_string(src, last, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return endpoint;
+    }
+
+    static ipv4_endpoint from_string(std::string_view src,
+                                     std::error_code &error) noexcept
+    {
+        std::string_view::iterator last = src.begin();
+        ipv4_endpoint endpoint = from_string(src, last, error);
+
+        if (last != src.end()) {
+            error = std::make_error_code(std::errc::invalid_argument);
+        }
+
+        return endpoint;
+    }
+
+    // Parses "a.b.c.d:port", where the port has no leading zeros.
+    static ipv4_endpoint from_string(std::string_view src,
+                                     std::string_view::iterator &last,
+                                     std::error_code &error) noexcept
+    {
+        std::string_view::iterator pos = src.begin();
+        std::string_view::iterator end = src.end();
+        ipv4_address addr = ipv4_address::from_string(src, pos, error);
+
+        if (error) {
+            return {};
+        }
+
+        if (pos == end || *pos++ != ':' || pos == end ||
+            !ascii_isdigit(*pos)) {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return {};
+        }
+
+        uint32_t port = *pos++ - '0';
+
+        if (port) {
+            for (int i = 0; i < 4 && pos < end && ascii_isdigit(*pos); i++) {
+                uint32_t next = 10 * port + *pos - '0';
+
+                if (next > 0xFFFF) {
+                    break;
+                }
+
+                port = next;
+                pos++;
+            }
+        }
+
+        last = pos;
+        error.clear();
+
+        return ipv4_endpoint{ addr, static_cast<uint16_t>(port) };
+    }
+
+    constexpr bool operator==(const ipv4_endpoint &other) const noexcept
+    {
+        return _address == other._address && _port == other._port;
+    }
+
+    constexpr auto operator<=>(const ipv4_endpoint &other) const noexcept
+    {
+        if (auto cmp = _address <=> other._address; cmp != 0) {
+            return cmp;
+        }
+
+        return _port <=> other._port;
+    }
+
+  private:
+    ipv4_address _address;
+    uint16_t _port;
+
+    // Writes the port backwards ending at `end`, and returns its start.
+    constexpr char *_format_port(char *end) const noexcept
+    {
+        unsigned value = _port;
+
+        do {
+            *--end = '0' + value % 10;
+            value /= 10;
+        } while (value);
+
+        return end;
+    }
+};
+
+template <class T, class CharT>
+std::basic_ostream<T, CharT> &
+operator<<(std::basic_ostream<T, CharT> &os, const ipv4_endpoint &endpoint)
+{
+    char buf[ipv4_endpoint::string_size];
+    return os.write(buf, endpoint.format(buf) - buf);
+}
+
+} // namespace nothing
+
+namespace std {
+
+template <>
+struct hash<nothing::ipv4_endpoint> {
+    constexpr std::size_t
+    operator()(const nothing::ipv4_endpoint &endpoint) const noexcept
+    {
+        // Pack both fields into one word before mixing, so that endpoints
+        // sharing an address still differ in the low bits.
+        uint64_t value =
+            (uint64_t{ endpoint.address().to_network_order() } << 16 |
+             endpoint.port()) *
+            uint64_t{ 0x9E3779B97F4A7C15 };
+        return static_cast<std::size_t>(value ^ value >> 32);
+    }
+};
+
+} // namespace std
+
+#endif
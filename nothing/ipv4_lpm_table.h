@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_LPM_TABLE_H_
+#define NOTHING_IPV4_LPM_TABLE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <nothing/ipv4_address.h>
+#include <nothing/ipv4_network.h>
+#include <nothing/prefetch.h>
+
+namespace nothing {
+
+/*
+ * Longest-prefix-match table from IPv4 networks to values, laid out as
+ * DIR-24-8: a flat table indexed by the top 24 bits of the address, whose
+ * entries either hold the match directly or point to a 256-entry group for
+ * the last 8 bits. A lookup is one or two memory accesses; each entry also
+ * records the prefix length it came from so that overlapping routes can be
+ * inserted and erased in any order.
+ */
+template <class T>
+class ipv4_lpm_table {
+  public:
+    using key_type = ipv4_network;
+    using mapped_type = T;
+
+    ipv4_lpm_table() : _tbl24(std::size_t{ 1 } << 24) {}
+
+    std::size_t size() const noexcept { return _routes.size(); }
+    bool empty() const noexcept { return _routes.empty(); }
+
+    void clear()
+    {
+        std::fill(_tbl24.begin(), _tbl24.end(), 0);
+        _tbl8.clear();
+        _free_groups.clear();
+        _values.clear();
+        _free_values.clear();
+        _routes.clear();
+    }
+
+    // Adds a route for `network`, ignoring its host bits, or replaces the
+    // value of an existing one. Returns whether a route was added.
+    bool insert_or_assign(const ipv4_network &network, const T &value)
+    {
+        ipv4_network key = network.canonical();
+        auto it = _routes.find(key);
+
+        if (it != _routes.end()) {
+            *_values[it->second - 1] = value;
+            return false;
+        }
+
+        uint32_t index = _allocate_value(value);
+        unsigned depth = key.prefix_length();
+
+        _routes.emplace(key, index);
+        _update(key, _entry(depth, index),
+                [depth](uint32_t entry) { return _depth(entry) <= depth; });
+
+        return true;
+    }
+
+    // Removes the route for `network`. Addresses it covered fall back to the
+    // longest shorter route containing it.
+    bool erase(const ipv4_network &network)
+    {
+        ipv4_network key = network.canonical();
+        auto it = _routes.find(key);
+
+        if (it == _routes.end()) {
+            return false;
+        }
+
+        uint32_t index = it->second;
+        int depth = key.prefix_length();
+        uint32_t replacement = 0;
+
+        _routes.erase(it);
+
+        for (int i = depth - 1; i >= 0; i--) {
+            auto parent =
+                _routes.find(ipv4_network{ key.address(), i }.canonical());
+
+            if (parent != _routes.end()) {
+                replacement = _entry(i, parent->second);
+                break;
+            }
+        }
+
+        uint32_t old = _entry(depth, index);
+
+        _update(key, replacement,
+                [old](uint32_t entry) { return entry == old; });
+        _values[index - 1].reset();
+        _free_values.push_back(index);
+
+        return true;
+    }
+
+    // Value of the route for exactly `network`, ignoring its host bits.
+    const T *find(const ipv4_network &network) const noexcept
+    {
+        auto it = _routes.find(network.canonical());
+        return it != _routes.end() ? &*_values[it->second - 1] : nullptr;
+    }
+
+    // Value of the longest route containing `addr`.
+    const T *lookup(const ipv4_address &addr) const noexcept
+    {
+        uint32_t index = _lookup(addr.to_uint());
+        return index ? &*_values[index - 1] : nullptr;
+    }
+
+    // Looks up each address of `src` into the matching element of `dest`.
+    // Table entries are prefetched a few addresses ahead, first in the 24-bit
+    // table and then in any group they point to, so that the cache misses of
+    // neighbouring lookups overlap.
+    void lookup(std::span<const ipv4_address> src,
+                std::span<const T *> dest) const noexcept
+    {
+        constexpr std::size_t distance = 16;
+        std::size_t size = std::min(src.size(), dest.size());
+
+        for (std::size_t i = 0; i < size; i++) {
+            if (i + distance < size) {
+                prefetch(&_tbl24[src[i + distance].to_uint() >> 8]);
+            }
+
+            if (i + distance / 2 < size) {
+                uint32_t key = src[i + distance / 2].to_uint();
+                uint32_t entry = _tbl24[key >> 8];
+
+                if (entry & _extended) {
+                    prefetch(&_tbl8[(entry & _index_mask) << 8 | (key & 0xFF)]);
+                }
+            }
+
+            dest[i] = lookup(src[i]);
+        }
+    }
+
+  private:
+    // Entries hold a group number when extended, otherwise a value index
+    // (zero for no route), along with the prefix length that set them.
+    static constexpr uint32_t _extended = uint32_t{ 1 } << 31;
+    static constexpr int _depth_shift = 25;
+    static constexpr uint32_t _index_mask = (uint32_t{ 1 } << 25) - 1;
+
+    std::vector<uint32_t> _tbl24;
+    std::vector<uint32_t> _tbl8;
+    std::vector<uint32_t> _free_groups;
+    std::vector<std::optional<T>> _values;
+    std::vector<uint32_t> _free_values;
+    std::unordered_map<ipv4_network, uint32_t> _routes;
+
+    static constexpr uint32_t _entry(unsigned depth, uint32_t index) noexcept
+    {
+        return depth << _depth_shift | index;
+    }
+
+    static constexpr unsigned _depth(uint32_t entry) noexcept
+    {
+        return entry >> _depth_shift & 63;
+    }
+
+    uint32_t _lookup(uint32_t key) const noexcept
+    {
+        uint32_t entry = _tbl24[key >> 8];
+
+        if (entry & _extended) [[unlikely]] {
+            entry = _tbl8[(entry & _index_mask) << 8 | (key & 0xFF)];
+        }
+
+        return entry & _index_mask;
+    }
+
+    uint32_t _allocate_value(const T &value)
+    {
+        if (_free_values.empty()) {
+            _values.emplace_back(value);
+            return _values.size();
+        }
+
+        uint32_t index = _free_values.back();
+        _values[index - 1].emplace(value);
+        _free_values.pop_back();
+
+        return index;
+    }
+
+    // Expands a 24-bit entry into a group of 256 copies of it.
+    uint32_t _allocate_group(uint32_t entry)
+    {
+        uint32_t group;
+
+        if (_free_groups.empty()) {
+            group = _tbl8.size() >> 8;
+            _tbl8.resize(_tbl8.size() + 256);
+        } else {
+            group = _free_groups.back();
+            _free_groups.pop_back();
+        }
+
+        std::fill_n(_tbl8.begin() + (group << 8), 256, entry);
+        return group;
+    }
+
+    // Sets every entry covered by `key` that satisfies `pred` to `entry`.
+    template <class Pred>
+    void _update(const ipv4_network &key, uint32_t entry, Pred pred)
+    {
+        uint32_t first = key.address().to_uint();
+        unsigned depth = key.prefix_length();
+
+        if (depth <= 24) {
+            std::size_t begin = first >> 8;
+            std::size_t end = begin + (std::size_t{ 1 } << (24 - depth));
+
+            for (std::size_t i = begin; i < end; i++) {
+                uint32_t &slot = _tbl24[i];
+
+                if (slot & _extended) {
+                    auto group = _tbl8.begin() + ((slot & _index_mask) << 8);
+                    std::replace_if(group, group + 256, pred, entry);
+                } else if (pred(slot)) {
+                    slot = entry;
+                }
+            }
+
+            return;
+        }
+
+        uint32_t &slot = _tbl24[first >> 8];
+
+        if (!(slot & _extended)) {
+            slot = _extended | _allocate_group(slot);
+        }
+
+        uint32_t group = slot & _index_mask;
+        auto begin = _tbl8.begin() + (group << 8);
+        auto pos = begin + (first & 0xFF);
+
+        std::replace_if(pos, pos + (1 << (32 - depth)), pred, entry);
+
+        // Fold the group back once only one 24-bit-or-shorter route is left.
+        if (_depth(*begin) <= 24 &&
+            std::all_of(begin, begin + 256,
+                        [=](uint32_t value) { return value == *begin; })) {
+            slot = *begin;
+            _free_groups.push_back(group);
+        }
+    }
+};
+
+} // namespace nothing
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_NETWORK_H_
+#define NOTHING_IPV4_NETWORK_H_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <nothing/ipv4_address.h>
+
+namespace nothing {
+
+class ipv4_network {
+  public:
+    static constexpr size_t string_size = 19;
+
+    constexpr ipv4_network() noexcept : _address{}, _prefix_length{} {}
+
+    constexpr ipv4_network(const ipv4_address &address, int prefix_length)
+        : _address{ address }, _prefix_length{ 0 }
+    {
+        if (prefix_length < 0 || prefix_length > 32) {
+            throw std::out_of_range(
+                "nothing::ipv4_network: Prefix length out of range");
+        }
+
+        _prefix_length = prefix_length;
+    }
+
+    constexpr ipv4_address address() const noexcept { return _address; }
+    constexpr int prefix_length() const noexcept { return _prefix_length; }
+
+    constexpr ipv4_address netmask() const noexcept
+    {
+        return ipv4_address{ _mask() };
+    }
+
+    constexpr ipv4_address hostmask() const noexcept
+    {
+        return ipv4_address{ ~_mask() };
+    }
+
+    // First address of the network.
+    constexpr ipv4_address network() const noexcept
+    {
+        return ipv4_address{ _value() & _mask() };
+    }
+
+    // Last address of the network.
+    constexpr ipv4_address broadcast() const noexcept
+    {
+        return ipv4_address{ _value() | ~_mask() };
+    }
+
+    // The same network with its host bits cleared.
+    constexpr ipv4_network canonical() const noexcept
+    {
+        return ipv4_network{ network(), _prefix_length };
+    }
+
+    constexpr bool is_host() const noexcept { return _prefix_length == 32; }
+
+    constexpr bool contains(const ipv4_address &addr) const noexcept
+    {
+        return ((addr.to_uint() ^ _value()) & _mask()) == 0;
+    }
+
+    constexpr bool contains(const ipv4_network &other) const noexcept
+    {
+        return other._prefix_length >= _prefix_length &&
+               contains(other._address);
+    }
+
+    template <class Allocator = std::allocator<char>>
+    constexpr auto to_string(const Allocator &alloc = Allocator()) const
+    {
+        using string_type =
+            std::basic_string<char, std::char_traits<char>, Allocator>;
+
+        char buf[string_size];
+        char *end = to_chars(buf);
+
+        return string_type(buf, end, alloc);
+    }
+
+    template <std::output_iterator<char> Out>
+    constexpr Out to_chars(Out dest) const
+    {
+        dest = _address.to_chars(dest);
+        *dest = '/';
+        ++dest;
+
+        if (_prefix_length >= 10) {
+            *dest = '0' + _prefix_length / 10;
+            ++dest;
+        }
+
+        *dest = '0' + _prefix_length % 10;
+        ++dest;
+
+        return dest;
+    }
+
+    static ipv4_network from_string(std::string_view src)
+    {
+        std::error_code error;
+        ipv4_network net = from_string(src, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return net;
+    }
+
+    static ipv4_network from_string(std::string_view src,
+                                    std::string_view::iterator &last)
+    {
+        std::error_code error;
+        ipv4_network net = from_string(src, last, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return net;
+    }
+
+    static ipv4_network from_string(std::string_view src,
+                                    std::error_code &error) noexcept
+    {
+        std::string_view::iterator last = src.begin();
+        ipv4_network net = from_string(src, last, error);
+
+        if (last != src.end()) {
+            error = std::make_error_code(std::errc::invalid_argument);
+        }
+
+        return net;
+    }
+
+    // Parses "a.b.c.d/n", where the prefix length has no leading zeros.
+    static ipv4_network from_string(std::string_view src,
+                                    std::string_view::iterator &last,
+                                    std::error_code &error) noexcept
+    {
+        std::string_view::iterator pos = src.begin();
+        std::string_view::iterator end = src.end();
+        ipv4_address addr = ipv4_address::from_string(src, pos, error);
+
+        if (error) {
+            return {};
+        }
+
+        if (pos == end || *pos++ != '/' || pos == end ||
+            !ascii_isdigit(*pos)) {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return {};
+        }
+
+        int prefix_length = *pos++ - '0';
+
+        if (pos < end && ascii_isdigit(*pos) && prefix_length) {
+            int next = 10 * prefix_length + *pos - '0';
+
+            if (next <= 32) {
+                prefix_length = next;
+                pos++;
+            }
+        }
+
+        last = pos;
+        error.clear();
+
+        return ipv4_network{ addr, prefix_length };
+    }
+
+    constexpr bool operator==(const ipv4_network &other) const noexcept
+    {
+        return _address == other._address &&
+               _prefix_length == other._prefix_length;
+    }
+
+    constexpr auto operator<=>(const ipv4_network &other) const noexcept
+    {
+        if (auto cmp = _address <=> other._address; cmp != 0) {
+            return cmp;
+        }
+
+        return _prefix_length <=> other._prefix_length;
+    }
+
+  private:
+    ipv4_address _address;
+    int _prefix_length;
+
+    constexpr uint32_t _value() const noexcept { return _address.to_uint(); }
+
+    constexpr uint32_t _mask() const noexcept
+    {
+        return _prefix_length ? ~uint32_t{ 0 } << (32 - _prefix_length) : 0;
+    }
+};
+
+template <class T, class CharT>
+std::basic_ostream<T, CharT> &
+operator<<(std::basic_ostream<T, CharT> &os, const ipv4_network &net)
+{
+    net.to_chars(std::ostream_iterator<char>{ os });
+    return os;
+}
+
+} // namespace nothing
+
+namespace std {
+
+template <>
+struct hash<nothing::ipv4_network> {
+    constexpr std::size_t
+    operator()(const nothing::ipv4_network &net) const noexcept
+    {
+        return std::hash<nothing::ipv4_address>{}(net.address()) << 6 ^
+               net.prefix_length();
+    }
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_RANGE_DB_H_
+#define NOTHING_IPV4_RANGE_DB_H_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <nothing/exception.h>
+#include <nothing/ipv4_address.h>
+#include <nothing/ipv4_network.h>
+#include <nothing/prefetch.h>
+#include <nothing/unaligned.h>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nothing {
+
+/*
+ * On-disk format of an IPv4 range database, all fields little-endian:
+ *
+ *   0    magic "NIPV4RDB"
+ *   8    u32 version
+ *   12   u32 number of ranges, n
+ *   16   reserved up to 64 bytes, zero
+ *   64   u32 last[n + 1]
+ *        u32 first[n + 1]
+ *        u32 value[n + 1]
+ *
+ * The ranges are disjoint and stored in Eytzinger order: node k has children
+ * 2k and 2k + 1, and slot 0 is unused. With the header padded to a cache
+ * line, the sixteen descendants four levels below a node share one line.
+ */
+namespace detail {
+
+inline constexpr char ipv4_range_db_magic[8] = { 'N', 'I', 'P', 'V',
+                                                 '4', 'R', 'D', 'B' };
+
+inline constexpr uint32_t ipv4_range_db_version = 1;
+inline constexpr std::size_t ipv4_range_db_header_size = 64;
+
+} // namespace detail
+
+// Collects ranges of addresses with values and writes them out as a database
+// for `ipv4_range_db`.
+class ipv4_range_db_builder {
+  public:
+    std::size_t size() const noexcept { return _ranges.size(); }
+    bool empty() const noexcept { return _ranges.empty(); }
+
+    void clear() noexcept { _ranges.clear(); }
+
+    // Adds the inclusive range `[first, last]`.
+    void insert(const ipv4_address &first, const ipv4_address &last,
+                uint32_t value)
+    {
+        if (last < first) {
+            throw std::invalid_argument(
+                "nothing::ipv4_range_db_builder: Range is reversed");
+        }
+
+        _ranges.push_back({ first.to_uint(), last.to_uint(), value });
+    }
+
+    void insert(const ipv4_network &network, uint32_t value)
+    {
+        insert(network.network(), network.broadcast(), value);
+    }
+
+    // Sorts the ranges, merges overlapping and adjacent ones with the same
+    // value, and returns the database. Ranges that overlap with different
+    // values are an error.
+    std::vector<uint8_t> build() const
+    {
+        std::vector<_range> ranges = _coalesce();
+        std::size_t n = ranges.size();
+        std::size_t stride = 4 * (n + 1);
+        std::vector<uint8_t> data(detail::ipv4_range_db_header_size +
+                                  3 * stride);
+
+        std::memcpy(data.data(), detail::ipv4_range_db_magic, 8);
+        unaligned_store_le32(detail::ipv4_range_db_version, data.data() + 8);
+        unaligned_store_le32(n, data.data() + 12);
+
+        uint8_t *last = data.data() + detail::ipv4_range_db_header_size;
+        uint8_t *first = last + stride;
+        uint8_t *value = first + stride;
+        std::size_t i = 0;
+
+        auto store = [&](std::size_t k, const _range &range) {
+            unaligned_store_le32(range.last, last + 4 * k);
+            unaligned_store_le32(range.first, first + 4 * k);
+            unaligned_store_le32(range.value, value + 4 * k);
+        };
+
+        _layout(ranges, i, 1, store);
+
+        return data;
+    }
+
+    void write(const std::filesystem::path &path) const
+    {
+        std::vector<uint8_t> data = build();
+        std::ofstream file;
+
+        file.exceptions(std::ios::failbit | std::ios::badbit);
+        file.open(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+  private:
+    struct _range {
+        uint32_t first;
+        uint32_t last;
+        uint32_t value;
+    };
+
+    std::vector<_range> _ranges;
+
+    std::vector<_range> _coalesce() const
+    {
+        std::vector<_range> ranges = _ranges;
+        std::vector<_range> result;
+
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const _range &a, const _range &b) {
+                      return a.first < b.first;
+                  });
+
+        for (const _range &range : ranges) {
+            if (result.empty()) {
+                result.push_back(range);
+                continue;
+            }
+
+            _range &back = result.back();
+
+            if (range.first <= back.last) {
+                if (range.value != back.value) {
+                    throw std::invalid_argument(
+                        "nothing::ipv4_range_db_builder: Overlapping ranges "
+                        "have different values");
+                }
+
+                back.last = std::max(back.last, range.last);
+            } else if (range.first - 1 == back.last &&
+                       range.value == back.value) {
+                back.last = range.last;
+            } else {
+                result.push_back(range);
+            }
+        }
+
+        return result;
+    }
+
+    // Visits the sorted `ranges` in the in-order traversal of the implicit
+    // tree rooted at `k`, which assigns each its Eytzinger slot.
+    template <class Fn>
+    static void _layout(const std::vector<_range> &ranges, std::size_t &i,
+                        std::size_t k, Fn &fn)
+    {
+        if (k > ranges.size()) {
+            return;
+        }
+
+        _layout(ranges, i, 2 * k, fn);
+        fn(k, ranges[i++]);
+        _layout(ranges, i, 2 * k + 1, fn);
+    }
+};
+
+/*
+ * Read-only view of a database written by `ipv4_range_db_builder`, either
+ * mapped from a file or over bytes owned elsewhere. Opening checks only the
+ * header and size; lookups then read the fields in place, so startup costs
+ * nothing beyond the mapping and pages are faulted in as searches reach them.
+ */
+class ipv4_range_db {
+  public:
+    ipv4_range_db() noexcept = default;
+
+    // Views `data`, which must outlive the database.
+    explicit ipv4_range_db(std::span<const uint8_t> data)
+    {
+        _open(data);
+    }
+
+#if __has_include(<sys/mman.h>)
+    explicit ipv4_range_db(const std::filesystem::path &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            check_errno();
+        }
+
+        struct stat st;
+
+        if (::fstat(fd, &st) < 0) {
+            int error = errno;
+            ::close(fd);
+            check_errno(error);
+        }
+
+        std::size_t size = st.st_size;
+        void *map = size ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                         : MAP_FAILED;
+        int error = errno;
+
+        ::close(fd);
+
+        if (!size) {
+            _invalid();
+        }
+
+        if (map == MAP_FAILED) {
+            check_errno(error);
+        }
+
+        _map = map;
+        _map_size = size;
+
+        try {
+            _open({ static_cast<const uint8_t *>(map), size });
+        } catch (...) {
+            _unmap();
+            throw;
+        }
+    }
+#endif
+
+    ipv4_range_db(ipv4_range_db &&other) noexcept
+        : _last{ std::exchange(other._last, nullptr) },
+          _first{ std::exchange(other._first, nullptr) },
+          _value{ std::exchange(other._value, nullptr) },
+          _size{ std::exchange(other._size, 0) },
+          _version{ std::exchange(other._version, 0) },
+          _map{ std::exchange(other._map, nullptr) },
+          _map_size{ std::exchange(other._map_size, 0) }
+    {
+    }
+
+    ipv4_range_db &operator=(ipv4_range_db &&other) noexcept
+    {
+        if (this != &other) {
+            _unmap();
+            _last = std::exchange(other._last, nullptr);
+            _first = std::exchange(other._first, nullptr);
+            _value = std::exchange(other._value, nullptr);
+            _size = std::exchange(other._size, 0);
+            _version = std::exchange(other._version, 0);
+            _map = std::exchange(other._map, nullptr);
+            _map_size = std::exchange(other._map_size, 0);
+        }
+
+        return *this;
+    }
+
+    ~ipv4_range_db() { _unmap(); }
+
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return !_size; }
+    uint32_t version() const noexcept { return _version; }
+
+    // Value of the range containing `addr`.
+    std::optional<uint32_t> lookup(const ipv4_address &addr) const noexcept
+    {
+        uint32_t key = addr.to_uint();
+        std::size_t k = 1;
+
+        // Find the first range ending at or after `key`, prefetching the
+        // line holding the descendants four levels down.
+        while (k <= _size) {
+            if (16 * k <= _size) {
+                prefetch(_last + 64 * k);
+            }
+
+            k = 2 * k + (unaligned_load_le32(_last + 4 * k) < key);
+        }
+
+        k >>= std::countr_one(k) + 1;
+
+        if (!k || unaligned_load_le32(_first + 4 * k) > key) {
+            return std::nullopt;
+        }
+
+        return unaligned_load_le32(_value + 4 * k);
+    }
+
+    bool contains(const ipv4_address &addr) const noexcept
+    {
+        return lookup(addr).has_value();
+    }
+
+  private:
+    const uint8_t *_last = nullptr;
+    const uint8_t *_first = nullptr;
+    const uint8_t *_value = nullptr;
+    std::size_t _size = 0;
+    uint32_t _version = 0;
+    void *_map = nullptr;
+    std::size_t _map_size = 0;
+
+    [[noreturn]] static void _invalid()
+    {
+        throw std::runtime_error("nothing::ipv4_range_db: Invalid database");
+    }
+
+    void _open(std::span<const uint8_t> data)
+    {
+        if (data.size() < detail::ipv4_range_db_header_size ||
+            std::memcmp(data.data(), detail::ipv4_range_db_magic, 8)) {
+            _invalid();
+        }
+
+        uint32_t version = unaligned_load_le32(data.data() + 8);
+        std::size_t size = unaligned_load_le32(data.data() + 12);
+        std::size_t stride = 4 * (size + 1);
+
+        if (version != detail::ipv4_range_db_version ||
+            data.size() != detail::ipv4_range_db_header_size + 3 * stride ||
+            std::any_of(data.begin() + 16,
+                        data.begin() + detail::ipv4_range_db_header_size,
+                        [](uint8_t byte) { return byte; })) {
+            _invalid();
+        }
+
+        _last = data.data() + detail::ipv4_range_db_header_size;
+        _first = _last + stride;
+        _value = _first + stride;
+        _size = size;
+        _version = version;
+    }
+
+    void _unmap() noexcept
+    {
+#if __has_include(<sys/mman.h>)
+        if (_map) {
+            ::munmap(_map, _map_size);
+        }
+#endif
+    }
+};
+
+} // namespace nothing
+
+#endif
@@ -0,0 +1,1118 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_SET_H_
+#define NOTHING_IPV4_SET_H_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <nothing/ipv4_address.h>
+#include <nothing/prefetch.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace nothing {
+namespace detail {
+
+enum class ipv4_set_op { intersect, unite, subtract };
+
+// Writes the values of the sorted array `a` that are (or, when subtracting,
+// are not) in the sorted array `b` to `dest`, and returns their count. Blocks
+// of eight values are compared all-to-all with SSE2, against each rotation
+// of the other block, and the block with the smaller maximum is advanced.
+template <ipv4_set_op Op>
+inline std::size_t ipv4_set_match_arrays(const uint16_t *a, std::size_t na,
+                                         const uint16_t *b, std::size_t nb,
+                                         uint16_t *dest) noexcept
+{
+    static_assert(Op != ipv4_set_op::unite);
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    std::size_t count = 0;
+
+    // Matches found so far for the elements of the current block of `a`, two
+    // bits per element.
+    unsigned matched = 0;
+
+#if defined(__SSE2__)
+    if (na >= 8 && nb >= 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+
+        while (true) {
+            __m128i eq = _mm_cmpeq_epi16(va, vb);
+            __m128i rot = vb;
+
+            for (int r = 1; r < 8; r++) {
+                rot = _mm_or_si128(_mm_srli_si128(rot, 2),
+                                   _mm_slli_si128(rot, 14));
+                eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rot));
+            }
+
+            unsigned bits = _mm_movemask_epi8(eq) & 0x5555;
+            uint16_t amax = a[i + 7];
+            uint16_t bmax = b[j + 7];
+
+            if constexpr (Op == ipv4_set_op::intersect) {
+                for (; bits; bits &= bits - 1) {
+                    dest[count++] = a[i + std::countr_zero(bits) / 2];
+                }
+            } else {
+                matched |= bits;
+            }
+
+            if (amax <= bmax) {
+                if constexpr (Op == ipv4_set_op::subtract) {
+                    for (unsigned rest = ~matched & 0x5555; rest;
+                         rest &= rest - 1) {
+                        dest[count++] = a[i + std::countr_zero(rest) / 2];
+                    }
+
+                    matched = 0;
+                }
+
+                i += 8;
+
+                if (na - i < 8) {
+                    if (amax == bmax) {
+                        j += 8;
+                    }
+
+                    break;
+                }
+
+                va = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(a + i));
+            }
+
+            if (bmax <= amax) {
+                j += 8;
+
+                if (nb - j < 8) {
+                    break;
+                }
+
+                vb = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(b + j));
+            }
+        }
+    }
+#endif
+
+    for (std::size_t start = i; i < na; i++) {
+        // Elements of a block left behind by the vector loop that already
+        // matched an earlier block of `b`.
+        if (i - start < 8 && matched >> 2 * (i - start) & 1) {
+            continue;
+        }
+
+        while (j < nb && b[j] < a[i]) {
+            j++;
+        }
+
+        bool found = j < nb && b[j] == a[i];
+
+        if (found == (Op == ipv4_set_op::intersect)) {
+            dest[count++] = a[i];
+        }
+    }
+
+    return count;
+}
+
+// Merges the sorted arrays `a` and `b` into `dest`, and returns the count.
+// This stays scalar: only intersection and difference have vector kernels.
+inline std::size_t ipv4_set_unite_arrays(const uint16_t *a, std::size_t na,
+                                         const uint16_t *b, std::size_t nb,
+                                         uint16_t *dest) noexcept
+{
+    std::size_t i = 0;
+    std::size_t j = 0;
+    std::size_t count = 0;
+
+    while (i < na && j < nb) {
+        uint16_t x = a[i];
+        uint16_t y = b[j];
+
+        dest[count++] = std::min(x, y);
+        i += x <= y;
+        j += y <= x;
+    }
+
+    count = std::copy(a + i, a + na, dest + count) - dest;
+    count = std::copy(b + j, b + nb, dest + count) - dest;
+
+    return count;
+}
+
+// Combines two 1024-word bitmaps into `dest`, four words at a time with AVX2,
+// and returns the number of bits set in the result.
+template <ipv4_set_op Op>
+inline uint32_t ipv4_set_combine_bitmaps(const uint64_t *a, const uint64_t *b,
+                                         uint64_t *dest) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i < 1024; i += 4) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i z;
+
+        if constexpr (Op == ipv4_set_op::intersect) {
+            z = _mm256_and_si256(x, y);
+        } else if constexpr (Op == ipv4_set_op::unite) {
+            z = _mm256_or_si256(x, y);
+        } else {
+            z = _mm256_andnot_si256(y, x);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), z);
+    }
+#endif
+
+    for (; i < 1024; i++) {
+        if constexpr (Op == ipv4_set_op::intersect) {
+            dest[i] = a[i] & b[i];
+        } else if constexpr (Op == ipv4_set_op::unite) {
+            dest[i] = a[i] | b[i];
+        } else {
+            dest[i] = a[i] & ~b[i];
+        }
+    }
+
+    uint32_t count = 0;
+
+    for (i = 0; i < 1024; i++) {
+        count += std::popcount(dest[i]);
+    }
+
+    return count;
+}
+
+} // namespace detail
+
+/*
+ * Set of IPv4 addresses split by their upper 16 bits, in the manner of a
+ * roaring bitmap. Each /16 present has a container for its lower 16 bits:
+ * a sorted array while it holds at most 4096 addresses, otherwise a
+ * 65536-bit bitmap, or a list of runs when `optimize()` finds that smaller.
+ * Containers of dense blocks take 8 KiB and of sparse ones two bytes per
+ * address, and set operations work a container pair at a time.
+ *
+ * A non-empty set also keeps a 16 KiB index over all 65536 blocks: a bit per
+ * block saying whether it has a container, and for each 64 blocks the number
+ * of containers before them. A block's container is then found from a single
+ * index entry, so `contains` is one access and then the container probe.
+ */
+class ipv4_set {
+  private:
+    enum class _kind : uint8_t { array, bitmap, run };
+
+    // `values` holds the sorted array, or the first and last value of each
+    // run; `words` holds the bitmap.
+    struct _container {
+        _kind kind = _kind::array;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> words;
+    };
+
+    // Which of 64 blocks have containers, and how many containers come
+    // before the first of them.
+    struct _index_entry {
+        uint64_t present = 0;
+        uint32_t rank = 0;
+    };
+
+  public:
+    using value_type = ipv4_address;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    class const_iterator;
+    using iterator = const_iterator;
+
+    ipv4_set() noexcept = default;
+
+    ipv4_set(std::initializer_list<ipv4_address> values)
+    {
+        for (const ipv4_address &addr : values) {
+            insert(addr);
+        }
+    }
+
+    size_type size() const noexcept { return _size; }
+    bool empty() const noexcept { return !_size; }
+
+    void clear() noexcept
+    {
+        _keys.clear();
+        _containers.clear();
+        _index.clear();
+        _size = 0;
+    }
+
+    bool contains(const ipv4_address &addr) const noexcept
+    {
+        uint32_t value = addr.to_uint();
+        std::size_t index;
+
+        if (!_find(value >> 16, index)) {
+            return false;
+        }
+
+        return _contains(_containers[index], value & 0xFFFF);
+    }
+
+    // Returns whether `addr` was added.
+    bool insert(const ipv4_address &addr)
+    {
+        uint32_t value = addr.to_uint();
+        uint16_t key = value >> 16;
+        uint16_t low = value & 0xFFFF;
+        std::size_t index;
+
+        if (!_find(key, index)) {
+            _insert_container(key, index, { _kind::array, 1, { low }, {} });
+            _size++;
+            return true;
+        }
+
+        _container &c = _containers[index];
+
+        if (c.kind == _kind::run) {
+            if (_contains(c, low)) {
+                return false;
+            }
+
+            _expand(c);
+        }
+
+        if (c.kind == _kind::array) {
+            auto it = std::lower_bound(c.values.begin(), c.values.end(), low);
+
+            if (it != c.values.end() && *it == low) {
+                return false;
+            }
+
+            c.values.insert(it, low);
+        } else {
+            uint64_t &word = c.words[low / 64];
+            uint64_t bit = uint64_t{ 1 } << (low % 64);
+
+            if (word & bit) {
+                return false;
+            }
+
+            word |= bit;
+        }
+
+        c.cardinality++;
+        _size++;
+        _normalize(c);
+
+        return true;
+    }
+
+    // Adds every address from `first` through `last`. A container the range
+    // covers entirely, or that is new, becomes a single run; others are
+    // filled as bitmaps a word at a time.
+    void insert(const ipv4_address &first, const ipv4_address &last)
+    {
+        uint32_t lo = first.to_uint();
+        uint32_t hi = last.to_uint();
+
+        if (hi < lo) {
+            return;
+        }
+
+        // New blocks are collected and linked in together at the end.
+        std::vector<uint16_t> keys;
+        std::vector<_container> containers;
+        std::size_t added = 0;
+
+        for (uint32_t key = lo >> 16; key <= hi >> 16; key++) {
+            uint16_t begin = key == lo >> 16 ? lo & 0xFFFF : 0;
+            uint16_t end = key == hi >> 16 ? hi & 0xFFFF : 0xFFFF;
+            uint32_t count = end - begin + 1;
+            std::size_t index;
+
+            if (!_find(key, index)) {
+                keys.push_back(key);
+                containers.push_back(
+                    { _kind::run, count, { begin, end }, {} });
+                added += count;
+                continue;
+            }
+
+            _container &c = _containers[index];
+            uint32_t cardinality = c.cardinality;
+
+            if (count == 0x10000) {
+                std::vector<uint16_t> values{ begin, end };
+
+                c.kind = _kind::run;
+                c.values = std::move(values);
+                c.words = {};
+                c.cardinality = count;
+            } else {
+                _to_bitmap(c);
+                _fill(c.words, begin, end);
+                c.cardinality = _count(c.words);
+            }
+
+            _size += c.cardinality - cardinality;
+            _normalize(c);
+        }
+
+        if (!keys.empty()) {
+            _merge_containers(keys, containers);
+            _size += added;
+        }
+    }
+
+    // Returns whether `addr` was removed.
+    bool erase(const ipv4_address &addr)
+    {
+        uint32_t value = addr.to_uint();
+        std::size_t index;
+
+        if (!_find(value >> 16, index)) {
+            return false;
+        }
+
+        _container &c = _containers[index];
+        uint16_t low = value & 0xFFFF;
+
+        if (!_contains(c, low)) {
+            return false;
+        }
+
+        if (c.kind == _kind::run) {
+            _expand(c);
+        }
+
+        if (c.kind == _kind::array) {
+            c.values.erase(
+                std::lower_bound(c.values.begin(), c.values.end(), low));
+        } else {
+            c.words[low / 64] &= ~(uint64_t{ 1 } << (low % 64));
+        }
+
+        c.cardinality--;
+        _size--;
+
+        if (!c.cardinality) {
+            _keys.erase(_keys.begin() + index);
+            _containers.erase(_containers.begin() + index);
+            _index_update(value >> 16, false);
+        } else {
+            _normalize(c);
+        }
+
+        return true;
+    }
+
+    // Stores each container as runs where that takes less space than its
+    // array or bitmap.
+    void optimize()
+    {
+        for (_container &c : _containers) {
+            std::size_t runs = _count_runs(c);
+            std::size_t size = c.kind == _kind::bitmap ? 4096 :
+                               c.kind == _kind::array  ? c.values.size() :
+                                                         2 * runs;
+
+            if (2 * runs < size) {
+                _to_runs(c, runs);
+            }
+        }
+    }
+
+    ipv4_set &operator&=(const ipv4_set &other)
+    {
+        return *this = _combine<detail::ipv4_set_op::intersect>(*this, other);
+    }
+
+    ipv4_set &operator|=(const ipv4_set &other)
+    {
+        return *this = _combine<detail::ipv4_set_op::unite>(*this, other);
+    }
+
+    ipv4_set &operator-=(const ipv4_set &other)
+    {
+        return *this = _combine<detail::ipv4_set_op::subtract>(*this, other);
+    }
+
+    friend ipv4_set operator&(const ipv4_set &lh, const ipv4_set &rh)
+    {
+        return _combine<detail::ipv4_set_op::intersect>(lh, rh);
+    }
+
+    friend ipv4_set operator|(const ipv4_set &lh, const ipv4_set &rh)
+    {
+        return _combine<detail::ipv4_set_op::unite>(lh, rh);
+    }
+
+    friend ipv4_set operator-(const ipv4_set &lh, const ipv4_set &rh)
+    {
+        return _combine<detail::ipv4_set_op::subtract>(lh, rh);
+    }
+
+    friend bool operator==(const ipv4_set &lh, const ipv4_set &rh)
+    {
+        if (lh._size != rh._size || lh._keys != rh._keys) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < lh._containers.size(); i++) {
+            const _container &a = lh._containers[i];
+            const _container &b = rh._containers[i];
+
+            if (a.cardinality != b.cardinality ||
+                _combine(a, b, detail::ipv4_set_op::intersect).cardinality !=
+                    a.cardinality) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const_iterator begin() const noexcept { return const_iterator{ this, 0 }; }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator{ this, _containers.size() };
+    }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // Visits the addresses in ascending order.
+    class const_iterator {
+      public:
+        using difference_type = ipv4_set::difference_type;
+        using value_type = ipv4_set::value_type;
+        using pointer = void;
+        using reference = ipv4_address;
+        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
+
+        const_iterator() noexcept = default;
+
+        ipv4_address operator*() const noexcept
+        {
+            return ipv4_address{ uint32_t{ _set->_keys[_index] } << 16 | _low };
+        }
+
+        const_iterator &operator++() noexcept
+        {
+            const _container &c = _set->_containers[_index];
+
+            switch (c.kind) {
+            case _kind::array:
+                if (++_pos < c.values.size()) {
+                    _low = c.values[_pos];
+                    return *this;
+                }
+
+                break;
+            case _kind::bitmap:
+                if (_low < 0xFFFF && _seek_bit(c, _low + 1)) {
+                    return *this;
+                }
+
+                break;
+            case _kind::run:
+                if (_low < c.values[_pos + 1]) {
+                    _low++;
+                    return *this;
+                }
+
+                if ((_pos += 2) < c.values.size()) {
+                    _low = c.values[_pos];
+                    return *this;
+                }
+
+                break;
+            }
+
+            _index++;
+            _seek_container();
+
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            const_iterator ret{ *this };
+            ++*this;
+            return ret;
+        }
+
+        friend bool operator==(const const_iterator &lh,
+                               const const_iterator &rh) noexcept
+        {
+            return lh._index == rh._index && lh._low == rh._low;
+        }
+
+      private:
+        friend class ipv4_set;
+
+        const ipv4_set *_set = nullptr;
+        std::size_t _index = 0;
+        std::size_t _pos = 0;
+        uint32_t _low = 0;
+
+        const_iterator(const ipv4_set *set, std::size_t index) noexcept
+            : _set{ set }, _index{ index }
+        {
+            _seek_container();
+        }
+
+        // Moves to the first value of the container at `_index`. Containers
+        // are never empty.
+        void _seek_container() noexcept
+        {
+            _pos = 0;
+            _low = 0;
+
+            if (_index == _set->_containers.size()) {
+                return;
+            }
+
+            const _container &c = _set->_containers[_index];
+
+            if (c.kind == _kind::bitmap) {
+                _seek_bit(c, 0);
+            } else {
+                _low = c.values[0];
+            }
+        }
+
+        bool _seek_bit(const _container &c, uint32_t from) noexcept
+        {
+            std::size_t word = from / 64;
+            uint64_t bits = c.words[word] & (~uint64_t{ 0 } << (from % 64));
+
+            while (!bits) {
+                if (++word == 1024) {
+                    return false;
+                }
+
+                bits = c.words[word];
+            }
+
+            _low = word * 64 + std::countr_zero(bits);
+            return true;
+        }
+    };
+
+  private:
+    static constexpr std::size_t _array_max = 4096;
+
+    std::vector<uint16_t> _keys;
+    std::vector<_container> _containers;
+    std::vector<_index_entry> _index;
+    std::size_t _size = 0;
+
+    // Sets `index` to the position of the container for `key`, or to where
+    // it would go, and returns whether there is one.
+    bool _find(uint16_t key, std::size_t &index) const noexcept
+    {
+        if (_index.empty()) {
+            index = 0;
+            return false;
+        }
+
+        const _index_entry &entry = _index[key / 64];
+        uint64_t bit = uint64_t{ 1 } << (key % 64);
+
+        index = entry.rank + std::popcount(entry.present & (bit - 1));
+        return entry.present & bit;
+    }
+
+    // Marks the container for `key` as added or removed. The index must
+    // already be allocated.
+    void _index_update(uint16_t key, bool present) noexcept
+    {
+        uint64_t bit = uint64_t{ 1 } << (key % 64);
+
+        if (present) {
+            _index[key / 64].present |= bit;
+        } else {
+            _index[key / 64].present &= ~bit;
+        }
+
+        for (std::size_t i = key / 64 + 1; i < 1024; i++) {
+            _index[i].rank += present ? 1 : -1;
+        }
+    }
+
+    // Once the index is allocated this reuses its storage and cannot throw.
+    void _rebuild_index()
+    {
+        _index.clear();
+
+        if (_keys.empty()) {
+            return;
+        }
+
+        _index.resize(1024);
+
+        for (uint16_t key : _keys) {
+            _index[key / 64].present |= uint64_t{ 1 } << (key % 64);
+        }
+
+        uint32_t rank = 0;
+
+        for (_index_entry &entry : _index) {
+            entry.rank = rank;
+            rank += std::popcount(entry.present);
+        }
+    }
+
+    static uint32_t _count(const std::vector<uint64_t> &words) noexcept
+    {
+        uint32_t count = 0;
+
+        for (uint64_t word : words) {
+            count += std::popcount(word);
+        }
+
+        return count;
+    }
+
+    // Sets the bits `first` through `last` of a bitmap.
+    static void _fill(std::vector<uint64_t> &words, uint32_t first,
+                      uint32_t last) noexcept
+    {
+        std::size_t lo = first / 64;
+        std::size_t hi = last / 64;
+        uint64_t lo_mask = ~uint64_t{ 0 } << (first % 64);
+        uint64_t hi_mask = ~uint64_t{ 0 } >> (63 - last % 64);
+
+        if (lo == hi) {
+            words[lo] |= lo_mask & hi_mask;
+            return;
+        }
+
+        words[lo] |= lo_mask;
+
+        for (std::size_t i = lo + 1; i < hi; i++) {
+            words[i] = ~uint64_t{ 0 };
+        }
+
+        words[hi] |= hi_mask;
+    }
+
+    static bool _contains(const _container &c, uint16_t low) noexcept
+    {
+        switch (c.kind) {
+        case _kind::array: {
+            // Branch-free search for the last value not above `low`. Both
+            // possible next probes are prefetched, so the cache misses of a
+            // large array overlap rather than follow one another.
+            const uint16_t *base = c.values.data();
+
+            for (std::size_t n = c.values.size(); n > 1; n -= n / 2) {
+                prefetch(base + n / 4);
+                prefetch(base + n / 2 + n / 4);
+                base = base[n / 2] <= low ? base + n / 2 : base;
+            }
+
+            return *base == low;
+        }
+        case _kind::bitmap:
+            return c.words[low / 64] >> (low % 64) & 1;
+        default: {
+            // Find the last run starting at or before `low`.
+            std::size_t lo = 0;
+            std::size_t hi = c.values.size() / 2;
+
+            while (lo < hi) {
+                std::size_t mid = (lo + hi) / 2;
+
+                if (c.values[2 * mid] <= low) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+
+            return lo && low <= c.values[2 * lo - 1];
+        }
+        }
+    }
+
+    // Links `c` in as the container for `key` at `index`, as found by
+    // _find(). Containers are never empty, so `c` is built before it is
+    // linked; all allocation happens first and a throw leaves the set as it
+    // was.
+    void _insert_container(uint16_t key, std::size_t index, _container c)
+    {
+        if (_index.empty()) {
+            _index.resize(1024);
+        }
+
+        _reserve_one(_keys);
+        _reserve_one(_containers);
+        _keys.insert(_keys.begin() + index, key);
+        _containers.insert(_containers.begin() + index, std::move(c));
+        _index_update(key, true);
+    }
+
+    // Links in the containers for `keys`, which are ascending and none of
+    // which are in the set yet, in one pass. As with _insert_container(), a
+    // throw leaves the set as it was.
+    void _merge_containers(std::vector<uint16_t> &keys,
+                           std::vector<_container> &containers)
+    {
+        std::vector<uint16_t> merged_keys;
+        std::vector<_container> merged;
+
+        if (_index.empty()) {
+            _index.resize(1024);
+        }
+
+        merged_keys.reserve(_keys.size() + keys.size());
+        merged.reserve(_containers.size() + containers.size());
+
+        for (std::size_t i = 0, j = 0; i < _keys.size() || j < keys.size();) {
+            if (j == keys.size() || (i < _keys.size() && _keys[i] < keys[j])) {
+                merged_keys.push_back(_keys[i]);
+                merged.push_back(std::move(_containers[i++]));
+            } else {
+                merged_keys.push_back(keys[j]);
+                merged.push_back(std::move(containers[j++]));
+            }
+        }
+
+        _keys = std::move(merged_keys);
+        _containers = std::move(merged);
+        _rebuild_index();
+    }
+
+    // Makes room for one more element ahead of an insert, growing
+    // geometrically.
+    template <class V>
+    static void _reserve_one(V &v)
+    {
+        if (v.size() == v.capacity()) {
+            v.reserve(std::max(2 * v.capacity(), v.size() + 1));
+        }
+    }
+
+    static void _to_bitmap(_container &c)
+    {
+        if (c.kind == _kind::bitmap) {
+            return;
+        }
+
+        std::vector<uint64_t> words(1024);
+
+        if (c.kind == _kind::array) {
+            for (uint16_t low : c.values) {
+                words[low / 64] |= uint64_t{ 1 } << (low % 64);
+            }
+        } else {
+            for (std::size_t i = 0; i < c.values.size(); i += 2) {
+                _fill(words, c.values[i], c.values[i + 1]);
+            }
+        }
+
+        c.kind = _kind::bitmap;
+        c.words = std::move(words);
+        c.values = {};
+    }
+
+    static void _to_array(_container &c)
+    {
+        std::vector<uint16_t> values;
+        values.reserve(c.cardinality);
+
+        if (c.kind == _kind::bitmap) {
+            for (std::size_t i = 0; i < 1024; i++) {
+                for (uint64_t bits = c.words[i]; bits; bits &= bits - 1) {
+                    values.push_back(i * 64 + std::countr_zero(bits));
+                }
+            }
+        } else if (c.kind == _kind::run) {
+            for (std::size_t i = 0; i < c.values.size(); i += 2) {
+                for (uint32_t low = c.values[i]; low <= c.values[i + 1];
+                     low++) {
+                    values.push_back(low);
+                }
+            }
+        } else {
+            return;
+        }
+
+        c.kind = _kind::array;
+        c.values = std::move(values);
+        c.words = {};
+    }
+
+    // Converts a run container to whichever of the other two fits.
+    static void _expand(_container &c)
+    {
+        if (c.cardinality > _array_max) {
+            _to_bitmap(c);
+        } else {
+            _to_array(c);
+        }
+    }
+
+    // Keeps arrays at most `_array_max` long and bitmaps above it.
+    static void _normalize(_container &c)
+    {
+        if (c.kind == _kind::array && c.cardinality > _array_max) {
+            _to_bitmap(c);
+        } else if (c.kind == _kind::bitmap && c.cardinality <= _array_max) {
+            _to_array(c);
+        }
+    }
+
+    static std::size_t _count_runs(const _container &c) noexcept
+    {
+        switch (c.kind) {
+        case _kind::array: {
+            std::size_t runs = 0;
+
+            for (std::size_t i = 0; i < c.values.size(); i++) {
+                runs += !i || c.values[i] != c.values[i - 1] + 1;
+            }
+
+            return runs;
+        }
+        case _kind::bitmap: {
+            // A run starts at each set bit whose predecessor is clear.
+            std::size_t runs = 0;
+            uint64_t carry = 0;
+
+            for (uint64_t word : c.words) {
+                runs += std::popcount(word & ~(word << 1 | carry));
+                carry = word >> 63;
+            }
+
+            return runs;
+        }
+        default:
+            return c.values.size() / 2;
+        }
+    }
+
+    static void _to_runs(_container &c, std::size_t runs)
+    {
+        if (c.kind == _kind::run) {
+            return;
+        }
+
+        _to_array(c);
+
+        std::vector<uint16_t> values;
+        values.reserve(2 * runs);
+
+        for (std::size_t i = 0; i < c.values.size(); i++) {
+            if (!i || c.values[i] != c.values[i - 1] + 1) {
+                values.push_back(c.values[i]);
+                values.push_back(c.values[i]);
+            } else {
+                values.back() = c.values[i];
+            }
+        }
+
+        c.kind = _kind::run;
+        c.values = std::move(values);
+    }
+
+    // Combines two containers of the same block. Runs are expanded first;
+    // arrays are matched with the vector kernels, and arrays against bitmaps
+    // are probed bit by bit.
+    static _container _combine(const _container &lh, const _container &rh,
+                               detail::ipv4_set_op op)
+    {
+        using detail::ipv4_set_op;
+
+        if (lh.kind == _kind::run || rh.kind == _kind::run) {
+            _container a = lh;
+            _container b = rh;
+
+            if (a.kind == _kind::run) {
+                _expand(a);
+            }
+
+            if (b.kind == _kind::run) {
+                _expand(b);
+            }
+
+            return _combine(a, b, op);
+        }
+
+        _container result;
+
+        if (lh.kind == _kind::array && rh.kind == _kind::array) {
+            const uint16_t *a = lh.values.data();
+            const uint16_t *b = rh.values.data();
+            std::size_t na = lh.values.size();
+            std::size_t nb = rh.values.size();
+
+            result.values.resize(op == ipv4_set_op::unite ? na + nb : na);
+
+            switch (op) {
+            case ipv4_set_op::intersect:
+                result.cardinality =
+                    detail::ipv4_set_match_arrays<ipv4_set_op::intersect>(
+                        a, na, b, nb, result.values.data());
+                break;
+            case ipv4_set_op::unite:
+                result.cardinality = detail::ipv4_set_unite_arrays(
+                    a, na, b, nb, result.values.data());
+                break;
+            case ipv4_set_op::subtract:
+                result.cardinality =
+                    detail::ipv4_set_match_arrays<ipv4_set_op::subtract>(
+                        a, na, b, nb, result.values.data());
+                break;
+            }
+
+            result.values.resize(result.cardinality);
+        } else if (lh.kind == _kind::bitmap && rh.kind == _kind::bitmap) {
+            const uint64_t *a = lh.words.data();
+            const uint64_t *b = rh.words.data();
+
+            result.kind = _kind::bitmap;
+            result.words.resize(1024);
+
+            switch (op) {
+            case ipv4_set_op::intersect:
+                result.cardinality =
+                    detail::ipv4_set_combine_bitmaps<ipv4_set_op::intersect>(
+                        a, b, result.words.data());
+                break;
+            case ipv4_set_op::unite:
+                result.cardinality =
+                    detail::ipv4_set_combine_bitmaps<ipv4_set_op::unite>(
+                        a, b, result.words.data());
+                break;
+            case ipv4_set_op::subtract:
+                result.cardinality =
+                    detail::ipv4_set_combine_bitmaps<ipv4_set_op::subtract>(
+                        a, b, result.words.data());
+                break;
+            }
+        } else if (op == ipv4_set_op::unite) {
+            const _container &array = lh.kind == _kind::array ? lh : rh;
+            result = lh.kind == _kind::bitmap ? lh : rh;
+
+            for (uint16_t low : array.values) {
+                uint64_t &word = result.words[low / 64];
+                uint64_t bit = uint64_t{ 1 } << (low % 64);
+
+                result.cardinality += !(word & bit);
+                word |= bit;
+            }
+        } else if (lh.kind == _kind::array) {
+            // Keep the array elements the bitmap has, or lacks.
+            bool keep = op == ipv4_set_op::intersect;
+
+            for (uint16_t low : lh.values) {
+                if (_contains(rh, low) == keep) {
+                    result.values.push_back(low);
+                }
+            }
+
+            result.cardinality = result.values.size();
+        } else if (op == ipv4_set_op::intersect) {
+            for (uint16_t low : rh.values) {
+                if (_contains(lh, low)) {
+                    result.values.push_back(low);
+                }
+            }
+
+            result.cardinality = result.values.size();
+        } else {
+            result = lh;
+
+            for (uint16_t low : rh.values) {
+                uint64_t &word = result.words[low / 64];
+                uint64_t bit = uint64_t{ 1 } << (low % 64);
+
+                result.cardinality -= !!(word & bit);
+                word &= ~bit;
+            }
+        }
+
+        _normalize(result);
+        return result;
+    }
+
+    template <detail::ipv4_set_op Op>
+    static ipv4_set _combine(const ipv4_set &lh, const ipv4_set &rh)
+    {
+        ipv4_set result;
+        std::size_t i = 0;
+        std::size_t j = 0;
+
+        auto push = [&](uint16_t key, _container c) {
+            if (c.cardinality) {
+                result._size += c.cardinality;
+                result._keys.push_back(key);
+                result._containers.push_back(std::move(c));
+            }
+        };
+
+        while (i < lh._keys.size() && j < rh._keys.size()) {
+            uint16_t a = lh._keys[i];
+            uint16_t b = rh._keys[j];
+
+            if (a == b) {
+                push(a, _combine(lh._containers[i++], rh._containers[j++], Op));
+            } else if (a < b) {
+                if (Op != detail::ipv4_set_op::intersect) {
+                    push(a, lh._containers[i]);
+                }
+
+                i++;
+            } else {
+                if (Op == detail::ipv4_set_op::unite) {
+                    push(b, rh._containers[j]);
+                }
+
+                j++;
+            }
+        }
+
+        if (Op != detail::ipv4_set_op::intersect) {
+            for (; i < lh._keys.size(); i++) {
+                push(lh._keys[i], lh._containers[i]);
+            }
+        }
+
+        if (Op == detail::ipv4_set_op::unite) {
+            for (; j < rh._keys.size(); j++) {
+                push(rh._keys[j], rh._containers[j]);
+            }
+        }
+
+        result._rebuild_index();
+        return result;
+    }
+};
+
+} // namespace nothing
+
+#endif
@@ -0,0 +1,505 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV4_SKETCH_H_
+#define NOTHING_IPV4_SKETCH_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include <nothing/ipv4_address.h>
+#include <nothing/prefetch.h>
+
+/*
+ * Approximate per-address structures for traffic too large to count
+ * exactly. Each address maps to one 64-byte block, so an update or query
+ * touches a single cache line, and updates are relaxed atomic operations so
+ * that any number of threads may share a structure. Reads made while other
+ * threads update see some, but perhaps not all, of the updates.
+ */
+namespace nothing {
+namespace detail {
+
+// The 64-bit finalizer of MurmurHash3 over the address: its low half picks
+// the block and its high half the positions within it.
+constexpr uint64_t ipv4_sketch_hash(const ipv4_address &addr) noexcept
+{
+    uint64_t value = addr.to_network_order();
+
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCD;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53;
+    value ^= value >> 33;
+
+    return value;
+}
+
+// Maps the low half of `hash` onto `[0, size)` without a division.
+constexpr std::size_t ipv4_sketch_block(uint64_t hash,
+                                        std::size_t size) noexcept
+{
+    return (hash & 0xFFFFFFFF) * size >> 32;
+}
+
+// Calls `fn` with each index of `src` and its hash, prefetching the blocks
+// of the addresses a few places ahead among the `size` at `blocks`.
+template <class Block, class Fn>
+void ipv4_sketch_batch(const Block *blocks, std::size_t size,
+                       std::span<const ipv4_address> src, Fn fn)
+{
+    constexpr std::size_t distance = 8;
+    uint64_t hashes[distance];
+    std::size_t count = src.size();
+
+    for (std::size_t i = 0; i < std::min(count, distance); i++) {
+        hashes[i] = ipv4_sketch_hash(src[i]);
+        prefetch_write(&blocks[ipv4_sketch_block(hashes[i], size)]);
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        uint64_t hash = hashes[i % distance];
+
+        if (i + distance < count) {
+            uint64_t next = ipv4_sketch_hash(src[i + distance]);
+
+            hashes[i % distance] = next;
+            prefetch_write(&blocks[ipv4_sketch_block(next, size)]);
+        }
+
+        fn(i, hash);
+    }
+}
+
+} // namespace detail
+
+/*
+ * Bloom filter split into cache-line blocks. A key sets one bit in each of
+ * the eight words of its block, each chosen by multiplying the high half of
+ * its hash by a different odd constant. With about 16 bits per key, the
+ * false positive rate is near 0.1%.
+ */
+class ipv4_bloom_filter {
+  public:
+    // A filter of at least `bytes` bytes, and at least one block.
+    explicit ipv4_bloom_filter(std::size_t bytes)
+        : _size{ std::max<std::size_t>(1, (bytes + 63) / 64) },
+          _blocks{ new _block[_size]() }
+    {
+    }
+
+    std::size_t size_bytes() const noexcept { return 64 * _size; }
+
+    void clear() noexcept
+    {
+        for (std::size_t i = 0; i < _size; i++) {
+            for (auto &word : _blocks[i].words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void insert(const ipv4_address &addr) noexcept
+    {
+        _insert(detail::ipv4_sketch_hash(addr));
+    }
+
+    void insert(std::span<const ipv4_address> src) noexcept
+    {
+        _batch(src, [this](std::size_t, uint64_t hash) { _insert(hash); });
+    }
+
+    bool contains(const ipv4_address &addr) const noexcept
+    {
+        return _contains(detail::ipv4_sketch_hash(addr));
+    }
+
+    // Sets bit `i % 64` of `dest[i / 64]` to whether `src[i]` may be in the
+    // filter. `dest` must have room for a bit per address.
+    void contains(std::span<const ipv4_address> src,
+                  std::span<uint64_t> dest) const noexcept
+    {
+        std::fill_n(dest.begin(), (src.size() + 63) / 64, 0);
+        _batch(src, [&](std::size_t i, uint64_t hash) {
+            dest[i / 64] |= uint64_t{ _contains(hash) } << (i % 64);
+        });
+    }
+
+  private:
+    struct alignas(64) _block {
+        std::atomic<uint64_t> words[8];
+    };
+
+    static constexpr std::array<uint32_t, 8> _salts = {
+        0x47B6137B, 0x44974D91, 0x8824AD5B, 0xA2B7289D,
+        0x705495C7, 0x2DF1424B, 0x9EFC4947, 0x5C6BFB31,
+    };
+
+    std::size_t _size;
+    std::unique_ptr<_block[]> _blocks;
+
+    static uint64_t _bit(uint64_t hash, std::size_t i) noexcept
+    {
+        return uint64_t{ 1 } << (static_cast<uint32_t>(hash >> 32) * _salts[i]
+                                 >> 26);
+    }
+
+    void _insert(uint64_t hash) noexcept
+    {
+        _block &block = _blocks[detail::ipv4_sketch_block(hash, _size)];
+
+        for (std::size_t i = 0; i < 8; i++) {
+            uint64_t bit = _bit(hash, i);
+
+            // Skip the write, and the exclusive ownership of the line it
+            // needs, when the bit is already set.
+            if (!(block.words[i].load(std::memory_order_relaxed) & bit)) {
+                block.words[i].fetch_or(bit, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool _contains(uint64_t hash) const noexcept
+    {
+        const _block &block = _blocks[detail::ipv4_sketch_block(hash, _size)];
+        bool found = true;
+
+        for (std::size_t i = 0; i < 8; i++) {
+            found &= !!(block.words[i].load(std::memory_order_relaxed) &
+                        _bit(hash, i));
+        }
+
+        return found;
+    }
+
+    template <class Fn>
+    void _batch(std::span<const ipv4_address> src, Fn fn) const noexcept
+    {
+        detail::ipv4_sketch_batch(_blocks.get(), _size, src, fn);
+    }
+};
+
+/*
+ * Count-min sketch with each key's counters in one block. A block holds four
+ * rows of four 32-bit counters; a key adds to one counter in each row, and
+ * its estimate is the least of them. Estimates never undercount, and
+ * overcount only by the traffic of keys sharing a block and all four of its
+ * counters.
+ */
+class ipv4_count_min_sketch {
+  public:
+    explicit ipv4_count_min_sketch(std::size_t bytes)
+        : _size{ std::max<std::size_t>(1, (bytes + 63) / 64) },
+          _blocks{ new _block[_size]() }
+    {
+    }
+
+    std::size_t size_bytes() const noexcept { return 64 * _size; }
+
+    void clear() noexcept
+    {
+        for (std::size_t i = 0; i < _size; i++) {
+            for (auto &counter : _blocks[i].counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Adds `count` to the counters of `addr`, and returns its new estimate.
+    uint32_t add(const ipv4_address &addr, uint32_t count = 1) noexcept
+    {
+        return _add(detail::ipv4_sketch_hash(addr), count);
+    }
+
+    void add(std::span<const ipv4_address> src) noexcept
+    {
+        _batch(src, [this](std::size_t, uint64_t hash) { _add(hash, 1); });
+    }
+
+    uint32_t estimate(const ipv4_address &addr) const noexcept
+    {
+        return _estimate(detail::ipv4_sketch_hash(addr));
+    }
+
+    void estimate(std::span<const ipv4_address> src,
+                  std::span<uint32_t> dest) const noexcept
+    {
+        _batch(src, [&](std::size_t i, uint64_t hash) {
+            dest[i] = _estimate(hash);
+        });
+    }
+
+  private:
+    friend class ipv4_heavy_hitters;
+
+    struct alignas(64) _block {
+        std::atomic<uint32_t> counters[16];
+    };
+
+    std::size_t _size;
+    std::unique_ptr<_block[]> _blocks;
+
+    static std::size_t _counter(uint64_t hash, std::size_t row) noexcept
+    {
+        return 4 * row + (hash >> (32 + 2 * row) & 3);
+    }
+
+    uint32_t _add(uint64_t hash, uint32_t count) noexcept
+    {
+        _block &block = _blocks[detail::ipv4_sketch_block(hash, _size)];
+        uint32_t result = ~uint32_t{ 0 };
+
+        for (std::size_t row = 0; row < 4; row++) {
+            uint32_t old = block.counters[_counter(hash, row)].fetch_add(
+                count, std::memory_order_relaxed);
+            result = std::min(result, old + count);
+        }
+
+        return result;
+    }
+
+    uint32_t _estimate(uint64_t hash) const noexcept
+    {
+        const _block &block = _blocks[detail::ipv4_sketch_block(hash, _size)];
+        uint32_t result = ~uint32_t{ 0 };
+
+        for (std::size_t row = 0; row < 4; row++) {
+            result = std::min(result,
+                              block.counters[_counter(hash, row)].load(
+                                  std::memory_order_relaxed));
+        }
+
+        return result;
+    }
+
+    template <class Fn>
+    void _batch(std::span<const ipv4_address> src, Fn fn) const noexcept
+    {
+        detail::ipv4_sketch_batch(_blocks.get(), _size, src, fn);
+    }
+};
+
+/*
+ * Tracks the `k` addresses with the highest counts in a count-min sketch.
+ * The tracked addresses sit in a linear-probing table that updates only
+ * read: an update for an address already tracked, or whose estimate is no
+ * more than the least tracked estimate seen at the last admission, costs one
+ * probe and writes nothing. Any other update takes a lock and admits the
+ * address in place of the tracked address with the lowest estimate, which
+ * stays rare once the table holds the heavy hitters. Counts are not kept
+ * with the addresses; `top()` reads them from the sketch.
+ */
+class ipv4_heavy_hitters {
+  public:
+    ipv4_heavy_hitters(std::size_t k, std::size_t sketch_bytes)
+        : _sketch{ sketch_bytes },
+          _k{ std::max<std::size_t>(1, k) },
+          _mask{ std::bit_ceil(2 * _k) - 1 },
+          _slots{ new std::atomic<uint64_t>[_mask + 1]() }
+    {
+    }
+
+    std::size_t k() const noexcept { return _k; }
+    const ipv4_count_min_sketch &sketch() const noexcept { return _sketch; }
+
+    void clear()
+    {
+        std::lock_guard lock{ _mutex };
+
+        _sketch.clear();
+        _floor.store(0, std::memory_order_relaxed);
+        _count = 0;
+
+        for (std::size_t i = 0; i <= _mask; i++) {
+            _slots[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(const ipv4_address &addr, uint32_t count = 1)
+    {
+        uint64_t hash = detail::ipv4_sketch_hash(addr);
+        _offer(addr, hash, _sketch._add(hash, count));
+    }
+
+    void add(std::span<const ipv4_address> src)
+    {
+        _sketch._batch(src, [&](std::size_t i, uint64_t hash) {
+            _offer(src[i], hash, _sketch._add(hash, 1));
+        });
+    }
+
+    uint32_t estimate(const ipv4_address &addr) const noexcept
+    {
+        return _sketch.estimate(addr);
+    }
+
+    // The tracked addresses and their current estimates, highest first.
+    std::vector<std::pair<ipv4_address, uint32_t>> top() const
+    {
+        std::vector<std::pair<ipv4_address, uint32_t>> result;
+
+        {
+            std::lock_guard lock{ _mutex };
+
+            for (std::size_t i = 0; i <= _mask; i++) {
+                if (uint64_t slot = _slots[i].load(std::memory_order_relaxed)) {
+                    result.emplace_back(_address(slot), 0);
+                }
+            }
+        }
+
+        for (auto &[addr, count] : result) {
+            count = _sketch.estimate(addr);
+        }
+
+        std::sort(result.begin(), result.end(),
+                  [](const auto &lh, const auto &rh) {
+                      return lh.second > rh.second ||
+                             (lh.second == rh.second && lh.first < rh.first);
+                  });
+
+        return result;
+    }
+
+  private:
+    ipv4_count_min_sketch _sketch;
+    std::size_t _k;
+    std::size_t _mask;
+
+    // Zero when empty, and otherwise a set bit above the address, so that
+    // 0.0.0.0 may be tracked. Only written with `_mutex` held.
+    std::unique_ptr<std::atomic<uint64_t>[]> _slots;
+    std::size_t _count = 0;
+    std::atomic<uint32_t> _floor{ 0 };
+    mutable std::mutex _mutex;
+
+    static uint64_t _pack(const ipv4_address &addr) noexcept
+    {
+        return uint64_t{ 1 } << 32 | addr.to_network_order();
+    }
+
+    static ipv4_address _address(uint64_t slot) noexcept
+    {
+        return ipv4_address::from_network_order(static_cast<uint32_t>(slot));
+    }
+
+    std::size_t _home(uint64_t hash) const noexcept
+    {
+        return static_cast<std::size_t>(hash >> 32) & _mask;
+    }
+
+    // Whether `addr` is tracked. A search racing an eviction may miss an
+    // address being moved, but never finds one that is not there.
+    bool _find(const ipv4_address &addr, uint64_t hash) const noexcept
+    {
+        uint64_t packed = _pack(addr);
+
+        for (std::size_t i = _home(hash), n = 0; n <= _mask;
+             i = (i + 1) & _mask, n++) {
+            uint64_t slot = _slots[i].load(std::memory_order_relaxed);
+
+            if (slot == packed) {
+                return true;
+            } else if (!slot) {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    void _offer(const ipv4_address &addr, uint64_t hash, uint32_t estimate)
+    {
+        if (estimate <= _floor.load(std::memory_order_relaxed) ||
+            _find(addr, hash)) {
+            return;
+        }
+
+        std::lock_guard lock{ _mutex };
+
+        if (_find(addr, hash)) {
+            return;
+        }
+
+        if (_count < _k) {
+            _insert(addr, hash);
+            _count++;
+            return;
+        }
+
+        // Estimates only grow, so the least tracked one is found afresh.
+        std::size_t least = 0;
+        uint32_t least_estimate = ~uint32_t{ 0 };
+        uint32_t next_estimate = ~uint32_t{ 0 };
+
+        for (std::size_t i = 0; i <= _mask; i++) {
+            if (uint64_t slot = _slots[i].load(std::memory_order_relaxed)) {
+                uint32_t value = _sketch.estimate(_address(slot));
+
+                if (value < least_estimate) {
+                    next_estimate = least_estimate;
+                    least_estimate = value;
+                    least = i;
+                } else {
+                    next_estimate = std::min(next_estimate, value);
+                }
+            }
+        }
+
+        if (estimate <= least_estimate) {
+            _floor.store(least_estimate, std::memory_order_relaxed);
+            return;
+        }
+
+        _erase(least);
+        _insert(addr, hash);
+        _floor.store(std::min(next_estimate, estimate),
+                     std::memory_order_relaxed);
+    }
+
+    void _insert(const ipv4_address &addr, uint64_t hash) noexcept
+    {
+        std::size_t i = _home(hash);
+
+        while (_slots[i].load(std::memory_order_relaxed)) {
+            i = (i + 1) & _mask;
+        }
+
+        _slots[i].store(_pack(addr), std::memory_order_relaxed);
+    }
+
+    // Empties slot `i`, moving back later addresses of its cluster that
+    // would otherwise no longer be found from their home slots.
+    void _erase(std::size_t i) noexcept
+    {
+        for (std::size_t j = (i + 1) & _mask;; j = (j + 1) & _mask) {
+            uint64_t slot = _slots[j].load(std::memory_order_relaxed);
+
+            if (!slot) {
+                break;
+            }
+
+            std::size_t home =
+                _home(detail::ipv4_sketch_hash(_address(slot)));
+
+            if (((j - home) & _mask) >= ((j - i) & _mask)) {
+                _slots[i].store(slot, std::memory_order_relaxed);
+                i = j;
+            }
+        }
+
+        _slots[i].store(0, std::memory_order_relaxed);
+    }
+};
+
+} // namespace nothing
+
+#endif
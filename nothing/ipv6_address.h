@@ -0,0 +1,550 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_IPV6_ADDRESS_H_
+#define NOTHING_IPV6_ADDRESS_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <nothing/bit.h>
+#include <nothing/ipv4_address.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace nothing {
+
+namespace detail {
+
+struct ipv6_zero_run {
+    uint8_t start;
+    uint8_t size;
+};
+
+// Longest run of at least two zero groups for each mask of zero groups, the
+// first one on ties, as RFC 5952 compresses to "::". A size of zero means no
+// run qualifies.
+inline constexpr auto ipv6_zero_runs = [] {
+    std::array<ipv6_zero_run, 256> table{};
+
+    for (int mask = 0; mask < 256; mask++) {
+        for (int i = 0; i < 8;) {
+            int size = std::countr_one(static_cast<unsigned>(mask >> i));
+
+            if (size >= 2 && size > table[mask].size) {
+                table[mask] = { static_cast<uint8_t>(i),
+                                static_cast<uint8_t>(size) };
+            }
+
+            i += size + 1;
+        }
+    }
+
+    return table;
+}();
+
+// Character classes of the first 48 characters of an address, one bit per
+// position, along with the value of each hex digit.
+struct ipv6_scan {
+    uint64_t hex;
+    uint64_t colon;
+    uint64_t dot;
+    std::array<uint8_t, 48> nibbles;
+};
+
+inline void ipv6_scan_chars(const char *src, std::size_t size,
+                            ipv6_scan &scan) noexcept
+{
+    char buf[48]{};
+
+    if (size < 48) {
+        std::memcpy(buf, src, size);
+        src = buf;
+    }
+
+    scan.hex = scan.colon = scan.dot = 0;
+
+#if defined(__SSE2__)
+    for (int i = 0; i < 48; i += 16) {
+        __m128i chars =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                     _mm_set1_epi8('a'));
+        __m128i is_digit =
+            _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i is_alpha =
+            _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(scan.nibbles.data() + i),
+            _mm_or_si128(
+                _mm_and_si128(is_digit, digit),
+                _mm_and_si128(is_alpha,
+                              _mm_add_epi8(alpha, _mm_set1_epi8(10)))));
+
+        scan.hex |= static_cast<uint64_t>(_mm_movemask_epi8(
+                        _mm_or_si128(is_digit, is_alpha)))
+                    << i;
+        scan.colon |= static_cast<uint64_t>(_mm_movemask_epi8(
+                          _mm_cmpeq_epi8(chars, _mm_set1_epi8(':'))))
+                      << i;
+        scan.dot |= static_cast<uint64_t>(_mm_movemask_epi8(
+                        _mm_cmpeq_epi8(chars, _mm_set1_epi8('.'))))
+                    << i;
+    }
+#else
+    for (int i = 0; i < 48; i++) {
+        char c = src[i];
+        uint8_t digit = c - '0';
+        uint8_t alpha = (c | 0x20) - 'a';
+
+        scan.nibbles[i] = digit < 10 ? digit : alpha < 6 ? alpha + 10 : 0;
+        scan.hex |= static_cast<uint64_t>(digit < 10 || alpha < 6) << i;
+        scan.colon |= static_cast<uint64_t>(c == ':') << i;
+        scan.dot |= static_cast<uint64_t>(c == '.') << i;
+    }
+#endif
+}
+
+// Writes the four lowercase hex digits of each group of `bytes` to `dest`.
+inline void ipv6_hex_groups(const uint8_t *bytes, char *dest) noexcept
+{
+#if defined(__SSE2__)
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    __m128i low = _mm_and_si128(in, _mm_set1_epi8(15));
+    __m128i high = _mm_and_si128(_mm_srli_epi16(in, 4), _mm_set1_epi8(15));
+
+    auto to_chars = [](__m128i nibbles) {
+        return _mm_add_epi8(
+            _mm_add_epi8(nibbles, _mm_set1_epi8('0')),
+            _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                          _mm_set1_epi8('a' - '0' - 10)));
+    };
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest),
+                     to_chars(_mm_unpacklo_epi8(high, low)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 16),
+                     to_chars(_mm_unpackhi_epi8(high, low)));
+#else
+    constexpr char charset[] = "0123456789abcdef";
+
+    for (int i = 0; i < 16; i++) {
+        dest[2 * i] = charset[bytes[i] >> 4];
+        dest[2 * i + 1] = charset[bytes[i] & 15];
+    }
+#endif
+}
+
+// Mask of the zero groups of `bytes`.
+inline unsigned ipv6_zero_groups(const uint8_t *bytes) noexcept
+{
+#if defined(__SSE2__)
+    __m128i zero = _mm_cmpeq_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes)),
+        _mm_setzero_si128());
+
+    return _mm_movemask_epi8(_mm_packs_epi16(zero, zero)) & 0xFF;
+#else
+    unsigned mask = 0;
+
+    for (int i = 0; i < 8; i++) {
+        mask |= !(bytes[2 * i] | bytes[2 * i + 1]) << i;
+    }
+
+    return mask;
+#endif
+}
+
+} // namespace detail
+
+class ipv6_address {
+  private:
+    using bytes_base = std::array<uint8_t, 16>;
+
+  public:
+    struct bytes_type : bytes_base {
+        template <std::convertible_to<uint8_t>... Args>
+        constexpr bytes_type(Args... args)
+            : bytes_base{ static_cast<uint8_t>(std::forward<Args>(args))... }
+        {
+        }
+    };
+
+    static constexpr size_t string_size = 46;
+
+    constexpr ipv6_address() noexcept : _data{} {}
+
+    constexpr ipv6_address(const bytes_type &value) noexcept
+        : _data{ std::bit_cast<std::array<uint64_t, 2>>(value) }
+    {
+    }
+
+    // Address from its high and low 64 bits.
+    constexpr ipv6_address(uint64_t high, uint64_t low) noexcept
+        : _data{ big_endian(high), big_endian(low) }
+    {
+    }
+
+    constexpr uint64_t high() const noexcept { return big_endian(_data[0]); }
+    constexpr uint64_t low() const noexcept { return big_endian(_data[1]); }
+
+    constexpr bytes_type to_bytes() const noexcept
+    {
+        return std::bit_cast<bytes_type>(_data);
+    }
+
+    // The IPv4-mapped address ::ffff:a.b.c.d.
+    static constexpr ipv6_address v4_mapped(const ipv4_address &addr) noexcept
+    {
+        return ipv6_address{ 0, uint64_t{ 0xFFFF00000000 } | addr.to_uint() };
+    }
+
+    // The embedded address of an IPv4-mapped address.
+    constexpr ipv4_address to_v4() const noexcept
+    {
+        return ipv4_address{ static_cast<uint32_t>(low()) };
+    }
+
+    template <class Allocator = std::allocator<char>>
+    auto to_string(const Allocator &alloc = Allocator()) const
+    {
+        using string_type =
+            std::basic_string<char, std::char_traits<char>, Allocator>;
+
+        char buf[string_size];
+        char *end = format(buf);
+
+        return string_type(buf, end, alloc);
+    }
+
+    template <std::output_iterator<char> Out>
+    Out to_chars(Out dest) const
+    {
+        char buf[string_size];
+        return std::copy(buf, format(buf), dest);
+    }
+
+    // Writes the RFC 5952 form of the address to `dest` and returns the end
+    // of the text: lowercase, without leading zeros, the longest run of zero
+    // groups compressed to "::" and IPv4-mapped addresses ending in dotted
+    // decimal. Only mapped addresses do: the deprecated IPv4-compatible form
+    // prints in hex, as "::102:304" where `inet_ntop` gives "::1.2.3.4".
+    // `dest` must have room for `string_size` characters, though the text
+    // itself may be shorter.
+    char *format(char *dest) const noexcept
+    {
+        bytes_type bytes = to_bytes();
+
+        if (is_v4_mapped()) {
+            std::memcpy(dest, "::ffff:", 7);
+            return to_v4().format(dest + 7);
+        }
+
+        char hex[48];
+        detail::ipv6_hex_groups(bytes.data(), hex);
+
+        auto run = detail::ipv6_zero_runs[detail::ipv6_zero_groups(
+            bytes.data())];
+        bool separate = false;
+
+        for (int i = 0; i < 8;) {
+            if (i == run.start && run.size) {
+                *dest++ = ':';
+                *dest++ = ':';
+                separate = false;
+                i += run.size;
+                continue;
+            }
+
+            if (separate) {
+                *dest++ = ':';
+            }
+
+            int skip = std::min(std::countl_zero(_group(bytes, i)) / 4, 3);
+
+            std::memcpy(dest, hex + 4 * i + skip, 4);
+            dest += 4 - skip;
+            separate = true;
+            i++;
+        }
+
+        return dest;
+    }
+
+    constexpr bool is_unspecified() const noexcept
+    {
+        return !_data[0] && !_data[1];
+    }
+
+    constexpr bool is_loopback() const noexcept
+    {
+        return !_data[0] && low() == 1; // ::1/128
+    }
+
+    constexpr bool is_link_local() const noexcept
+    {
+        return (high() >> 54) == 0x3FA; // fe80::/10
+    }
+
+    constexpr bool is_private() const noexcept
+    {
+        return (high() >> 57) == 0x7E; // fc00::/7
+    }
+
+    constexpr bool is_multicast() const noexcept
+    {
+        return (high() >> 56) == 0xFF; // ff00::/8
+    }
+
+    constexpr bool is_v4_mapped() const noexcept
+    {
+        return !_data[0] && (low() >> 32) == 0xFFFF; // ::ffff:0:0/96
+    }
+
+    static constexpr ipv6_address any() noexcept { return ipv6_address{}; }
+    static constexpr ipv6_address loopback() noexcept
+    {
+        return ipv6_address{ 0, 1 };
+    }
+
+    static ipv6_address from_string(std::string_view src)
+    {
+        std::error_code error;
+        ipv6_address addr = from_string(src, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return addr;
+    }
+
+    static ipv6_address from_string(std::string_view src,
+                                    std::string_view::iterator &last)
+    {
+        std::error_code error;
+        ipv6_address addr = from_string(src, last, error);
+
+        if (error) {
+            throw std::system_error(error);
+        }
+
+        return addr;
+    }
+
+    static ipv6_address from_string(std::string_view src,
+                                    std::error_code &error) noexcept
+    {
+        std::string_view::iterator last = src.begin();
+        ipv6_address addr = from_string(src, last, error);
+
+        if (last != src.end()) {
+            error = std::make_error_code(std::errc::invalid_argument);
+        }
+
+        return addr;
+    }
+
+    // Parses the address formed by the leading hex digits, colons and dots of
+    // `src`. Character classes and digit values are found for the whole text
+    // at once, after which the groups are read off the colon mask; an IPv4
+    // tail goes through the ipv4_address parser.
+    static ipv6_address from_string(std::string_view src,
+                                    std::string_view::iterator &last,
+                                    std::error_code &error) noexcept
+    {
+        detail::ipv6_scan scan;
+        detail::ipv6_scan_chars(src.data(), src.size(), scan);
+
+        int size = std::countr_one(scan.hex | scan.colon | scan.dot);
+        uint64_t colon = scan.colon & ((uint64_t{ 1 } << size) - 1);
+        uint64_t dot = scan.dot & ((uint64_t{ 1 } << size) - 1);
+        std::array<uint16_t, 8> groups{};
+        int end = size;
+        int tail = 0;
+
+        error = std::make_error_code(std::errc::invalid_argument);
+
+        if (size > 45 || !colon) {
+            return {};
+        }
+
+        if (dot) {
+            int pos = std::bit_width(colon);
+
+            if (dot & ((uint64_t{ 1 } << pos) - 1)) {
+                return {};
+            }
+
+            std::error_code v4_error;
+            uint32_t v4 = ipv4_address::from_string(
+                              src.substr(pos, size - pos), v4_error)
+                              .to_uint();
+
+            if (v4_error) {
+                return {};
+            }
+
+            groups[6] = v4 >> 16;
+            groups[7] = v4;
+            tail = 2;
+            end = pos >= 2 && (colon >> (pos - 2) & 1) ? pos : pos - 1;
+        }
+
+        uint64_t doubles = colon & colon >> 1 & ((uint64_t{ 1 } << end) - 1);
+
+        if (std::popcount(doubles) > 1) {
+            return {};
+        }
+
+        uint16_t right[8];
+        int left_count = 0;
+        int right_count = 0;
+
+        if (doubles) {
+            int pos = std::countr_zero(doubles);
+
+            if (!_parse_groups(scan, colon, 0, pos, groups.data(),
+                               left_count) ||
+                !_parse_groups(scan, colon, pos + 2, end, right,
+                               right_count) ||
+                left_count + right_count + tail > 7) {
+                return {};
+            }
+        } else if (!_parse_groups(scan, colon, 0, end, groups.data(),
+                                  left_count) ||
+                   left_count + tail != 8) {
+            return {};
+        }
+
+        std::copy_n(right, right_count,
+                    groups.begin() + 8 - tail - right_count);
+
+        bytes_type bytes;
+
+        for (int i = 0; i < 8; i++) {
+            bytes[2 * i] = groups[i] >> 8;
+            bytes[2 * i + 1] = groups[i];
+        }
+
+        last = src.begin() + size;
+        error.clear();
+
+        return ipv6_address{ bytes };
+    }
+
+    constexpr bool operator==(const ipv6_address &other) const noexcept
+    {
+        return _data == other._data;
+    }
+
+    constexpr auto operator<=>(const ipv6_address &other) const noexcept
+    {
+        if (auto cmp = high() <=> other.high(); cmp != 0) {
+            return cmp;
+        }
+
+        return low() <=> other.low();
+    }
+
+  private:
+    // Network order, so the bytes in memory read as written.
+    std::array<uint64_t, 2> _data;
+
+    static constexpr uint16_t _group(const bytes_type &bytes, int i) noexcept
+    {
+        return bytes[2 * i] << 8 | bytes[2 * i + 1];
+    }
+
+    // Reads the colon-separated groups of [first, last) into `dest`, which
+    // has room for eight. An empty range holds no groups.
+    static bool _parse_groups(const detail::ipv6_scan &scan, uint64_t colon,
+                              int first, int last, uint16_t *dest,
+                              int &count) noexcept
+    {
+        count = 0;
+
+        if (first == last) {
+            return true;
+        }
+
+        for (;;) {
+            uint64_t rest = colon >> first << first;
+            int end = rest ? std::min(std::countr_zero(rest), last) : last;
+
+            if (end - first < 1 || end - first > 4 || count == 8) {
+                return false;
+            }
+
+            uint16_t value = 0;
+
+            for (int i = first; i < end; i++) {
+                value = value << 4 | scan.nibbles[i];
+            }
+
+            dest[count++] = value;
+
+            if (end == last) {
+                return true;
+            }
+
+            first = end + 1;
+        }
+    }
+};
+
+// Writes `src` to `dest` with `sep` between addresses and returns the end of
+// the text. `dest` must have room for `src.size() * ipv6_address::string_size`
+// characters.
+inline char *format_many(std::span<const ipv6_address> src, char *dest,
+                         char sep = '\n') noexcept
+{
+    for (std::size_t i = 0; i < src.size(); i++) {
+        if (i) {
+            *dest++ = sep;
+        }
+
+        dest = src[i].format(dest);
+    }
+
+    return dest;
+}
+
+template <class T, class CharT>
+std::basic_ostream<T, CharT> &
+operator<<(std::basic_ostream<T, CharT> &os, const ipv6_address &addr)
+{
+    char buf[ipv6_address::string_size];
+    return os.write(buf, addr.format(buf) - buf);
+}
+
+} // namespace nothing
+
+namespace std {
+
+template <>
+struct hash<nothing::ipv6_address> {
+    constexpr std::size_t
+    operator()(const nothing::ipv6_address &addr) const noexcept
+    {
+        uint64_t value = (addr.high() ^ addr.low() * 0xC2B2AE3D27D4EB4F) *
+                         0x9E3779B97F4A7C15;
+        return static_cast<std::size_t>(value ^ value >> 32);
+    }
+};
+
+} // namespace std
+
+#endif
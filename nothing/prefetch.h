@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#ifndef NOTHING_PREFETCH_H_
+#define NOTHING_PREFETCH_H_
+
+#include <type_traits>
+
+namespace nothing {
+
+// Hints that the line holding `ptr` is about to be read. Does nothing where
+// the compiler has no prefetch or during constant evaluation.
+constexpr void prefetch(const void *ptr) noexcept
+{
+#if __has_builtin(__builtin_prefetch)
+    if (!std::is_constant_evaluated()) {
+        __builtin_prefetch(ptr);
+    }
+#else
+    static_cast<void>(ptr);
+#endif
+}
+
+// Hints that the line holding `ptr` is about to be written.
+constexpr void prefetch_write(const void *ptr) noexcept
+{
+#if __has_builtin(__builtin_prefetch)
+    if (!std::is_constant_evaluated()) {
+        __builtin_prefetch(ptr, 1);
+    }
+#else
+    static_cast<void>(ptr);
+#endif
+}
+
+} // namespace nothing
+
+#endif
@@ -70,62 +70,62 @@ void unaligned_store(T value, void *ptr)
     detail::unaligned_store_impl(value, ptr);
 }
 
-uint64_t unaligned_load_be64(const void *ptr)
+inline uint64_t unaligned_load_be64(const void *ptr)
 {
     return unaligned_load<uint64_t, std::endian::big>(ptr);
 }
 
-uint64_t unaligned_load_le64(const void *ptr)
+inline uint64_t unaligned_load_le64(const void *ptr)
 {
     return unaligned_load<uint64_t, std::endian::little>(ptr);
 }
 
-uint32_t unaligned_load_be32(const void *ptr)
+inline uint32_t unaligned_load_be32(const void *ptr)
 {
     return unaligned_load<uint32_t, std::endian::big>(ptr);
 }
 
-uint32_t unaligned_load_le32(const void *ptr)
+inline uint32_t unaligned_load_le32(const void *ptr)
 {
     return unaligned_load<uint32_t, std::endian::little>(ptr);
 }
 
-uint16_t unaligned_load_be16(const void *ptr)
+inline uint16_t unaligned_load_be16(const void *ptr)
 {
     return unaligned_load<uint16_t, std::endian::big>(ptr);
 }
 
-uint16_t unaligned_load_le16(const void *ptr)
+inline uint16_t unaligned_load_le16(const void *ptr)
 {
     return unaligned_load<uint16_t, std::endian::little>(ptr);
 }
 
-void unaligned_store_be64(uint64_t value, void *ptr)
+inline void unaligned_store_be64(uint64_t value, void *ptr)
 {
     unaligned_store<uint64_t, std::endian::big>(value, ptr);
 }
 
-void unaligned_store_le64(uint64_t value, void *ptr)
+inline void unaligned_store_le64(uint64_t value, void *ptr)
 {
     unaligned_store<uint64_t, std::endian::little>(value, ptr);
 }
 
-void unaligned_store_be32(uint32_t value, void *ptr)
+inline void unaligned_store_be32(uint32_t value, void *ptr)
 {
     unaligned_store<uint32_t, std::endian::big>(value, ptr);
 }
 
-void unaligned_store_le32(uint32_t value, void *ptr)
+inline void unaligned_store_le32(uint32_t value, void *ptr)
 {
     unaligned_store<uint32_t, std::endian::little>(value, ptr);
 }
 
-void unaligned_store_be16(uint16_t value, void *ptr)
+inline void unaligned_store_be16(uint16_t value, void *ptr)
 {
     unaligned_store<uint16_t, std::endian::big>(value, ptr);
 }
 
-void unaligned_store_le16(uint16_t value, void *ptr)
+inline void unaligned_store_le16(uint16_t value, void *ptr)
 {
     unaligned_store<uint16_t, std::endian::little>(value, ptr);
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/encoding.h>
+
+namespace {
+
+using nothing::base32_mode;
+using nothing::base64_padding;
+
+std::vector<uint8_t> random_bytes(std::mt19937 &rng, std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+
+    for (uint8_t &byte : bytes) {
+        byte = rng();
+    }
+
+    return bytes;
+}
+
+template <base32_mode Mode, base64_padding Padding = base64_padding::optional>
+std::string encode(std::string_view src)
+{
+    std::string ret;
+    nothing::base32_encode<Mode, Padding>(src, std::back_inserter(ret));
+    return ret;
+}
+
+template <base32_mode Mode, base64_padding Padding = base64_padding::optional>
+std::vector<uint8_t> decode(std::string_view src)
+{
+    std::list<char> chars(src.begin(), src.end());
+    std::vector<uint8_t> ret;
+    nothing::base32_decode<Mode, Padding>(chars, std::back_inserter(ret));
+    return ret;
+}
+
+} // namespace
+
+TEST(Base32, Rfc4648Vectors)
+{
+    const char *regular[] = { "",         "MY======", "MZXQ====",
+                              "MZXW6===", "MZXW6YQ=", "MZXW6YTB",
+                              "MZXW6YTBOI======" };
+    const char *hex[] = { "",         "CO======", "CPNG====", "CPNMU===",
+                          "CPNMUOG=", "CPNMUOJ1", "CPNMUOJ1E8======" };
+    std::string_view text = "foobar";
+
+    for (std::size_t i = 0; i <= text.size(); i++) {
+        std::string_view part = text.substr(0, i);
+        std::vector<uint8_t> bytes(part.begin(), part.end());
+
+        EXPECT_EQ(encode<base32_mode::regular>(part), regular[i]);
+        EXPECT_EQ(encode<base32_mode::hex>(part), hex[i]);
+        EXPECT_EQ(decode<base32_mode::regular>(regular[i]), bytes);
+        EXPECT_EQ(decode<base32_mode::hex>(hex[i]), bytes);
+    }
+}
+
+TEST(Base32, RoundTripsAndRejectsBadCharacters)
+{
+    std::mt19937 rng(8);
+
+    for (std::size_t size = 0; size <= 60; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string_view view(reinterpret_cast<const char *>(bytes.data()),
+                              bytes.size());
+        std::string padded = encode<base32_mode::regular>(view);
+        std::string bare =
+            encode<base32_mode::regular, base64_padding::none>(view);
+
+        ASSERT_EQ(padded.size() % 8, 0u);
+        ASSERT_EQ(padded.substr(0, bare.size()), bare);
+        ASSERT_EQ(decode<base32_mode::regular>(padded), bytes);
+        ASSERT_EQ(decode<base32_mode::regular>(bare), bytes);
+        ASSERT_EQ(decode<base32_mode::hex>(encode<base32_mode::hex>(view)),
+                  bytes);
+
+        if (padded != bare) {
+            ASSERT_THROW(
+                (decode<base32_mode::regular, base64_padding::required>(bare)),
+                std::invalid_argument);
+            ASSERT_THROW(
+                (decode<base32_mode::regular, base64_padding::none>(padded)),
+                std::invalid_argument);
+        }
+
+        for (std::size_t pos = 0; pos < padded.size(); pos++) {
+            std::string bad = padded;
+            bad[pos] = "018a9z!"[rng() % 7];
+
+            std::vector<uint8_t> out;
+            auto res = nothing::base32_decode(bad, std::back_inserter(out),
+                                              std::nothrow);
+
+            ASSERT_EQ(res.ec, std::errc::invalid_argument);
+            ASSERT_EQ(res.offset, pos);
+            ASSERT_THROW(decode<base32_mode::regular>(bad),
+                         std::invalid_argument);
+        }
+    }
+}
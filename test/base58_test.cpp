@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/encoding.h>
+
+namespace {
+
+constexpr std::string_view charset =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+// Schoolbook conversion, one digit at a time.
+std::string reference_encode(const std::vector<uint8_t> &bytes)
+{
+    std::vector<uint8_t> number(bytes);
+    std::string ret;
+    std::size_t zeros = 0;
+
+    while (zeros < bytes.size() && !bytes[zeros]) {
+        zeros++;
+    }
+
+    for (std::size_t start = zeros; start < number.size();) {
+        unsigned remainder = 0;
+
+        for (std::size_t i = start; i < number.size(); i++) {
+            unsigned value = remainder << 8 | number[i];
+            number[i] = value / 58;
+            remainder = value % 58;
+        }
+
+        ret += charset[remainder];
+
+        while (start < number.size() && !number[start]) {
+            start++;
+        }
+    }
+
+    ret.append(zeros, '1');
+    std::reverse(ret.begin(), ret.end());
+
+    return ret;
+}
+
+std::string encode(const std::vector<uint8_t> &bytes)
+{
+    std::string ret;
+    nothing::base58_encode(bytes, std::back_inserter(ret));
+    return ret;
+}
+
+std::vector<uint8_t> decode(std::string_view src)
+{
+    std::vector<uint8_t> ret;
+    nothing::base58_decode(src, std::back_inserter(ret));
+    return ret;
+}
+
+std::vector<uint8_t> bytes_of(std::string_view text)
+{
+    return { text.begin(), text.end() };
+}
+
+} // namespace
+
+TEST(Base58, KnownVectors)
+{
+    EXPECT_EQ(encode(bytes_of("Hello World!")), "2NEpo7TZRRrLZSi2U");
+    EXPECT_EQ(encode(bytes_of("The quick brown fox jumps over the lazy dog.")),
+              "USm3fpXnKG5EUBx2ndxBDMPVciP5hGey2Jh4NDv6gmeo1LkMeiKrLJUUBk6Z");
+    EXPECT_EQ(encode({ 0, 0, 0x28, 0x7F, 0xB4, 0xCD }), "11233QC4");
+    EXPECT_EQ(encode({}), "");
+    EXPECT_EQ(encode({ 0 }), "1");
+
+    EXPECT_EQ(decode("2NEpo7TZRRrLZSi2U"), bytes_of("Hello World!"));
+    EXPECT_EQ(decode("11233QC4"),
+              std::vector<uint8_t>({ 0, 0, 0x28, 0x7F, 0xB4, 0xCD }));
+    EXPECT_EQ(decode(""), std::vector<uint8_t>());
+}
+
+TEST(Base58, MatchesReferenceWithLeadingZeros)
+{
+    std::mt19937 rng(9);
+
+    for (int round = 0; round < 2000; round++) {
+        std::vector<uint8_t> bytes(rng() % 80);
+
+        for (std::size_t i = 0; i < bytes.size(); i++) {
+            // Runs of zeros at the front and inside the number.
+            bytes[i] = rng() % 4 ? rng() : 0;
+        }
+
+        std::size_t zeros = std::min<std::size_t>(rng() % 4, bytes.size());
+        std::fill_n(bytes.begin(), zeros, 0);
+
+        std::string text = reference_encode(bytes);
+
+        ASSERT_EQ(encode(bytes), text);
+        ASSERT_EQ(decode(text), bytes);
+    }
+}
+
+TEST(Base58, RejectsCharactersOutsideTheAlphabet)
+{
+    std::mt19937 rng(10);
+    std::vector<uint8_t> bytes(40);
+
+    for (uint8_t &byte : bytes) {
+        byte = rng();
+    }
+
+    std::string text = encode(bytes);
+
+    for (std::size_t pos = 0; pos < text.size(); pos++) {
+        std::string bad = text;
+        bad[pos] = "0OIl+/ "[rng() % 7];
+
+        std::vector<uint8_t> out;
+        auto res = nothing::base58_decode(bad, std::back_inserter(out),
+                                          std::nothrow);
+
+        ASSERT_EQ(res.ec, std::errc::invalid_argument);
+        ASSERT_EQ(res.offset, pos);
+        ASSERT_EQ(res.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+        ASSERT_THROW(decode(bad), std::invalid_argument);
+    }
+}
@@ -0,0 +1,688 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/encoding.h>
+
+namespace {
+
+using nothing::base64_mode;
+using nothing::base64_padding;
+
+// Lengths on and around every vector width the kernels use.
+constexpr std::size_t max_length = 200;
+
+std::vector<uint8_t> random_bytes(std::mt19937 &rng, std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+
+    for (uint8_t &byte : bytes) {
+        byte = rng();
+    }
+
+    return bytes;
+}
+
+std::string reference_encode(const std::vector<uint8_t> &bytes,
+                             base64_mode mode, bool pad)
+{
+    const char *charset =
+        mode == base64_mode::regular ?
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" :
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    std::string ret;
+
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+        std::size_t n = std::min<std::size_t>(3, bytes.size() - i);
+        uint32_t group = 0;
+
+        for (std::size_t j = 0; j < 3; j++) {
+            group = group << 8 | (j < n ? bytes[i + j] : 0);
+        }
+
+        for (std::size_t j = 0; j <= n; j++) {
+            ret += charset[group >> (18 - 6 * j) & 63];
+        }
+
+        if (pad) {
+            ret.append(3 - n, '=');
+        }
+    }
+
+    return ret;
+}
+
+// Contiguous input and output take the vector kernels; a list and a back
+// inserter take the scalar loop.
+template <base64_mode Mode, base64_padding Padding>
+std::string contiguous_encode(const std::vector<uint8_t> &bytes)
+{
+    std::string ret(nothing::base64_encoded_size<Mode, Padding>(bytes.size()),
+                    '\0');
+    auto res = nothing::base64_encode<Mode, Padding>(bytes, ret.data());
+    EXPECT_EQ(res.out, ret.data() + ret.size());
+    return ret;
+}
+
+template <base64_mode Mode, base64_padding Padding>
+std::string scalar_encode(const std::vector<uint8_t> &bytes)
+{
+    std::list<uint8_t> src(bytes.begin(), bytes.end());
+    std::string ret;
+    nothing::base64_encode<Mode, Padding>(src, std::back_inserter(ret));
+    return ret;
+}
+
+template <base64_mode Mode, base64_padding Padding>
+std::vector<uint8_t> contiguous_decode(const std::string &src)
+{
+    std::vector<uint8_t> ret(nothing::base64_decoded_size_max(src.size()));
+    auto res = nothing::base64_decode<Mode, Padding>(src, ret.data());
+    ret.resize(res.out - ret.data());
+    return ret;
+}
+
+template <base64_mode Mode, base64_padding Padding>
+std::vector<uint8_t> scalar_decode(const std::string &src)
+{
+    std::list<char> chars(src.begin(), src.end());
+    std::vector<uint8_t> ret;
+    nothing::base64_decode<Mode, Padding>(chars, std::back_inserter(ret));
+    return ret;
+}
+
+// Three chunks, each above the minimum a thread is given, and a short final
+// group.
+template <base64_mode Mode, base64_padding Padding>
+void check_parallel()
+{
+    std::mt19937 rng(12);
+    nothing::parallel_policy policy{ 3 };
+    std::size_t size = 3 * nothing::detail::parallel_min_chunk + 2;
+    std::vector<uint8_t> bytes = random_bytes(rng, size);
+    std::string text(nothing::base64_encoded_size<Mode, Padding>(size), '\0');
+    auto encoded =
+        nothing::base64_encode<Mode, Padding>(policy, bytes, text.data());
+
+    ASSERT_EQ(text, (contiguous_encode<Mode, Padding>(bytes)));
+    ASSERT_EQ(encoded.out, text.data() + text.size());
+
+    std::vector<uint8_t> out(nothing::base64_decoded_size_max(text.size()));
+    auto decoded =
+        nothing::base64_decode<Mode, Padding>(policy, text, out.data());
+
+    out.resize(decoded.out - out.data());
+    ASSERT_EQ(out, bytes);
+
+    // Chunks before the last hold only whole, unpadded groups.
+    std::size_t chunk =
+        nothing::detail::parallel_chunk_size<4>(policy, text.size());
+    std::string bad = text;
+    bad[chunk / 2] = '!';
+
+    out.resize(nothing::base64_decoded_size_max(text.size()));
+    EXPECT_THROW((nothing::base64_decode<Mode, Padding>(policy, bad,
+                                                        out.data())),
+                 std::invalid_argument);
+
+    bad = text;
+    bad[chunk - 1] = '=';
+
+    EXPECT_THROW((nothing::base64_decode<Mode, Padding>(policy, bad,
+                                                        out.data())),
+                 std::invalid_argument);
+}
+
+// Feeds the input in three pieces split at every pair of offsets, through
+// contiguous ranges and through lists, and compares with the one-shot
+// functions. The same objects are reused throughout.
+template <base64_mode Mode, base64_padding Padding>
+void check_streaming()
+{
+    std::mt19937 rng(13);
+    nothing::base64_encoder<Mode, Padding> encoder;
+    nothing::base64_decoder<Mode, Padding> decoder;
+
+    for (std::size_t size : { 0, 1, 2, 3, 28, 29, 30 }) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string text = contiguous_encode<Mode, Padding>(bytes);
+
+        for (std::size_t i = 0; i <= size; i++) {
+            for (std::size_t j = i; j <= size; j++) {
+                std::string out;
+                auto it = std::back_inserter(out);
+                std::list<uint8_t> middle(bytes.begin() + i,
+                                          bytes.begin() + j);
+
+                it = encoder.update(std::span(bytes.data(), i), it);
+                it = encoder.update(middle, it);
+                it = encoder.update(
+                    std::span(bytes.data() + j, size - j), it);
+                encoder.finalize(it);
+
+                ASSERT_EQ(out, text) << size << " " << i << " " << j;
+            }
+        }
+
+        for (std::size_t i = 0; i <= text.size(); i++) {
+            for (std::size_t j = i; j <= text.size(); j++) {
+                std::vector<uint8_t> out;
+                auto it = std::back_inserter(out);
+                std::string_view view = text;
+                std::list<char> middle(text.begin() + i, text.begin() + j);
+
+                it = decoder.update(view.substr(0, i), it);
+                it = decoder.update(middle, it);
+                it = decoder.update(view.substr(j), it);
+                decoder.finalize(it);
+
+                ASSERT_EQ(out, bytes) << size << " " << i << " " << j;
+            }
+        }
+    }
+}
+
+// A character outside the alphabet of `mode`.
+char invalid_char(std::mt19937 &rng, base64_mode mode)
+{
+    const char common[] = { '!', '.', ':', '@', '[', '`', '{', ' ', '\n',
+                            '\0', '\x80', '\xFF' };
+    const char regular[] = { '-', '_' };
+    const char url[] = { '+', '/' };
+
+    if (rng() % 4) {
+        return common[rng() % std::size(common)];
+    }
+
+    return mode == base64_mode::regular ? regular[rng() % 2] : url[rng() % 2];
+}
+
+template <base64_mode Mode, base64_padding Padding>
+void check_encode()
+{
+    std::mt19937 rng(static_cast<int>(Mode));
+    bool pad = Padding != base64_padding::none;
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string expected = reference_encode(bytes, Mode, pad);
+
+        ASSERT_EQ((contiguous_encode<Mode, Padding>(bytes)), expected);
+        ASSERT_EQ((scalar_encode<Mode, Padding>(bytes)), expected);
+        ASSERT_EQ((nothing::base64_encode<Mode, Padding>(bytes)), expected);
+    }
+}
+
+template <base64_mode Mode, base64_padding Padding>
+void check_decode()
+{
+    std::mt19937 rng(static_cast<int>(Mode) * 3 + static_cast<int>(Padding));
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string padded = reference_encode(bytes, Mode, true);
+        std::string bare = reference_encode(bytes, Mode, false);
+
+        if (Padding == base64_padding::none && padded != bare) {
+            ASSERT_THROW((contiguous_decode<Mode, Padding>(padded)),
+                         std::invalid_argument);
+            ASSERT_THROW((scalar_decode<Mode, Padding>(padded)),
+                         std::invalid_argument);
+        } else {
+            ASSERT_EQ((contiguous_decode<Mode, Padding>(padded)), bytes);
+            ASSERT_EQ((scalar_decode<Mode, Padding>(padded)), bytes);
+        }
+
+        if (Padding == base64_padding::required && padded != bare) {
+            ASSERT_THROW((contiguous_decode<Mode, Padding>(bare)),
+                         std::invalid_argument);
+            ASSERT_THROW((scalar_decode<Mode, Padding>(bare)),
+                         std::invalid_argument);
+        } else {
+            ASSERT_EQ((contiguous_decode<Mode, Padding>(bare)), bytes);
+            ASSERT_EQ((scalar_decode<Mode, Padding>(bare)), bytes);
+        }
+
+        std::string &text = Padding == base64_padding::none ? bare : padded;
+
+        for (std::size_t pos = 0; pos < text.size(); pos++) {
+            std::string bad = text;
+            bad[pos] = invalid_char(rng, Mode);
+
+            ASSERT_THROW((contiguous_decode<Mode, Padding>(bad)),
+                         std::invalid_argument)
+                << "size " << size << " pos " << pos;
+            ASSERT_THROW((scalar_decode<Mode, Padding>(bad)),
+                         std::invalid_argument)
+                << "size " << size << " pos " << pos;
+        }
+    }
+}
+
+template <base64_mode Mode, base64_padding Padding>
+void check_error_position()
+{
+    std::mt19937 rng(static_cast<int>(Mode) * 3 + static_cast<int>(Padding));
+    bool pad = Padding != base64_padding::none;
+
+    for (std::size_t size = 0; size <= max_length / 2; size++) {
+        std::string text = reference_encode(random_bytes(rng, size), Mode, pad);
+
+        for (std::size_t pos = 0; pos <= text.size(); pos++) {
+            std::string bad = text;
+            std::errc ec{};
+
+            if (pos < text.size()) {
+                bad[pos] = invalid_char(rng, Mode);
+                ec = std::errc::invalid_argument;
+            }
+
+            // Whole groups before the bad character are written.
+            std::size_t written = ec == std::errc{} ? size : pos / 4 * 3;
+            std::vector<uint8_t> out(size);
+            auto res = nothing::base64_decode<Mode, Padding>(bad, out.data(),
+                                                             std::nothrow);
+
+            ASSERT_EQ(res.ec, ec) << "size " << size << " pos " << pos;
+            ASSERT_EQ(res.offset, pos);
+            ASSERT_EQ(res.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+            ASSERT_EQ(static_cast<std::size_t>(res.out - out.data()), written);
+
+            std::list<char> chars(bad.begin(), bad.end());
+            std::vector<uint8_t> scalar;
+            auto scalar_res = nothing::base64_decode<Mode, Padding>(
+                chars, std::back_inserter(scalar), std::nothrow);
+
+            ASSERT_EQ(scalar_res.ec, ec);
+            ASSERT_EQ(scalar_res.offset, pos);
+            ASSERT_EQ(std::distance(chars.begin(), scalar_res.in),
+                      static_cast<std::ptrdiff_t>(pos));
+            ASSERT_EQ(scalar.size(), written);
+
+            auto valid = nothing::base64_validate<Mode, Padding>(bad);
+
+            ASSERT_EQ(valid.ec, ec);
+            ASSERT_EQ(valid.offset, pos);
+            ASSERT_EQ(valid.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+
+            auto scalar_valid = nothing::base64_validate<Mode, Padding>(chars);
+
+            ASSERT_EQ(scalar_valid.ec, ec);
+            ASSERT_EQ(scalar_valid.offset, pos);
+        }
+    }
+}
+
+// Breaks `text` into lines of `width` characters, without a final newline.
+std::string wrap(const std::string &text, std::size_t width,
+                 std::string_view newline)
+{
+    std::string ret;
+
+    for (std::size_t i = 0; i < text.size(); i += width) {
+        if (i) {
+            ret += newline;
+        }
+
+        ret += text.substr(i, width);
+    }
+
+    return ret;
+}
+
+std::string contiguous_encode_wrapped(const std::vector<uint8_t> &bytes,
+                                      std::size_t width,
+                                      std::string_view newline)
+{
+    std::size_t size = nothing::base64_encoded_size(bytes.size());
+    std::size_t lines = width ? size / width + 1 : 1;
+    std::string ret(size + lines * newline.size(), '\0');
+    auto res = nothing::base64_encode_wrapped(bytes, ret.data(), width,
+                                              newline);
+    ret.resize(res.out - ret.data());
+    return ret;
+}
+
+std::string scalar_encode_wrapped(const std::vector<uint8_t> &bytes,
+                                  std::size_t width, std::string_view newline)
+{
+    std::list<uint8_t> src(bytes.begin(), bytes.end());
+    std::string ret;
+    nothing::base64_encode_wrapped(src, std::back_inserter(ret), width,
+                                   newline);
+    return ret;
+}
+
+auto contiguous_decode_wrapped(const std::string &src,
+                               std::vector<uint8_t> &out)
+{
+    out.assign(nothing::base64_decoded_size_max(src.size()), 0);
+    auto res = nothing::base64_decode_wrapped(src, out.data(), std::nothrow);
+    out.resize(res.out - out.data());
+    return res;
+}
+
+auto scalar_decode_wrapped(const std::string &src, std::vector<uint8_t> &out)
+{
+    std::list<char> chars(src.begin(), src.end());
+    out.clear();
+
+    auto res = nothing::base64_decode_wrapped(
+        chars, std::back_inserter(out), std::nothrow);
+
+    return nothing::decode_result<std::ptrdiff_t, std::size_t>{
+        { std::distance(chars.begin(), res.in), out.size() }, res.ec,
+        res.offset
+    };
+}
+
+// Output iterator that throws once `*limit` bytes have been written.
+struct throwing_output {
+    using difference_type = std::ptrdiff_t;
+
+    std::size_t *limit;
+
+    throwing_output &operator*() { return *this; }
+    throwing_output &operator++() { return *this; }
+    throwing_output operator++(int) { return *this; }
+
+    throwing_output &operator=(uint8_t)
+    {
+        if (!*limit) {
+            throw std::runtime_error("output full");
+        }
+
+        --*limit;
+        return *this;
+    }
+};
+
+} // namespace
+
+TEST(Base64, EncodeMatchesScalarOnEveryLength)
+{
+    check_encode<base64_mode::regular, base64_padding::optional>();
+    check_encode<base64_mode::regular, base64_padding::none>();
+    check_encode<base64_mode::url, base64_padding::optional>();
+    check_encode<base64_mode::url, base64_padding::none>();
+}
+
+TEST(Base64, EncodeRfc4648Vectors)
+{
+    const char *expected[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==",
+                               "Zm9vYmE=", "Zm9vYmFy" };
+    std::string_view text = "foobar";
+
+    for (std::size_t i = 0; i <= text.size(); i++) {
+        EXPECT_EQ(nothing::base64_encode(text.substr(0, i)), expected[i]);
+    }
+
+    // Every byte value, which hits the 62nd and 63rd characters.
+    std::vector<uint8_t> bytes(256);
+
+    for (int i = 0; i < 256; i++) {
+        bytes[i] = i;
+    }
+
+    EXPECT_EQ(nothing::base64_encode(bytes),
+              reference_encode(bytes, base64_mode::regular, true));
+    EXPECT_EQ(nothing::base64_encode<base64_mode::url>(bytes),
+              reference_encode(bytes, base64_mode::url, true));
+}
+
+TEST(Base64, DecodeRegularPaddingRequired)
+{
+    check_decode<base64_mode::regular, base64_padding::required>();
+}
+
+TEST(Base64, DecodeRegularPaddingOptional)
+{
+    check_decode<base64_mode::regular, base64_padding::optional>();
+}
+
+TEST(Base64, DecodeRegularPaddingNone)
+{
+    check_decode<base64_mode::regular, base64_padding::none>();
+}
+
+TEST(Base64, DecodeUrlPaddingRequired)
+{
+    check_decode<base64_mode::url, base64_padding::required>();
+}
+
+TEST(Base64, DecodeUrlPaddingOptional)
+{
+    check_decode<base64_mode::url, base64_padding::optional>();
+}
+
+TEST(Base64, DecodeUrlPaddingNone)
+{
+    check_decode<base64_mode::url, base64_padding::none>();
+}
+
+TEST(Base64, DecodeRejectsMalformedGroups)
+{
+    // A lone character, set bits past the last byte, too much padding and
+    // data after padding.
+    for (const char *text : { "Q", "QUJDR", "QR==", "QUJ=", "QUJDRA===",
+                              "QQ===", "QQ==QUJD", "=", "====" }) {
+        EXPECT_THROW(nothing::base64_decode(std::string_view(text)),
+                     std::invalid_argument)
+            << text;
+    }
+
+    EXPECT_EQ(nothing::base64_decode(std::string_view("QUJDRA==")), "ABCD");
+    EXPECT_EQ(nothing::base64_decode(std::string_view("QUJDRA")), "ABCD");
+    EXPECT_EQ(nothing::base64_decode(std::string_view("QUI=")), "AB");
+    EXPECT_EQ(nothing::base64_decode(std::string_view("")), "");
+}
+
+TEST(Base64, NothrowDecodeReportsErrorPosition)
+{
+    check_error_position<base64_mode::regular, base64_padding::required>();
+    check_error_position<base64_mode::regular, base64_padding::none>();
+    check_error_position<base64_mode::url, base64_padding::optional>();
+}
+
+TEST(Base64, ValidateLongInput)
+{
+    // Past the scratch block the validate-only mode decodes into.
+    std::mt19937 rng(7);
+    std::string text = reference_encode(random_bytes(rng, 3000),
+                                        base64_mode::regular, true);
+
+    EXPECT_EQ(nothing::base64_validate(text).ec, std::errc{});
+    EXPECT_EQ(nothing::base64_validate(text).offset, text.size());
+
+    for (std::size_t pos : { 0, 511, 512, 513, 1023, 2047, 3999 }) {
+        std::string bad = text;
+        bad[pos] = '*';
+
+        auto res = nothing::base64_validate(bad);
+
+        EXPECT_EQ(res.ec, std::errc::invalid_argument);
+        EXPECT_EQ(res.offset, pos);
+    }
+}
+
+TEST(Base64, NothrowReportsMissingPaddingAtEnd)
+{
+    std::string_view text = "QUJDRA";
+    std::vector<uint8_t> out(6);
+    auto res = nothing::base64_decode<base64_mode::regular,
+                                      base64_padding::required>(
+        text, out.data(), std::nothrow);
+
+    EXPECT_EQ(res.ec, std::errc::invalid_argument);
+    EXPECT_EQ(res.offset, text.size());
+    EXPECT_EQ(res.in, text.end());
+}
+
+TEST(Base64, DecodePropagatesOutputExceptions)
+{
+    std::string text = "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo=";
+    std::size_t limit = 5;
+
+    EXPECT_THROW(nothing::base64_decode(text, throwing_output{ &limit }),
+                 std::runtime_error);
+
+    limit = 5;
+    EXPECT_THROW(nothing::base64_decode(text, throwing_output{ &limit },
+                                        std::nothrow),
+                 std::runtime_error);
+
+    limit = 5;
+    EXPECT_THROW(
+        nothing::base64_decode_wrapped(text, throwing_output{ &limit }),
+        std::runtime_error);
+
+    limit = 5;
+    EXPECT_THROW(nothing::base64_decode_wrapped(
+                     text, throwing_output{ &limit }, std::nothrow),
+                 std::runtime_error);
+}
+
+TEST(Base64, ParallelMatchesSerial)
+{
+    check_parallel<base64_mode::regular, base64_padding::required>();
+    check_parallel<base64_mode::url, base64_padding::none>();
+}
+
+TEST(Base64, StreamingMatchesOneShotAtEverySplit)
+{
+    check_streaming<base64_mode::regular, base64_padding::required>();
+    check_streaming<base64_mode::regular, base64_padding::optional>();
+    check_streaming<base64_mode::url, base64_padding::none>();
+}
+
+TEST(Base64, StreamingRejectsDataAfterPadding)
+{
+    nothing::base64_decoder decoder;
+    std::vector<uint8_t> out;
+    auto it = std::back_inserter(out);
+
+    // In the same call as the padded group, in a later one, and left over
+    // for finalize().
+    EXPECT_THROW(decoder.update(std::string_view("QQ==QUJD"), it),
+                 std::invalid_argument);
+    decoder.reset();
+
+    decoder.update(std::string_view("QQ=="), it);
+    EXPECT_THROW(decoder.update(std::string_view("QUJD"), it),
+                 std::invalid_argument);
+    decoder.reset();
+
+    decoder.update(std::string_view("QQ=="), it);
+    decoder.update(std::string_view("QU"), it);
+    EXPECT_THROW(decoder.finalize(it), std::invalid_argument);
+
+    // A failed finalize() leaves the decoder reset.
+    out.clear();
+    decoder.update(std::string_view("QUJD"), it);
+    decoder.finalize(it);
+    EXPECT_EQ(out, (std::vector<uint8_t>{ 'A', 'B', 'C' }));
+
+    // So does a successful one, even after a padded group.
+    out.clear();
+    decoder.update(std::string_view("QQ=="), it);
+    decoder.finalize(it);
+    decoder.update(std::string_view("QUI="), it);
+    decoder.finalize(it);
+    EXPECT_EQ(out, (std::vector<uint8_t>{ 'A', 'A', 'B' }));
+}
+
+TEST(Base64, EncodeWrappedMatchesWrappedReference)
+{
+    std::mt19937 rng(11);
+
+    for (std::size_t size = 0; size <= max_length; size += 1 + size / 16) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string text = reference_encode(bytes, base64_mode::regular, true);
+
+        for (std::size_t width : { 0, 1, 4, 10, 64, 76 }) {
+            for (std::string_view newline : { "\r\n", "\n" }) {
+                std::string expected =
+                    width ? wrap(text, width, newline) : text;
+
+                ASSERT_EQ(contiguous_encode_wrapped(bytes, width, newline),
+                          expected)
+                    << "size " << size << " width " << width;
+                ASSERT_EQ(scalar_encode_wrapped(bytes, width, newline),
+                          expected)
+                    << "size " << size << " width " << width;
+            }
+        }
+    }
+}
+
+TEST(Base64, DecodeWrappedSkipsWhitespace)
+{
+    std::mt19937 rng(12);
+    const char space[] = { ' ', '\t', '\n', '\v', '\f', '\r' };
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string text = reference_encode(bytes, base64_mode::regular, true);
+        std::string mime = wrap(text, 76, "\r\n") + "\r\n";
+        std::string pem = wrap(text, 64, "\n");
+        std::string scattered;
+
+        for (char c : text) {
+            while (rng() % 8 == 0) {
+                scattered += space[rng() % std::size(space)];
+            }
+
+            scattered += c;
+        }
+
+        for (const std::string &src : { text, mime, pem, scattered }) {
+            std::vector<uint8_t> out;
+
+            ASSERT_EQ(contiguous_decode_wrapped(src, out).ec, std::errc{});
+            ASSERT_EQ(out, bytes);
+            ASSERT_EQ(scalar_decode_wrapped(src, out).ec, std::errc{});
+            ASSERT_EQ(out, bytes);
+        }
+    }
+}
+
+TEST(Base64, DecodeWrappedReportsErrorPosition)
+{
+    std::mt19937 rng(13);
+
+    for (std::size_t size = 1; size <= max_length / 2; size++) {
+        std::string text = wrap(
+            reference_encode(random_bytes(rng, size), base64_mode::regular,
+                             true),
+            16, "\r\n");
+
+        for (std::size_t pos = 0; pos < text.size(); pos++) {
+            std::string bad = text;
+            bad[pos] = "!-_.*\0"[rng() % 6];
+
+            std::vector<uint8_t> out;
+            auto res = contiguous_decode_wrapped(bad, out);
+            auto scalar_res = scalar_decode_wrapped(bad, out);
+
+            ASSERT_EQ(res.ec, std::errc::invalid_argument)
+                << "size " << size << " pos " << pos;
+            ASSERT_EQ(res.offset, pos);
+            ASSERT_EQ(res.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+            ASSERT_EQ(scalar_res.ec, std::errc::invalid_argument);
+            ASSERT_EQ(scalar_res.offset, pos);
+            ASSERT_EQ(scalar_res.in, static_cast<std::ptrdiff_t>(pos));
+            ASSERT_THROW(nothing::base64_decode_wrapped(
+                             bad, std::back_inserter(out)),
+                         std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/encoding.h>
+
+namespace {
+
+// Lengths on and around every vector width the kernels use.
+constexpr std::size_t max_length = 200;
+
+std::vector<uint8_t> random_bytes(std::mt19937 &rng, std::size_t size)
+{
+    std::vector<uint8_t> bytes(size);
+
+    for (uint8_t &byte : bytes) {
+        byte = rng();
+    }
+
+    return bytes;
+}
+
+std::string reference_encode(const std::vector<uint8_t> &bytes, bool upper)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    std::string ret;
+
+    for (uint8_t byte : bytes) {
+        ret += digits[byte >> 4];
+        ret += digits[byte & 15];
+    }
+
+    return ret;
+}
+
+// Contiguous input and output take the vector kernels; a list and a back
+// inserter take the scalar loop.
+template <nothing::hex_mode Mode>
+std::string contiguous_encode(const std::vector<uint8_t> &bytes)
+{
+    std::string ret(nothing::hex_encoded_size(bytes.size()), '\0');
+    nothing::hex_encode<Mode>(bytes, ret.data());
+    return ret;
+}
+
+template <nothing::hex_mode Mode>
+std::string scalar_encode(const std::vector<uint8_t> &bytes)
+{
+    std::list<uint8_t> src(bytes.begin(), bytes.end());
+    std::string ret;
+    nothing::hex_encode<Mode>(src, std::back_inserter(ret));
+    return ret;
+}
+
+std::vector<uint8_t> contiguous_decode(const std::string &src)
+{
+    std::vector<uint8_t> ret(nothing::hex_decoded_size(src.size()));
+    auto res = nothing::hex_decode(src, ret.data());
+    ret.resize(res.out - ret.data());
+    return ret;
+}
+
+std::vector<uint8_t> scalar_decode(const std::string &src)
+{
+    std::list<char> chars(src.begin(), src.end());
+    std::vector<uint8_t> ret;
+    nothing::hex_decode(chars, std::back_inserter(ret));
+    return ret;
+}
+
+// Output iterator that throws once `*limit` bytes have been written.
+struct throwing_output {
+    using difference_type = std::ptrdiff_t;
+
+    std::size_t *limit;
+
+    throwing_output &operator*() { return *this; }
+    throwing_output &operator++() { return *this; }
+    throwing_output operator++(int) { return *this; }
+
+    throwing_output &operator=(uint8_t)
+    {
+        if (!*limit) {
+            throw std::runtime_error("output full");
+        }
+
+        --*limit;
+        return *this;
+    }
+};
+
+} // namespace
+
+TEST(Hex, EncodeMatchesScalarOnEveryLength)
+{
+    std::mt19937 rng(1);
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string upper = reference_encode(bytes, true);
+        std::string lower = reference_encode(bytes, false);
+
+        ASSERT_EQ(contiguous_encode<nothing::hex_mode::upper>(bytes), upper);
+        ASSERT_EQ(scalar_encode<nothing::hex_mode::upper>(bytes), upper);
+        ASSERT_EQ(contiguous_encode<nothing::hex_mode::lower>(bytes), lower);
+        ASSERT_EQ(scalar_encode<nothing::hex_mode::lower>(bytes), lower);
+    }
+}
+
+TEST(Hex, DecodeMatchesScalarOnEveryLength)
+{
+    std::mt19937 rng(2);
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string text = reference_encode(bytes, rng() % 2);
+
+        // Mix the cases; decoding accepts either.
+        for (char &c : text) {
+            if (rng() % 2) {
+                c = ascii_tolower(c);
+            }
+        }
+
+        ASSERT_EQ(contiguous_decode(text), bytes);
+        ASSERT_EQ(scalar_decode(text), bytes);
+
+        // An odd final digit is the high nibble of one more byte.
+        text += 'A';
+        bytes.push_back(0xA0);
+
+        ASSERT_EQ(contiguous_decode(text), bytes);
+        ASSERT_EQ(scalar_decode(text), bytes);
+    }
+}
+
+TEST(Hex, DecodeRejectsInvalidCharacterAtEveryPosition)
+{
+    std::mt19937 rng(3);
+    const char invalid[] = { 'g', 'G', '/', ':', '@', '`', ' ', '\0', '\x80',
+                             '\xFF' };
+
+    for (std::size_t size = 1; size <= 2 * max_length / 3; size++) {
+        std::string text = reference_encode(random_bytes(rng, size), true);
+
+        for (std::size_t pos = 0; pos < text.size(); pos++) {
+            std::string bad = text;
+            bad[pos] = invalid[rng() % std::size(invalid)];
+
+            ASSERT_THROW(contiguous_decode(bad), std::invalid_argument)
+                << "size " << size << " pos " << pos;
+            ASSERT_THROW(scalar_decode(bad), std::invalid_argument)
+                << "size " << size << " pos " << pos;
+        }
+    }
+}
+
+TEST(Hex, NothrowDecodeReportsErrorPosition)
+{
+    std::mt19937 rng(5);
+
+    for (std::size_t size = 0; size <= max_length / 2; size++) {
+        std::string text = reference_encode(random_bytes(rng, size), true);
+
+        for (std::size_t pos = 0; pos <= text.size(); pos++) {
+            std::string bad = text;
+            std::errc ec{};
+
+            if (pos < text.size()) {
+                bad[pos] = 'x';
+                ec = std::errc::invalid_argument;
+            }
+
+            // Whole bytes before the bad character are written.
+            std::size_t written = pos / 2;
+            std::vector<uint8_t> out(size);
+            auto res = nothing::hex_decode(bad, out.data(), std::nothrow);
+
+            ASSERT_EQ(res.ec, ec) << "size " << size << " pos " << pos;
+            ASSERT_EQ(res.offset, pos);
+            ASSERT_EQ(res.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+            ASSERT_EQ(static_cast<std::size_t>(res.out - out.data()), written);
+
+            std::list<char> chars(bad.begin(), bad.end());
+            std::vector<uint8_t> scalar;
+            auto scalar_res = nothing::hex_decode(
+                chars, std::back_inserter(scalar), std::nothrow);
+
+            ASSERT_EQ(scalar_res.ec, ec);
+            ASSERT_EQ(scalar_res.offset, pos);
+            ASSERT_EQ(std::distance(chars.begin(), scalar_res.in),
+                      static_cast<std::ptrdiff_t>(pos));
+            ASSERT_EQ(scalar.size(), written);
+
+            auto valid = nothing::hex_validate(bad);
+
+            ASSERT_EQ(valid.ec, ec);
+            ASSERT_EQ(valid.offset, pos);
+            ASSERT_EQ(valid.in - bad.begin(), static_cast<std::ptrdiff_t>(pos));
+
+            auto scalar_valid = nothing::hex_validate(chars);
+
+            ASSERT_EQ(scalar_valid.ec, ec);
+            ASSERT_EQ(scalar_valid.offset, pos);
+        }
+    }
+}
+
+TEST(Hex, DecodePropagatesOutputExceptions)
+{
+    std::string text = "00112233445566778899AABBCCDDEEFF";
+    std::size_t limit = 0;
+
+    static_assert(!noexcept(nothing::hex_decode(
+        text, throwing_output{ &limit }, std::nothrow)));
+    static_assert(noexcept(
+        nothing::hex_decode(text, (uint8_t *)nullptr, std::nothrow)));
+
+    limit = 3;
+    EXPECT_THROW(nothing::hex_decode(text, throwing_output{ &limit }),
+                 std::runtime_error);
+
+    limit = 3;
+    EXPECT_THROW(nothing::hex_decode(text, throwing_output{ &limit },
+                                     std::nothrow),
+                 std::runtime_error);
+}
+
+// Three chunks, each above the minimum a thread is given.
+TEST(Hex, ParallelMatchesSerial)
+{
+    std::mt19937 rng(6);
+    nothing::parallel_policy policy{ 3 };
+    std::size_t size = 3 * nothing::detail::parallel_min_chunk + 1;
+    std::vector<uint8_t> bytes = random_bytes(rng, size);
+    std::string text(nothing::hex_encoded_size(size), '\0');
+    auto encoded = nothing::hex_encode(policy, bytes, text.data());
+
+    ASSERT_EQ(text, contiguous_encode<nothing::hex_mode::upper>(bytes));
+    ASSERT_EQ(encoded.out, text.data() + text.size());
+
+    // An odd final digit is the high nibble of one more byte.
+    text += 'A';
+
+    std::vector<uint8_t> out(nothing::hex_decoded_size(text.size()));
+    auto decoded = nothing::hex_decode(policy, text, out.data());
+
+    ASSERT_EQ(out, contiguous_decode(text));
+    ASSERT_EQ(decoded.out, out.data() + out.size());
+
+    // A bad character in the first chunk.
+    text[1001] = 'x';
+
+    EXPECT_THROW(nothing::hex_decode(policy, text, out.data()),
+                 std::invalid_argument);
+}
+
+// Feeds the input in three pieces split at every pair of offsets, through
+// contiguous ranges and through lists, and compares with the one-shot
+// functions. The same objects are reused throughout.
+TEST(Hex, StreamingMatchesOneShotAtEverySplit)
+{
+    std::mt19937 rng(7);
+    std::vector<uint8_t> bytes = random_bytes(rng, 37);
+    std::string text = contiguous_encode<nothing::hex_mode::lower>(bytes);
+    nothing::hex_encoder<nothing::hex_mode::lower> encoder;
+    nothing::hex_decoder decoder;
+
+    // An odd final digit is the high nibble of one more byte.
+    std::string odd = text + "a";
+    std::vector<uint8_t> odd_bytes = contiguous_decode(odd);
+
+    for (std::size_t i = 0; i <= bytes.size(); i++) {
+        for (std::size_t j = i; j <= bytes.size(); j++) {
+            std::string out;
+            auto it = std::back_inserter(out);
+            std::list<uint8_t> middle(bytes.begin() + i, bytes.begin() + j);
+
+            it = encoder.update(std::span(bytes.data(), i), it);
+            it = encoder.update(middle, it);
+            it = encoder.update(
+                std::span(bytes.data() + j, bytes.size() - j), it);
+            encoder.finalize(it);
+
+            ASSERT_EQ(out, text) << i << " " << j;
+        }
+    }
+
+    for (std::size_t i = 0; i <= odd.size(); i++) {
+        for (std::size_t j = i; j <= odd.size(); j++) {
+            std::vector<uint8_t> out;
+            auto it = std::back_inserter(out);
+            std::string_view view = odd;
+            std::list<char> middle(odd.begin() + i, odd.begin() + j);
+
+            it = decoder.update(view.substr(0, i), it);
+            it = decoder.update(middle, it);
+            it = decoder.update(view.substr(j), it);
+            decoder.finalize(it);
+
+            ASSERT_EQ(out, odd_bytes) << i << " " << j;
+        }
+    }
+}
+
+TEST(Hex, StreamingDecoderResetsAfterError)
+{
+    nothing::hex_decoder decoder;
+    std::vector<uint8_t> out;
+
+    EXPECT_THROW(decoder.update(std::string_view("0g"),
+                                std::back_inserter(out)),
+                 std::invalid_argument);
+
+    out.clear();
+    decoder.update(std::string_view("0"), std::back_inserter(out));
+    decoder.finalize(std::back_inserter(out));
+    EXPECT_EQ(out, std::vector<uint8_t>{ 0x00 });
+
+    // The half digit was flushed by finalize(), not carried over.
+    out.clear();
+    decoder.update(std::string_view("1f"), std::back_inserter(out));
+    decoder.finalize(std::back_inserter(out));
+    EXPECT_EQ(out, std::vector<uint8_t>{ 0x1F });
+}
+
+TEST(Hex, StringOverloadsRoundTrip)
+{
+    std::mt19937 rng(4);
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::vector<uint8_t> bytes = random_bytes(rng, size);
+        std::string text = nothing::hex_encode(bytes);
+        std::string back = nothing::hex_decode(text);
+
+        ASSERT_EQ(text, reference_encode(bytes, true));
+        ASSERT_EQ(std::vector<uint8_t>(back.begin(), back.end()), bytes);
+    }
+
+    EXPECT_THROW(nothing::hex_decode(std::string_view("0x")),
+                 std::invalid_argument);
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/intrusive_list.h>
+
+namespace {
+
+template <bool AutoUnlink>
+struct basic_node : nothing::intrusive_list_member<void, AutoUnlink> {
+    int key;
+    int id;
+};
+
+using node = basic_node<true>;
+using tracked_node = basic_node<false>;
+
+using tracked_list = nothing::intrusive_list<
+    tracked_node, void, nothing::intrusive_list_tracked_size>;
+
+template <class Policy>
+using node_for = basic_node<
+    !std::same_as<Policy, nothing::intrusive_list_tracked_size>>;
+
+bool key_less(const tracked_node &lh, const tracked_node &rh)
+{
+    return lh.key < rh.key;
+}
+
+template <class List>
+std::vector<int> ids(const List &list)
+{
+    std::vector<int> ret;
+
+    for (const auto &n : list) {
+        ret.push_back(n.id);
+    }
+
+    return ret;
+}
+
+template <class Policy>
+void check_splice_and_swap()
+{
+    using node_type = node_for<Policy>;
+    using list_type = nothing::intrusive_list<node_type, void, Policy>;
+
+    std::mt19937 rng(1);
+    std::vector<node_type> nodes(200);
+    list_type lists[3];
+    std::list<int> refs[3];
+
+    for (int i = 0; i < 200; i++) {
+        nodes[i].id = i;
+        lists[i % 3].push_back(nodes[i]);
+        refs[i % 3].push_back(i);
+    }
+
+    auto at = [](auto &list, int n) { return std::next(list.begin(), n); };
+
+    for (int round = 0; round < 20000; round++) {
+        int a = rng() % 3;
+        int b = rng() % 3;
+        int n = refs[b].size();
+        int pos = rng() % (refs[a].size() + 1);
+        int first = rng() % (n + 1);
+        int last = rng() % (n + 1);
+
+        if (first > last) {
+            std::swap(first, last);
+        }
+
+        switch (rng() % 4) {
+        case 0:
+            if (a != b) {
+                lists[a].splice(at(lists[a], pos), lists[b]);
+                refs[a].splice(at(refs[a], pos), refs[b]);
+            }
+            break;
+        case 1:
+            // Within one list, `pos` must lie outside `[first, last)`.
+            if (a == b && pos >= first && pos < last) {
+                break;
+            }
+
+            lists[a].splice(at(lists[a], pos), lists[b], at(lists[b], first),
+                            at(lists[b], last));
+            refs[a].splice(at(refs[a], pos), refs[b], at(refs[b], first),
+                           at(refs[b], last));
+            break;
+        case 2:
+            if (first < n) {
+                lists[a].splice(at(lists[a], pos), lists[b],
+                                at(lists[b], first));
+                refs[a].splice(at(refs[a], pos), refs[b], at(refs[b], first));
+            }
+            break;
+        default:
+            lists[a].swap(lists[b]);
+            refs[a].swap(refs[b]);
+            break;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            ASSERT_EQ(ids(lists[k]),
+                      std::vector<int>(refs[k].begin(), refs[k].end()));
+            ASSERT_EQ(lists[k].count(), refs[k].size());
+
+            if constexpr (std::same_as<Policy,
+                                       nothing::intrusive_list_tracked_size>) {
+                ASSERT_EQ(lists[k].size(), refs[k].size());
+            }
+        }
+    }
+}
+
+// A tracked size cannot follow elements that unlink themselves, so tracked
+// lists only take hooks that do not.
+template <class T, class Policy>
+concept list_of =
+    requires { typename nothing::intrusive_list<T, void, Policy>; };
+
+static_assert(list_of<node, nothing::intrusive_list_untracked_size>);
+static_assert(list_of<tracked_node, nothing::intrusive_list_tracked_size>);
+static_assert(!list_of<node, nothing::intrusive_list_tracked_size>);
+
+} // namespace
+
+TEST(IntrusiveList, SpliceAndSwapUntracked)
+{
+    check_splice_and_swap<nothing::intrusive_list_untracked_size>();
+}
+
+TEST(IntrusiveList, SpliceAndSwapTracked)
+{
+    check_splice_and_swap<nothing::intrusive_list_tracked_size>();
+}
+
+TEST(IntrusiveList, SortMergeUniqueMatchStdList)
+{
+    std::mt19937 rng(3);
+
+    // The reference holds (key, id) pairs, comparing keys only.
+    auto pair_less = [](auto &lh, auto &rh) { return lh.first < rh.first; };
+    auto same_pair = [](auto &lh, auto &rh) { return lh.first == rh.first; };
+    auto same_key = [](const tracked_node &lh, const tracked_node &rh) {
+        return lh.key == rh.key;
+    };
+
+    auto expect_ids = [](const tracked_list &list, const auto &ref) {
+        std::vector<int> ref_ids;
+
+        for (auto &[key, id] : ref) {
+            ref_ids.push_back(id);
+        }
+
+        ASSERT_EQ(ids(list), ref_ids);
+        ASSERT_EQ(list.size(), ref.size());
+    };
+
+    for (int n : { 0, 1, 2, 3, 5, 17, 64, 100, 1000, 4097 }) {
+        int m = rng() % 300;
+        std::vector<tracked_node> nodes(n + m);
+        tracked_list list;
+        tracked_list other;
+        std::list<std::pair<int, int>> ref;
+        std::list<std::pair<int, int>> other_ref;
+
+        for (int i = 0; i < n + m; i++) {
+            nodes[i].key = rng() % 50;
+            nodes[i].id = i;
+            (i < n ? list : other).push_back(nodes[i]);
+            (i < n ? ref : other_ref).emplace_back(nodes[i].key, i);
+        }
+
+        list.sort(key_less);
+        ref.sort(pair_less);
+        expect_ids(list, ref);
+
+        other.sort(key_less);
+        other_ref.sort(pair_less);
+        list.merge(other, key_less);
+        ref.merge(other_ref, pair_less);
+
+        ASSERT_TRUE(other.empty());
+        ASSERT_EQ(other.size(), 0u);
+        expect_ids(list, ref);
+
+        ASSERT_EQ(list.unique(same_key), ref.unique(same_pair));
+        expect_ids(list, ref);
+
+        ASSERT_EQ(list.remove_if([](const tracked_node &n) { return n.key % 3 == 0; }),
+                  ref.remove_if([](auto &p) { return p.first % 3 == 0; }));
+        expect_ids(list, ref);
+    }
+}
+
+TEST(IntrusiveList, SortKeepsListWhenCompareThrows)
+{
+    std::mt19937 rng(9);
+    std::vector<tracked_node> nodes(1000);
+    tracked_list list;
+
+    for (int i = 0; i < 1000; i++) {
+        nodes[i].key = rng() % 100;
+        nodes[i].id = i;
+        list.push_back(nodes[i]);
+    }
+
+    int calls = 0;
+    auto throwing = [&](const tracked_node &lh, const tracked_node &rh) {
+        if (++calls == 5000) {
+            throw std::runtime_error("compare");
+        }
+
+        return lh.key < rh.key;
+    };
+
+    EXPECT_THROW(list.sort(throwing), std::runtime_error);
+
+    std::vector<int> after = ids(list);
+    std::sort(after.begin(), after.end());
+
+    EXPECT_EQ(list.size(), 1000u);
+    EXPECT_EQ(list.count(), 1000u);
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(after[i], i);
+    }
+
+    std::size_t backward = 0;
+
+    for (auto it = list.end(); it != list.begin(); --it) {
+        backward++;
+    }
+
+    EXPECT_EQ(backward, 1000u);
+}
+
+TEST(IntrusiveList, DestroyingLinkedElements)
+{
+    {
+        nothing::intrusive_list<node, void> list;
+        node a, c;
+        list.push_back(a);
+
+        {
+            node b;
+            list.push_back(b);
+            list.push_back(c);
+            EXPECT_EQ(list.count(), 3u);
+        }
+
+        EXPECT_EQ(list.count(), 2u);
+        EXPECT_EQ(&list.back(), &c);
+    }
+
+    std::vector<tracked_node> nodes(10);
+
+    {
+        tracked_list list;
+
+        for (tracked_node &n : nodes) {
+            list.push_back(n);
+        }
+
+        // A copy of a linked element is not in the list.
+        tracked_node copy = nodes[0];
+        copy = nodes[1];
+        EXPECT_EQ(list.size(), 10u);
+        EXPECT_EQ(list.count(), 10u);
+
+        tracked_list other;
+        other.push_back(copy);
+        other.pop_back();
+    }
+
+    // Destroying the list unlinked its elements, so they can join another.
+    tracked_list list;
+
+    for (tracked_node &n : nodes) {
+        list.push_back(n);
+    }
+
+    EXPECT_EQ(list.size(), 10u);
+    EXPECT_EQ(list.count(), 10u);
+}
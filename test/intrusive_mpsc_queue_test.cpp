@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/intrusive_mpsc_queue.h>
+
+namespace {
+
+struct node : nothing::intrusive_slist_member<void> {
+    int producer;
+    int seq;
+};
+
+using node_queue = nothing::intrusive_mpsc_queue<node, void>;
+
+} // namespace
+
+TEST(IntrusiveMpscQueue, SingleThreadFifo)
+{
+    std::vector<node> nodes(100);
+    node_queue queue;
+
+    EXPECT_EQ(queue.pop(), nullptr);
+    EXPECT_TRUE(queue.pop_batch().empty());
+
+    // Nodes are reused once taken.
+    for (int round = 0; round < 3; round++) {
+        for (node &n : nodes) {
+            queue.push(n);
+        }
+
+        for (int i = 0; i < 50; i++) {
+            ASSERT_EQ(queue.pop(), &nodes[i]);
+        }
+
+        auto batch = queue.pop_batch(30);
+        int i = 50;
+
+        for (node &n : batch) {
+            ASSERT_EQ(&n, &nodes[i++]);
+        }
+
+        ASSERT_EQ(i, 80);
+
+        batch.clear();
+        batch = queue.pop_batch();
+
+        for (node &n : batch) {
+            ASSERT_EQ(&n, &nodes[i++]);
+        }
+
+        ASSERT_EQ(i, 100);
+        ASSERT_EQ(queue.pop(), nullptr);
+
+        batch.clear();
+    }
+}
+
+TEST(IntrusiveMpscQueue, ProducersStayInOrder)
+{
+    constexpr int producers = 4;
+    constexpr int per_producer = 100000;
+
+    std::vector<node> nodes(producers * per_producer);
+    std::vector<std::thread> threads;
+    node_queue queue;
+
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; i++) {
+                node &n = nodes[p * per_producer + i];
+                n.producer = p;
+                n.seq = i;
+                queue.push(n);
+            }
+        });
+    }
+
+    // Mixes single pops with batches of varying size; each producer's
+    // elements must arrive in the order it pushed them.
+    std::vector<int> last(producers, -1);
+    int taken = 0;
+
+    auto take = [&](const node &n) {
+        ASSERT_EQ(n.seq, last[n.producer] + 1);
+        last[n.producer] = n.seq;
+        taken++;
+    };
+
+    while (taken < producers * per_producer && !HasFatalFailure()) {
+        if (taken % 5 == 3) {
+            if (node *n = queue.pop()) {
+                take(*n);
+            }
+
+            continue;
+        }
+
+        auto batch = queue.pop_batch(1 + taken % 97);
+
+        for (const node &n : batch) {
+            take(n);
+        }
+
+        batch.clear();
+    }
+
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(queue.pop(), nullptr);
+
+    for (int p = 0; p < producers; p++) {
+        EXPECT_EQ(last[p], per_producer - 1);
+    }
+}
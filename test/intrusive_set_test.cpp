@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/intrusive_set.h>
+
+namespace {
+
+struct by_key_tag;
+struct by_deadline_tag;
+
+struct node : nothing::intrusive_set_member<by_key_tag>,
+              nothing::intrusive_set_member<by_deadline_tag> {
+    int key = 0;
+    int deadline = 0;
+    int id = 0;
+};
+
+struct by_key {
+    bool operator()(const node &lh, const node &rh) const
+    {
+        return lh.key < rh.key;
+    }
+
+    bool operator()(const node &lh, int rh) const { return lh.key < rh; }
+    bool operator()(int lh, const node &rh) const { return lh < rh.key; }
+};
+
+struct by_deadline {
+    bool operator()(const node &lh, const node &rh) const
+    {
+        return lh.deadline < rh.deadline;
+    }
+
+    bool operator()(const node &lh, int rh) const { return lh.deadline < rh; }
+    bool operator()(int lh, const node &rh) const { return lh < rh.deadline; }
+};
+
+using key_set = nothing::intrusive_set<node, by_key_tag, by_key>;
+using deadline_set =
+    nothing::intrusive_multiset<node, by_deadline_tag, by_deadline>;
+
+std::vector<int> keys(const key_set &set)
+{
+    std::vector<int> ret;
+
+    for (const node &n : set) {
+        ret.push_back(n.key);
+    }
+
+    return ret;
+}
+
+std::vector<std::pair<int, int>> deadlines(const deadline_set &set)
+{
+    std::vector<std::pair<int, int>> ret;
+
+    for (const node &n : set) {
+        ret.emplace_back(n.deadline, n.id);
+    }
+
+    return ret;
+}
+
+} // namespace
+
+TEST(IntrusiveSet, MatchesStdSetAndMultiset)
+{
+    std::mt19937 rng(5);
+    std::vector<std::optional<node>> nodes(2000);
+    key_set set;
+    deadline_set multiset;
+    std::set<int> set_ref;
+    std::multiset<std::pair<int, int>> multiset_ref;
+
+    for (int round = 0; round < 40000; round++) {
+        int i = rng() % nodes.size();
+
+        if (!nodes[i]) {
+            node &n = nodes[i].emplace();
+            n.key = rng() % 4000;
+            n.deadline = rng() % 100;
+            n.id = i;
+
+            auto [it, inserted] = set.insert(n);
+
+            ASSERT_EQ(inserted, !set_ref.contains(n.key));
+            ASSERT_EQ(it->key, n.key);
+
+            if (inserted) {
+                set_ref.insert(n.key);
+            }
+
+            multiset.insert(n);
+            multiset_ref.emplace(n.deadline, i);
+        } else if (rng() % 2) {
+            // Destruction unlinks from both trees.
+            auto it = set.find(nodes[i]->key);
+
+            if (it != set.end() && &*it == &*nodes[i]) {
+                set_ref.erase(nodes[i]->key);
+            }
+
+            multiset_ref.erase({ nodes[i]->deadline, i });
+            nodes[i].reset();
+        } else {
+            // Erase by reference and reinsert behind equal deadlines.
+            multiset.erase(*nodes[i]);
+            multiset_ref.erase({ nodes[i]->deadline, i });
+            nodes[i]->deadline = rng() % 100;
+            multiset.insert(*nodes[i]);
+            multiset_ref.emplace(nodes[i]->deadline, i);
+        }
+
+        if (round % 1000) {
+            continue;
+        }
+
+        ASSERT_EQ(set.size(), set_ref.size());
+        ASSERT_EQ(keys(set), std::vector<int>(set_ref.begin(), set_ref.end()));
+        ASSERT_EQ(multiset.size(), multiset_ref.size());
+
+        for (int q = 0; q < 50; q++) {
+            int key = rng() % 4100;
+            auto it = set.lower_bound(key);
+            auto ref = set_ref.lower_bound(key);
+
+            ASSERT_EQ(it == set.end(), ref == set_ref.end());
+
+            if (ref != set_ref.end()) {
+                ASSERT_EQ(it->key, *ref);
+            }
+
+            ASSERT_EQ(set.contains(key), set_ref.contains(key));
+
+            int deadline = rng() % 101;
+            auto first = multiset_ref.lower_bound({ deadline, -1 });
+            auto last = multiset_ref.lower_bound({ deadline + 1, -1 });
+
+            ASSERT_EQ(multiset.count(deadline),
+                      static_cast<std::size_t>(std::distance(first, last)));
+        }
+    }
+
+    std::vector<int> reversed;
+
+    for (auto it = set.rbegin(); it != set.rend(); ++it) {
+        reversed.push_back(it->key);
+    }
+
+    EXPECT_TRUE(std::equal(reversed.begin(), reversed.end(),
+                           set_ref.rbegin(), set_ref.rend()));
+
+    set.clear();
+    multiset.erase(multiset.begin(), multiset.end());
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(multiset.empty());
+}
+
+TEST(IntrusiveSet, MultisetKeepsInsertionOrderOfEqualKeys)
+{
+    std::vector<node> nodes(12);
+    deadline_set multiset;
+    std::vector<std::pair<int, int>> expected;
+
+    for (int i = 0; i < 12; i++) {
+        nodes[i].deadline = i % 3;
+        nodes[i].id = i;
+        multiset.insert(nodes[i]);
+        expected.emplace_back(i % 3, i);
+    }
+
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](auto &lh, auto &rh) { return lh.first < rh.first; });
+
+    EXPECT_EQ(deadlines(multiset), expected);
+
+    auto [first, last] = multiset.equal_range(1);
+
+    EXPECT_EQ(std::distance(first, last), 4);
+    EXPECT_EQ(first->id, 1);
+}
+
+TEST(IntrusiveSet, MoveAndSwap)
+{
+    std::vector<node> nodes(100);
+    key_set set;
+
+    for (int i = 0; i < 100; i++) {
+        nodes[i].key = 99 - i;
+        set.insert(nodes[i]);
+    }
+
+    std::vector<int> expected = keys(set);
+    key_set moved(std::move(set));
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+    EXPECT_EQ(keys(moved), expected);
+
+    set.swap(moved);
+
+    EXPECT_TRUE(moved.empty());
+    EXPECT_EQ(keys(set), expected);
+}
+
+TEST(IntrusiveSet, NodeOutlivesTree)
+{
+    node n;
+    n.key = 1;
+
+    {
+        key_set set;
+        set.insert(n);
+    }
+
+    node moved = std::move(n);
+    key_set set;
+
+    EXPECT_TRUE(set.insert(moved).second);
+    EXPECT_FALSE(set.insert(n).second);
+}
+
+// A moved node takes the place of its source in both trees, wherever it sits
+// in them: root, extremes or inner nodes.
+TEST(IntrusiveSet, MovedNodeTakesPlace)
+{
+    std::mt19937 rng(6);
+    std::vector<std::optional<node>> nodes(64);
+    std::vector<std::optional<node>> spare(64);
+    std::vector<bool> in_spare(64);
+    key_set set;
+    deadline_set multiset;
+
+    for (int i = 0; i < 64; i++) {
+        node &n = nodes[i].emplace();
+        n.key = i;
+        n.deadline = i % 4;
+        n.id = i;
+        set.insert(n);
+        multiset.insert(n);
+        spare[i].emplace();
+    }
+
+    std::vector<std::pair<int, int>> expected = deadlines(multiset);
+
+    for (int round = 0; round < 500; round++) {
+        int i = rng() % 64;
+        node &from = *(in_spare[i] ? spare[i] : nodes[i]);
+        auto &to = in_spare[i] ? nodes[i] : spare[i];
+
+        // The target is always unlinked: the source's last move left it so.
+        if (rng() % 2) {
+            *to = std::move(from);
+        } else {
+            to.emplace(std::move(from));
+        }
+
+        in_spare[i] = !in_spare[i];
+
+        ASSERT_EQ(set.size(), 64u);
+        ASSERT_EQ(&*set.find(i), &*to);
+        ASSERT_EQ(deadlines(multiset), expected);
+
+        int k = 63;
+
+        for (auto it = set.rbegin(); it != set.rend(); ++it, --k) {
+            ASSERT_EQ(it->key, k);
+        }
+    }
+
+    // Assigning over a linked node unlinks it first.
+    node &lh = *(in_spare[3] ? spare[3] : nodes[3]);
+    node &rh = *(in_spare[5] ? spare[5] : nodes[5]);
+
+    lh = std::move(rh);
+
+    EXPECT_EQ(set.size(), 63u);
+    EXPECT_EQ(multiset.size(), 63u);
+    EXPECT_EQ(&*set.find(5), &lh);
+    EXPECT_FALSE(set.contains(3));
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <forward_list>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/intrusive_slist.h>
+
+namespace {
+
+struct node : nothing::intrusive_slist_member<void> {
+    int id = 0;
+};
+
+using node_list = nothing::intrusive_slist<node, void>;
+
+std::vector<int> ids(const node_list &list)
+{
+    std::vector<int> ret;
+
+    for (const node &n : list) {
+        ret.push_back(n.id);
+    }
+
+    return ret;
+}
+
+} // namespace
+
+// Random operations on two lists, mirrored on std::forward_list. Erased and
+// cleared nodes go back to a pool and are linked again later.
+TEST(IntrusiveSlist, MatchesForwardList)
+{
+    std::mt19937 rng(1);
+    std::vector<node> nodes(100);
+    std::vector<int> unlinked;
+    node_list lists[2];
+    std::forward_list<int> refs[2];
+
+    for (int i = 0; i < 100; i++) {
+        nodes[i].id = i;
+        unlinked.push_back(i);
+    }
+
+    auto take = [&] {
+        std::swap(unlinked[rng() % unlinked.size()], unlinked.back());
+        int id = unlinked.back();
+        unlinked.pop_back();
+        return id;
+    };
+
+    for (int round = 0; round < 20000; round++) {
+        int a = rng() % 2;
+        node_list &list = lists[a];
+        std::forward_list<int> &ref = refs[a];
+        int n = std::distance(ref.begin(), ref.end());
+        int pos = rng() % (n + 1);
+        int last = pos + rng() % (n - pos + 1);
+
+        switch (rng() % 7) {
+        case 0:
+        case 1:
+            if (!unlinked.empty()) {
+                int id = take();
+                list.push_front(nodes[id]);
+                ref.push_front(id);
+            }
+            break;
+        case 2:
+            if (n) {
+                unlinked.push_back(ref.front());
+                list.pop_front();
+                ref.pop_front();
+            }
+            break;
+        case 3:
+            if (!unlinked.empty()) {
+                int id = take();
+                auto it = list.insert_after(
+                    std::next(list.before_begin(), pos), nodes[id]);
+                ref.insert_after(std::next(ref.before_begin(), pos), id);
+
+                ASSERT_EQ(&*it, &nodes[id]);
+            }
+            break;
+        case 4:
+            if (pos < n) {
+                auto ref_pos = std::next(ref.before_begin(), pos);
+                unlinked.push_back(*std::next(ref_pos));
+
+                auto it =
+                    list.erase_after(std::next(list.before_begin(), pos));
+                auto ref_it = ref.erase_after(ref_pos);
+
+                ASSERT_EQ(it == list.end(), ref_it == ref.end());
+            }
+            break;
+        case 5: {
+            // Erases `(pos, last]`, so the range ends one past the element
+            // at `last`.
+            auto ref_first = std::next(ref.before_begin(), pos);
+            auto ref_last = std::next(ref.before_begin(), last + 1);
+
+            for (auto it = std::next(ref_first); it != ref_last; ++it) {
+                unlinked.push_back(*it);
+            }
+
+            auto it = list.erase_after(std::next(list.before_begin(), pos),
+                                       std::next(list.before_begin(),
+                                                 last + 1));
+            ref.erase_after(ref_first, ref_last);
+
+            ASSERT_EQ(it == list.end(), ref_last == ref.end());
+            break;
+        }
+        default:
+            if (rng() % 8) {
+                lists[0].swap(lists[1]);
+                refs[0].swap(refs[1]);
+            } else {
+                for (int id : ref) {
+                    unlinked.push_back(id);
+                }
+
+                list.clear();
+                ref.clear();
+            }
+            break;
+        }
+
+        for (int k = 0; k < 2; k++) {
+            std::vector<int> expected(refs[k].begin(), refs[k].end());
+
+            ASSERT_EQ(ids(lists[k]), expected);
+            ASSERT_EQ(lists[k].count(), expected.size());
+            ASSERT_EQ(lists[k].empty(), expected.empty());
+        }
+    }
+}
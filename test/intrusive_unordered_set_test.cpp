@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <functional>
+#include <random>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/intrusive_unordered_set.h>
+
+namespace {
+
+struct node : nothing::intrusive_unordered_set_member<void> {
+    int key;
+};
+
+struct node_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(const node &n) const
+    {
+        return std::hash<int>{}(n.key);
+    }
+
+    std::size_t operator()(int key) const { return std::hash<int>{}(key); }
+};
+
+struct node_equal {
+    bool operator()(const node &lh, const node &rh) const
+    {
+        return lh.key == rh.key;
+    }
+
+    bool operator()(const node &lh, int rh) const { return lh.key == rh; }
+};
+
+using node_set =
+    nothing::intrusive_unordered_set<node, void, node_hash, node_equal>;
+
+void expect_same(const node_set &set, const std::unordered_set<int> &ref)
+{
+    std::size_t count = 0;
+
+    for (const node &n : set) {
+        ASSERT_TRUE(ref.contains(n.key));
+        count++;
+    }
+
+    ASSERT_EQ(count, ref.size());
+    ASSERT_EQ(set.size(), ref.size());
+}
+
+} // namespace
+
+TEST(IntrusiveUnorderedSet, MatchesStdUnorderedSet)
+{
+    std::mt19937 rng(7);
+    std::vector<node> nodes(20000);
+    std::vector<bool> linked(nodes.size());
+    node_set set;
+    std::unordered_set<int> ref;
+
+    for (int round = 0; round < 200000; round++) {
+        int i = rng() % nodes.size();
+
+        if (!linked[i]) {
+            nodes[i].key = rng() % 30000;
+
+            auto [it, inserted] = set.insert(nodes[i]);
+
+            ASSERT_EQ(inserted, !ref.contains(nodes[i].key));
+            ASSERT_EQ(it->key, nodes[i].key);
+
+            if (inserted) {
+                ref.insert(nodes[i].key);
+                linked[i] = true;
+            }
+        } else if (rng() % 2) {
+            set.erase(nodes[i]);
+            ref.erase(nodes[i].key);
+            linked[i] = false;
+        } else {
+            auto it = set.find(nodes[i].key);
+
+            ASSERT_EQ(&*it, &nodes[i]);
+
+            set.erase(it);
+            ref.erase(nodes[i].key);
+            linked[i] = false;
+        }
+
+        if (round % 5000) {
+            continue;
+        }
+
+        expect_same(set, ref);
+
+        for (int q = 0; q < 100; q++) {
+            int key = rng() % 30000;
+
+            ASSERT_EQ(set.contains(key), ref.contains(key));
+        }
+    }
+
+    set.clear();
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST(IntrusiveUnorderedSet, EraseWhileIteratingMidRehash)
+{
+    std::mt19937 rng(11);
+    std::vector<node> nodes(50000);
+    node_set set;
+    std::unordered_set<int> ref;
+    int checked = 0;
+
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        nodes[i].key = rng();
+
+        if (set.insert(nodes[i]).second) {
+            ref.insert(nodes[i].key);
+        }
+
+        // Halfway through moving the old table over, erase the odd keys
+        // while iterating, and put them back.
+        if (!set.rehashing() || rng() % 64) {
+            continue;
+        }
+
+        std::vector<node *> erased;
+
+        for (auto it = set.begin(); it != set.end();) {
+            if (it->key % 2) {
+                erased.push_back(&*it);
+                ref.erase(it->key);
+                it = set.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        expect_same(set, ref);
+
+        for (node *n : erased) {
+            ASSERT_TRUE(set.insert(*n).second);
+            ref.insert(n->key);
+        }
+
+        expect_same(set, ref);
+        checked++;
+    }
+
+    EXPECT_GT(checked, 0);
+}
+
+TEST(IntrusiveUnorderedSet, Move)
+{
+    std::vector<node> nodes(1000);
+    node_set set;
+    std::unordered_set<int> ref;
+
+    for (int i = 0; i < 1000; i++) {
+        nodes[i].key = i;
+        set.insert(nodes[i]);
+        ref.insert(i);
+    }
+
+    node_set moved(std::move(set));
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+    expect_same(moved, ref);
+
+    set = std::move(moved);
+
+    EXPECT_TRUE(moved.empty());
+    expect_same(set, ref);
+
+    set.clear();
+}
+
+// Destroying a set partway through growing unlinks the elements of both
+// bucket arrays, without touching the front of the old array already given
+// back to the system.
+TEST(IntrusiveUnorderedSet, ElementsOutliveSet)
+{
+    std::vector<node> nodes(35000);
+    std::unordered_set<int> ref;
+
+    for (int i = 0; i < 35000; i++) {
+        nodes[i].key = i;
+        ref.insert(i);
+    }
+
+    {
+        node_set set;
+
+        for (node &n : nodes) {
+            set.insert(n);
+        }
+
+        ASSERT_TRUE(set.rehashing());
+    }
+
+    node_set set;
+
+    for (node &n : nodes) {
+        ASSERT_TRUE(set.insert(n).second);
+    }
+
+    expect_same(set, ref);
+
+    for (node &n : nodes) {
+        set.erase(n);
+    }
+
+    EXPECT_TRUE(set.empty());
+}
@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_address.h>
+
+namespace {
+
+using nothing::ipv4_address;
+
+// Returns whether inet_pton() accepts `src`, storing the address in `addr`.
+bool reference_parse(const std::string &src, ipv4_address &addr)
+{
+    in_addr value;
+
+    if (inet_pton(AF_INET, src.c_str(), &value) != 1) {
+        return false;
+    }
+
+    addr = ipv4_address::from_network_order(value.s_addr);
+    return true;
+}
+
+// Dotted quads with octets that may be too large, padded with leading zeros
+// or cut short, and strings of digits and dots with the wrong shape.
+std::string random_address(std::mt19937 &rng)
+{
+    std::string ret;
+
+    if (rng() % 4 == 0) {
+        const char alphabet[] = "0123456789.......x:";
+        std::size_t size = rng() % 20;
+
+        while (ret.size() < size) {
+            ret += alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+
+        return ret;
+    }
+
+    int octets = 4 + (rng() % 8 == 0 ? rng() % 3 - 1 : 0);
+
+    for (int i = 0; i < octets; i++) {
+        if (i) {
+            ret += '.';
+        }
+
+        if (rng() % 16 == 0) {
+            ret += '0';
+        }
+
+        ret += std::to_string(rng() % 8 ? rng() % 256 : rng() % 1200);
+    }
+
+    return ret;
+}
+
+std::string reference_format(ipv4_address addr)
+{
+    in_addr value{ addr.to_network_order() };
+    char buf[INET_ADDRSTRLEN];
+
+    return inet_ntop(AF_INET, &value, buf, sizeof(buf));
+}
+
+bool reference_classify(nothing::ipv4_class cls, ipv4_address addr)
+{
+    switch (cls) {
+    case nothing::ipv4_class::loopback:
+        return addr.is_loopback();
+    case nothing::ipv4_class::link_local:
+        return addr.is_link_local();
+    case nothing::ipv4_class::private_network:
+        return addr.is_private();
+    default:
+        return addr.is_multicast();
+    }
+}
+
+// Addresses on both sides of the edges of every classified network, mixed
+// with random ones.
+std::vector<ipv4_address> classify_inputs(std::mt19937 &rng, std::size_t size)
+{
+    const uint32_t edges[] = {
+        0x7F000000, 0x80000000, 0xA9FE0000, 0xA9FF0000, 0x0A000000,
+        0x0B000000, 0x64400000, 0x64800000, 0xAC100000, 0xAC200000,
+        0xC0000000, 0xC0000100, 0xC0A80000, 0xC0A90000, 0xC6120000,
+        0xC6140000, 0xE0000000, 0xF0000000,
+    };
+    std::vector<ipv4_address> ret(size);
+
+    for (ipv4_address &addr : ret) {
+        if (rng() % 2) {
+            addr = static_cast<uint32_t>(rng());
+        } else {
+            uint32_t edge = edges[rng() % std::size(edges)];
+            addr = rng() % 2 ? edge + rng() % 4 : edge - 1 - rng() % 4;
+        }
+    }
+
+    return ret;
+}
+
+} // namespace
+
+TEST(Ipv4Address, ParseKnownStrings)
+{
+    const char *valid[] = {
+        "0.0.0.0",     "255.255.255.255", "1.2.3.4",     "10.0.0.1",
+        "192.168.1.1", "127.0.0.1",       "100.99.10.9", "9.99.199.255",
+    };
+    const char *invalid[] = {
+        "",          "1.2.3",       "1.2.3.4.5",       "1..2.3",
+        ".1.2.3",    "1.2.3.",      "01.2.3.4",        "1.2.3.04",
+        "1.2.3.256", "256.1.1.1",   "1.2.3.1000",      "1234.1.1.1",
+        "1.2.3.-4",  "0x1.2.3.4",   " 1.2.3.4",        "1.2.3.4 ",
+        "1.2.3.4\n", "1.2.3.4/24",  "1.2.3.4.",        "00.0.0.0",
+        "1.2.3.4x",  "1.2.3.4:80",  "255.255.255.255.", "1.2..3.4",
+    };
+
+    for (const char *src : valid) {
+        ipv4_address expected;
+        std::error_code error;
+
+        ASSERT_TRUE(reference_parse(src, expected)) << src;
+        EXPECT_EQ(ipv4_address::from_string(src, error), expected) << src;
+        EXPECT_FALSE(error) << src;
+    }
+
+    for (const char *src : invalid) {
+        ipv4_address ignored;
+        std::error_code error;
+
+        ASSERT_FALSE(reference_parse(src, ignored)) << src;
+        ipv4_address::from_string(src, error);
+        EXPECT_EQ(error, std::errc::invalid_argument) << src;
+        EXPECT_THROW(ipv4_address::from_string(src), std::system_error) << src;
+    }
+}
+
+TEST(Ipv4Address, ParseMatchesInetPton)
+{
+    std::mt19937 rng(30);
+
+    for (int round = 0; round < 200000; round++) {
+        std::string src = random_address(rng);
+        ipv4_address expected;
+        bool valid = reference_parse(src, expected);
+
+        // Once as the whole string, which the vector parser reads through a
+        // bounce buffer, and once followed by more text so that it loads
+        // straight from the string.
+        std::error_code error;
+        ipv4_address addr = ipv4_address::from_string(src, error);
+
+        ASSERT_EQ(!error, valid) << src;
+
+        if (valid) {
+            ASSERT_EQ(addr, expected) << src;
+        }
+
+        std::string padded = src + ",0123456789.0123456789";
+        std::string_view view = padded;
+        std::string_view::iterator last = view.begin();
+        addr = ipv4_address::from_string(view, last, error);
+
+        if (valid) {
+            ASSERT_FALSE(error) << src;
+            ASSERT_EQ(addr, expected) << src;
+            ASSERT_EQ(last - view.begin(),
+                      static_cast<std::ptrdiff_t>(src.size()));
+        }
+    }
+}
+
+// The prefix form stops after the longest valid address and leaves the rest.
+TEST(Ipv4Address, ParsePrefix)
+{
+    struct {
+        const char *src;
+        const char *addr;
+        std::size_t size;
+    } cases[] = {
+        { "1.2.3.4:80", "1.2.3.4", 7 },
+        { "1.2.3.256", "1.2.3.25", 8 },
+        { "1.2.3.04", "1.2.3.0", 7 },
+        { "1.2.3.4.5", "1.2.3.4", 7 },
+        { "10.20.30.40/8", "10.20.30.40", 11 },
+        { "255.255.255.2555", "255.255.255.255", 15 },
+    };
+
+    for (auto [src, addr, size] : cases) {
+        std::string_view view = src;
+        std::string_view::iterator last;
+
+        EXPECT_EQ(ipv4_address::from_string(view, last),
+                  ipv4_address::from_string(addr))
+            << src;
+        EXPECT_EQ(last - view.begin(), static_cast<std::ptrdiff_t>(size))
+            << src;
+    }
+
+    std::string_view::iterator last;
+
+    EXPECT_THROW(ipv4_address::from_string("1.2.3", last), std::system_error);
+    EXPECT_THROW(ipv4_address::from_string("01.2.3.4", last),
+                 std::system_error);
+}
+
+TEST(Ipv4Address, ParseBatches)
+{
+    std::vector<ipv4_address> out(8);
+    std::string_view::iterator last;
+    std::error_code error;
+
+    std::string_view lines = "1.2.3.4\n10.0.0.1\r\n255.255.255.255\n0.0.0.0";
+    std::size_t count = ipv4_address::from_lines(lines, out, last);
+
+    EXPECT_EQ(count, 4u);
+    EXPECT_EQ(last, lines.end());
+    EXPECT_EQ(out[0], ipv4_address::from_string("1.2.3.4"));
+    EXPECT_EQ(out[1], ipv4_address::from_string("10.0.0.1"));
+    EXPECT_EQ(out[2], ipv4_address::broadcast());
+    EXPECT_EQ(out[3], ipv4_address::any());
+
+    count = ipv4_address::from_lines(lines, std::span(out).first(2), last);
+
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(last - lines.begin(), 18);
+
+    std::string_view bad = "1.2.3.4\n1.2.3\n5.6.7.8\n";
+    count = ipv4_address::from_lines(bad, out, last, error);
+
+    EXPECT_EQ(count, 1u);
+    EXPECT_EQ(error, std::errc::invalid_argument);
+    EXPECT_EQ(last - bad.begin(), 8);
+    EXPECT_THROW(ipv4_address::from_lines(bad, out, last), std::system_error);
+
+    std::string_view strings[] = { "1.1.1.1", "8.8.8.8", "08.8.8.8" };
+    count = ipv4_address::from_string(strings, out, error);
+
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(error, std::errc::invalid_argument);
+    EXPECT_EQ(out[1], ipv4_address::from_string("8.8.8.8"));
+
+    count = ipv4_address::from_string(std::span(strings).first(2), out, error);
+
+    EXPECT_EQ(count, 2u);
+    EXPECT_FALSE(error);
+}
+
+TEST(Ipv4Address, FormatMatchesInetNtop)
+{
+    std::mt19937 rng(31);
+    std::vector<ipv4_address> addrs;
+
+    // Every octet value in every position, then random addresses.
+    for (uint32_t value = 0; value < 256; value++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            addrs.push_back(value << shift | (rng() & ~(0xFFu << shift)));
+        }
+    }
+
+    for (int i = 0; i < 10000; i++) {
+        addrs.push_back(static_cast<uint32_t>(rng()));
+    }
+
+    addrs.push_back(ipv4_address::any());
+    addrs.push_back(ipv4_address::broadcast());
+
+    for (ipv4_address addr : addrs) {
+        std::string expected = reference_format(addr);
+        char buf[ipv4_address::string_size];
+        std::string chars;
+        std::ostringstream os;
+
+        addr.to_chars(std::back_inserter(chars));
+        os << addr;
+
+        ASSERT_EQ(std::string(buf, addr.format(buf)), expected);
+        ASSERT_EQ(addr.to_string(), expected);
+        ASSERT_EQ(chars, expected);
+        ASSERT_EQ(os.str(), expected);
+        ASSERT_EQ(ipv4_address::from_string(expected), addr);
+    }
+}
+
+TEST(Ipv4Address, FormatMany)
+{
+    std::mt19937 rng(32);
+
+    for (std::size_t size = 0; size <= 40; size++) {
+        std::vector<ipv4_address> addrs;
+        std::string expected;
+
+        for (std::size_t i = 0; i < size; i++) {
+            addrs.push_back(static_cast<uint32_t>(rng() >> rng() % 32));
+            expected += (i ? "," : "") + reference_format(addrs.back());
+        }
+
+        std::string buf(size * ipv4_address::string_size, '\0');
+        char *end = nothing::format_many(addrs, buf.data(), ',');
+
+        ASSERT_EQ(std::string(buf.data(), end), expected);
+    }
+}
+
+// Every length around the 64-address blocks and 8-address vectors, checked
+// against the scalar classifiers.
+TEST(Ipv4Address, ClassifyAndPartitionMatchScalar)
+{
+    std::mt19937 rng(33);
+    const nothing::ipv4_class classes[] = {
+        nothing::ipv4_class::loopback,
+        nothing::ipv4_class::link_local,
+        nothing::ipv4_class::private_network,
+        nothing::ipv4_class::multicast,
+    };
+
+    for (std::size_t size = 0; size <= 300; size++) {
+        std::vector<ipv4_address> addrs = classify_inputs(rng, size);
+
+        for (nothing::ipv4_class cls : classes) {
+            std::vector<uint64_t> bits((size + 63) / 64);
+            nothing::classify_many(cls, addrs, bits);
+
+            std::vector<uint32_t> expected;
+
+            for (std::size_t i = 0; i < size; i++) {
+                bool hit = reference_classify(cls, addrs[i]);
+
+                ASSERT_EQ(bits[i / 64] >> i % 64 & 1, hit)
+                    << "size " << size << " index " << i;
+
+                if (hit) {
+                    expected.push_back(i);
+                }
+            }
+
+            std::size_t count = expected.size();
+
+            for (std::size_t i = 0; i < size; i++) {
+                if (!reference_classify(cls, addrs[i])) {
+                    expected.push_back(i);
+                }
+            }
+
+            // A longer destination past the end must be left alone.
+            std::vector<uint32_t> indices(size + 70, 0xDEADBEEF);
+
+            ASSERT_EQ(nothing::partition_many(
+                          cls, addrs, std::span(indices).first(size)),
+                      count);
+            ASSERT_TRUE(std::equal(expected.begin(), expected.end(),
+                                   indices.begin()));
+            ASSERT_EQ(std::count(indices.begin() + size, indices.end(),
+                                 0xDEADBEEF),
+                      70);
+        }
+    }
+}
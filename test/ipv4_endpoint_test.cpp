@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_endpoint.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv4_endpoint;
+
+constexpr sockaddr_in loopback_http =
+    ipv4_endpoint{ ipv4_address{ 0x7F000001u }, 8080 }.to_sockaddr();
+
+static_assert(ipv4_endpoint::from_sockaddr(loopback_http).port() == 8080);
+static_assert(ipv4_endpoint::from_sockaddr(loopback_http).address() ==
+              ipv4_address{ 0x7F000001u });
+
+std::string reference_format(const sockaddr_in &addr)
+{
+    char buf[INET_ADDRSTRLEN];
+
+    return std::string(inet_ntop(AF_INET, &addr.sin_addr, buf, sizeof(buf))) +
+           ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+} // namespace
+
+// The socket API builds a sockaddr_in; the endpoint must read the same
+// address and port out of it, print them as inet_ntop() does and give back
+// the same bytes.
+TEST(Ipv4Endpoint, SockaddrRoundTrip)
+{
+    std::mt19937 rng(50);
+
+    for (int round = 0; round < 10000; round++) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(rng()));
+        addr.sin_addr.s_addr = htonl(static_cast<uint32_t>(rng()));
+
+        ipv4_endpoint endpoint = ipv4_endpoint::from_sockaddr(addr);
+        sockaddr_in back = endpoint.to_sockaddr();
+        std::string text = reference_format(addr);
+
+        ASSERT_EQ(endpoint.port(), ntohs(addr.sin_port));
+        ASSERT_EQ(endpoint.address().to_uint(), ntohl(addr.sin_addr.s_addr));
+        ASSERT_EQ(back.sin_family, AF_INET);
+        ASSERT_EQ(back.sin_port, addr.sin_port);
+        ASSERT_EQ(back.sin_addr.s_addr, addr.sin_addr.s_addr);
+        ASSERT_EQ(endpoint.to_string(), text);
+        ASSERT_EQ(ipv4_endpoint::from_string(text), endpoint) << text;
+    }
+}
+
+TEST(Ipv4Endpoint, Format)
+{
+    ipv4_endpoint endpoint = ipv4_endpoint::from_string("192.168.1.20:443");
+    std::string chars;
+    std::ostringstream os;
+
+    endpoint.to_chars(std::back_inserter(chars));
+    os << endpoint;
+
+    EXPECT_EQ(chars, "192.168.1.20:443");
+    EXPECT_EQ(os.str(), "192.168.1.20:443");
+    EXPECT_EQ(ipv4_endpoint{}.to_string(), "0.0.0.0:0");
+    EXPECT_EQ((ipv4_endpoint{ ipv4_address::broadcast(), 65535 }.to_string()),
+              "255.255.255.255:65535");
+
+    for (uint32_t port : { 0, 1, 9, 10, 99, 100, 999, 1000, 9999, 10000,
+                           65535 }) {
+        ipv4_endpoint ep{ ipv4_address{ 0x01020304u },
+                          static_cast<uint16_t>(port) };
+        char buf[ipv4_endpoint::string_size];
+
+        EXPECT_EQ(std::string(buf, ep.format(buf)),
+                  "1.2.3.4:" + std::to_string(port));
+    }
+}
+
+TEST(Ipv4Endpoint, ParseRejects)
+{
+    const char *invalid[] = {
+        "",           "1.2.3.4",       "1.2.3.4:",   "1.2.3.4:65536",
+        "1.2.3.4:01", "1.2.3.4:x",     "1.2.3.4;80", "1.2.3.4:123456",
+        ":80",        "1.2.3:80",      "01.2.3.4:80", "1.2.3.4:80 ",
+        "1.2.3.4:-1", "1.2.3.256:80",  "1.2.3.4::80", "[1.2.3.4]:80",
+    };
+
+    for (const char *src : invalid) {
+        std::error_code error;
+
+        ipv4_endpoint::from_string(src, error);
+        EXPECT_EQ(error, std::errc::invalid_argument) << src;
+        EXPECT_THROW(ipv4_endpoint::from_string(src), std::system_error)
+            << src;
+    }
+
+    // The prefix form stops before a digit that would overflow the port.
+    std::string_view src = "1.2.3.4:65536";
+    std::string_view::iterator last;
+    ipv4_endpoint endpoint = ipv4_endpoint::from_string(src, last);
+
+    EXPECT_EQ(endpoint.port(), 6553);
+    EXPECT_EQ(*last, '6');
+}
+
+TEST(Ipv4Endpoint, OrderAndHash)
+{
+    ipv4_address addr{ 0x0A000001u };
+    std::unordered_set<ipv4_endpoint> set;
+
+    for (int port = 0; port < 1000; port++) {
+        set.insert({ addr, static_cast<uint16_t>(port) });
+        set.insert({ addr, static_cast<uint16_t>(port) });
+    }
+
+    EXPECT_EQ(set.size(), 1000u);
+    EXPECT_LT((ipv4_endpoint{ ipv4_address{ 1u }, 2 }),
+              (ipv4_endpoint{ ipv4_address{ 1u }, 3 }));
+    EXPECT_LT((ipv4_endpoint{ ipv4_address{ 1u }, 9 }),
+              (ipv4_endpoint{ ipv4_address{ 2u }, 0 }));
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_lpm_table.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv4_lpm_table;
+using nothing::ipv4_network;
+
+// Routes as (network, prefix length), checked by trying every length.
+class reference_table {
+  public:
+    bool insert_or_assign(const ipv4_network &net, int value)
+    {
+        auto [it, inserted] = _routes.insert_or_assign(_key(net), value);
+        return inserted;
+    }
+
+    bool insert(const ipv4_network &net, int value)
+    {
+        return _routes.try_emplace(_key(net), value).second;
+    }
+
+    bool erase(const ipv4_network &net) { return _routes.erase(_key(net)); }
+
+    const int *lookup(uint32_t addr) const
+    {
+        for (int len = 32; len >= 0; len--) {
+            uint32_t mask = len ? ~uint32_t{ 0 } << (32 - len) : 0;
+            auto it = _routes.find({ addr & mask, len });
+
+            if (it != _routes.end()) {
+                return &it->second;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::size_t size() const { return _routes.size(); }
+
+    const std::map<std::pair<uint32_t, int>, int> &routes() const
+    {
+        return _routes;
+    }
+
+  private:
+    static std::pair<uint32_t, int> _key(const ipv4_network &net)
+    {
+        return { net.network().to_uint(), net.prefix_length() };
+    }
+
+    std::map<std::pair<uint32_t, int>, int> _routes;
+};
+
+// Addresses clustered into a few /22s spread over the space, so that routes
+// of every length overlap and share 24-bit entries and groups.
+uint32_t clustered_address(std::mt19937 &rng)
+{
+    return (rng() % 4) << 30 | (rng() % 3) << 20 | rng() % 1024;
+}
+
+ipv4_network random_network(std::mt19937 &rng)
+{
+    int len = rng() % 2 ? 20 + rng() % 13 : rng() % 33;
+    return { ipv4_address{ clustered_address(rng) }, len };
+}
+
+void expect_same_lookups(const ipv4_lpm_table<int> &table,
+                         const reference_table &ref, std::mt19937 &rng)
+{
+    std::vector<ipv4_address> addrs;
+
+    // Every address of one cluster, then a sample of the others.
+    uint32_t base = (rng() % 4) << 30 | (rng() % 3) << 20;
+
+    for (uint32_t i = 0; i < 1024; i++) {
+        addrs.push_back(base | i);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        addrs.push_back(clustered_address(rng) ^ (rng() % 8 ? 0 : rng()));
+    }
+
+    std::vector<const int *> batch(addrs.size());
+    table.lookup(addrs, batch);
+
+    for (std::size_t i = 0; i < addrs.size(); i++) {
+        const int *expected = ref.lookup(addrs[i].to_uint());
+        const int *value = table.lookup(addrs[i]);
+
+        ASSERT_EQ(value == nullptr, expected == nullptr) << addrs[i];
+        ASSERT_EQ(batch[i], value) << addrs[i];
+
+        if (expected) {
+            ASSERT_EQ(*value, *expected) << addrs[i];
+        }
+    }
+}
+
+} // namespace
+
+TEST(Ipv4Network, ParseAndMasks)
+{
+    ipv4_network net = ipv4_network::from_string("10.1.2.3/8");
+
+    EXPECT_EQ(net.to_string(), "10.1.2.3/8");
+    EXPECT_EQ(net.network(), ipv4_address{ 0x0A000000u });
+    EXPECT_EQ(net.broadcast(), ipv4_address{ 0x0AFFFFFFu });
+    EXPECT_EQ(net.netmask(), ipv4_address{ 0xFF000000u });
+    EXPECT_EQ(net.hostmask(), ipv4_address{ 0x00FFFFFFu });
+    EXPECT_EQ(net.canonical().to_string(), "10.0.0.0/8");
+    EXPECT_TRUE(net.contains(ipv4_address{ 0x0AFF0000u }));
+    EXPECT_FALSE(net.contains(ipv4_address{ 0x0B000000u }));
+    EXPECT_TRUE(net.contains(ipv4_network::from_string("10.9.0.0/16")));
+    EXPECT_FALSE(net.contains(ipv4_network::from_string("10.0.0.0/7")));
+    EXPECT_TRUE(ipv4_network::from_string("0.0.0.0/0")
+                    .contains(ipv4_address::broadcast()));
+    EXPECT_TRUE(ipv4_network::from_string("1.2.3.4/32").is_host());
+
+    for (const char *bad : { "1.2.3.4", "1.2.3.4/", "1.2.3.4/33",
+                             "1.2.3.4/08", "1.2.3.4/x", "1.2.3/8" }) {
+        std::error_code error;
+
+        ipv4_network::from_string(bad, error);
+        EXPECT_TRUE(error) << bad;
+    }
+
+    EXPECT_THROW(ipv4_network(ipv4_address{}, 33), std::out_of_range);
+}
+
+// Random inserts, reassignments and erases of overlapping routes, checked
+// against trying every prefix length of a plain map.
+TEST(Ipv4LpmTable, MatchesBruteForce)
+{
+    std::mt19937 rng(60);
+    ipv4_lpm_table<int> table;
+    reference_table ref;
+
+    for (int op = 0; op < 4000; op++) {
+        ipv4_network net = random_network(rng);
+
+        if (rng() % 3 == 0 && ref.size()) {
+            // Mostly routes that exist, sometimes ones that do not.
+            if (rng() % 4) {
+                auto it = ref.routes().begin();
+                std::advance(it, rng() % ref.size());
+                net = { ipv4_address{ it->first.first }, it->first.second };
+            }
+
+            ASSERT_EQ(table.erase(net), ref.erase(net)) << net;
+        } else {
+            int value = rng();
+
+            // Host bits are ignored.
+            uint32_t host = net.hostmask().to_uint() & rng();
+            net = { ipv4_address{ net.address().to_uint() | host },
+                    net.prefix_length() };
+
+            ASSERT_EQ(table.insert_or_assign(net, value),
+                      ref.insert_or_assign(net, value))
+                << net;
+        }
+
+        ASSERT_EQ(table.size(), ref.size());
+
+        if (op % 200 == 0) {
+            expect_same_lookups(table, ref, rng);
+        }
+    }
+
+    expect_same_lookups(table, ref, rng);
+
+    for (const auto &[key, value] : ref.routes()) {
+        const int *found =
+            table.find(ipv4_network{ ipv4_address{ key.first }, key.second });
+
+        ASSERT_NE(found, nullptr);
+        ASSERT_EQ(*found, value);
+    }
+}
+
+// The same routes give the same table whatever order they arrive or leave
+// in, down to an empty one.
+TEST(Ipv4LpmTable, OrderIndependent)
+{
+    std::mt19937 rng(61);
+    std::vector<std::pair<ipv4_network, int>> routes;
+    reference_table ref;
+
+    while (routes.size() < 300) {
+        ipv4_network net = random_network(rng);
+        int value = routes.size();
+
+        if (ref.insert(net, value)) {
+            routes.emplace_back(net, value);
+        }
+    }
+
+    ipv4_lpm_table<int> table;
+
+    for (int round = 0; round < 3; round++) {
+        std::shuffle(routes.begin(), routes.end(), rng);
+
+        for (const auto &[net, value] : routes) {
+            ASSERT_TRUE(table.insert_or_assign(net, value));
+        }
+
+        expect_same_lookups(table, ref, rng);
+
+        std::shuffle(routes.begin(), routes.end(), rng);
+        reference_table partial = ref;
+
+        for (std::size_t i = 0; i < routes.size(); i++) {
+            ASSERT_TRUE(table.erase(routes[i].first));
+            ASSERT_FALSE(table.erase(routes[i].first));
+            partial.erase(routes[i].first);
+
+            if (i % 60 == 0) {
+                expect_same_lookups(table, partial, rng);
+            }
+        }
+
+        ASSERT_TRUE(table.empty());
+        expect_same_lookups(table, partial, rng);
+    }
+
+    table.insert_or_assign(ipv4_network::from_string("0.0.0.0/0"), 7);
+    table.clear();
+
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.lookup(ipv4_address{ 0x01020304u }), nullptr);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_range_db.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv4_network;
+using nothing::ipv4_range_db;
+using nothing::ipv4_range_db_builder;
+
+struct range {
+    uint32_t first;
+    uint32_t last;
+    uint32_t value;
+
+    bool operator==(const range &) const = default;
+};
+
+uint32_t load_le32(const std::vector<uint8_t> &data, std::size_t pos)
+{
+    return data[pos] | data[pos + 1] << 8 | data[pos + 2] << 16 |
+           static_cast<uint32_t>(data[pos + 3]) << 24;
+}
+
+// Reads the ranges of a database back out by walking the Eytzinger slots in
+// order, independently of ipv4_range_db.
+std::vector<range> read_ranges(const std::vector<uint8_t> &data)
+{
+    std::size_t n = load_le32(data, 12);
+    std::size_t stride = 4 * (n + 1);
+    std::vector<range> ret;
+
+    auto visit = [&](auto &self, std::size_t k) -> void {
+        if (k > n) {
+            return;
+        }
+
+        self(self, 2 * k);
+        ret.push_back({ load_le32(data, 64 + stride + 4 * k),
+                        load_le32(data, 64 + 4 * k),
+                        load_le32(data, 64 + 2 * stride + 4 * k) });
+        self(self, 2 * k + 1);
+    };
+
+    visit(visit, 1);
+    return ret;
+}
+
+std::optional<uint32_t>
+reference_lookup(const std::map<uint32_t, std::pair<uint32_t, uint32_t>> &ref,
+                 uint32_t addr)
+{
+    auto it = ref.upper_bound(addr);
+
+    if (it == ref.begin() || addr > std::prev(it)->second.first) {
+        return std::nullopt;
+    }
+
+    return std::prev(it)->second.second;
+}
+
+class temp_file {
+  public:
+    explicit temp_file(const char *name)
+        : _path(std::filesystem::temp_directory_path() / name)
+    {
+    }
+
+    ~temp_file() { std::filesystem::remove(_path); }
+
+    const std::filesystem::path &path() const { return _path; }
+
+    void write(const std::vector<uint8_t> &data) const
+    {
+        std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+  private:
+    std::filesystem::path _path;
+};
+
+} // namespace
+
+TEST(Ipv4RangeDb, FileFormat)
+{
+    ipv4_range_db_builder builder;
+
+    // Out of order, overlapping and adjacent with equal values, which merge.
+    builder.insert(ipv4_address{ 41u }, ipv4_address{ 50u }, 2);
+    builder.insert(ipv4_address{ 10u }, ipv4_address{ 20u }, 1);
+    builder.insert(ipv4_address{ 15u }, ipv4_address{ 30u }, 1);
+    builder.insert(ipv4_address{ 31u }, ipv4_address{ 40u }, 1);
+    builder.insert(ipv4_network::from_string("10.0.0.0/8"), 3);
+    builder.insert(ipv4_address::broadcast(), ipv4_address::broadcast(), 4);
+    builder.insert(ipv4_address::any(), ipv4_address::any(), 5);
+
+    std::vector<uint8_t> data = builder.build();
+    const std::vector<range> expected = {
+        { 0, 0, 5 },
+        { 10, 40, 1 },
+        { 41, 50, 2 },
+        { 0x0A000000, 0x0AFFFFFF, 3 },
+        { 0xFFFFFFFF, 0xFFFFFFFF, 4 },
+    };
+
+    ASSERT_EQ(data.size(), 64 + 3 * 4 * (expected.size() + 1));
+    EXPECT_EQ(std::memcmp(data.data(), "NIPV4RDB", 8), 0);
+    EXPECT_EQ(load_le32(data, 8), 1u);
+    EXPECT_EQ(load_le32(data, 12), expected.size());
+
+    for (std::size_t i = 16; i < 64; i++) {
+        EXPECT_EQ(data[i], 0) << i;
+    }
+
+    EXPECT_EQ(read_ranges(data), expected);
+
+    ipv4_range_db db{ std::span<const uint8_t>(data) };
+
+    EXPECT_EQ(db.size(), expected.size());
+    EXPECT_EQ(db.version(), 1u);
+    EXPECT_EQ(db.lookup(ipv4_address{ 0u }), 5u);
+    EXPECT_EQ(db.lookup(ipv4_address{ 9u }), std::nullopt);
+    EXPECT_EQ(db.lookup(ipv4_address{ 10u }), 1u);
+    EXPECT_EQ(db.lookup(ipv4_address{ 40u }), 1u);
+    EXPECT_EQ(db.lookup(ipv4_address{ 41u }), 2u);
+    EXPECT_EQ(db.lookup(ipv4_address{ 51u }), std::nullopt);
+    EXPECT_EQ(db.lookup(ipv4_address::from_string("10.200.3.4")), 3u);
+    EXPECT_FALSE(db.contains(ipv4_address::from_string("11.0.0.0")));
+    EXPECT_EQ(db.lookup(ipv4_address::broadcast()), 4u);
+}
+
+TEST(Ipv4RangeDb, BuilderRejectsBadRanges)
+{
+    ipv4_range_db_builder builder;
+
+    EXPECT_THROW(builder.insert(ipv4_address{ 5u }, ipv4_address{ 4u }, 0),
+                 std::invalid_argument);
+
+    builder.insert(ipv4_address{ 10u }, ipv4_address{ 20u }, 1);
+    builder.insert(ipv4_address{ 20u }, ipv4_address{ 30u }, 2);
+
+    EXPECT_THROW(builder.build(), std::invalid_argument);
+
+    builder.clear();
+
+    EXPECT_TRUE(builder.empty());
+
+    std::vector<uint8_t> data = builder.build();
+    ipv4_range_db db{ std::span<const uint8_t>(data) };
+
+    EXPECT_TRUE(db.empty());
+    EXPECT_FALSE(db.contains(ipv4_address::any()));
+    EXPECT_FALSE(ipv4_range_db{}.contains(ipv4_address::any()));
+}
+
+// Sizes around every depth of the implicit tree, written to a file and
+// mapped back, checked against a sorted map.
+TEST(Ipv4RangeDb, MatchesSortedMap)
+{
+    std::mt19937 rng(70);
+    temp_file file("nothing_ipv4_range_db_test.bin");
+
+    for (int size : { 1, 2, 3, 7, 8, 15, 16, 17, 31, 100, 1000, 3000 }) {
+        ipv4_range_db_builder builder;
+        std::map<uint32_t, std::pair<uint32_t, uint32_t>> ref;
+        uint32_t pos = rng() % 1000;
+
+        // Values alternate so that neighbouring ranges never merge.
+        for (int i = 0; i < size; i++) {
+            uint32_t len = rng() % 100;
+            uint32_t value = i % 2;
+
+            builder.insert(ipv4_address{ pos }, ipv4_address{ pos + len },
+                           value);
+            ref[pos] = { pos + len, value };
+            pos += len + 1 + (rng() % 3 ? rng() % 50 : 0);
+        }
+
+        builder.write(file.path());
+        ipv4_range_db mapped{ file.path() };
+        ipv4_range_db db = std::move(mapped);
+
+        ASSERT_TRUE(mapped.empty());
+        ASSERT_EQ(db.size(), static_cast<std::size_t>(size));
+
+        for (int q = 0; q < 20000; q++) {
+            uint32_t addr = rng() % (pos + 100);
+
+            ASSERT_EQ(db.lookup(ipv4_address{ addr }),
+                      reference_lookup(ref, addr))
+                << addr;
+        }
+    }
+}
+
+TEST(Ipv4RangeDb, RejectsCorruptInput)
+{
+    ipv4_range_db_builder builder;
+
+    for (uint32_t i = 0; i < 20; i++) {
+        builder.insert(ipv4_address{ 10 * i }, ipv4_address{ 10 * i + 5 }, i);
+    }
+
+    const std::vector<uint8_t> good = builder.build();
+    std::vector<std::vector<uint8_t>> bad;
+
+    // Every header byte but the range count changed, the count off by one
+    // either way, every shorter length and one byte too many.
+    for (std::size_t i = 0; i < 64; i++) {
+        if (i < 12 || i >= 16) {
+            bad.push_back(good);
+            bad.back()[i] ^= 1 << (i % 8);
+        }
+    }
+
+    for (int delta : { -1, 1 }) {
+        bad.push_back(good);
+        bad.back()[12] += delta;
+    }
+
+    for (std::size_t size = 0; size < good.size(); size++) {
+        bad.emplace_back(good.begin(), good.begin() + size);
+    }
+
+    bad.push_back(good);
+    bad.back().push_back(0);
+
+    temp_file file("nothing_ipv4_range_db_corrupt.bin");
+
+    for (const auto &data : bad) {
+        EXPECT_THROW(ipv4_range_db{ std::span<const uint8_t>(data) },
+                     std::runtime_error);
+
+        file.write(data);
+        EXPECT_THROW(ipv4_range_db{ file.path() }, std::runtime_error);
+    }
+
+    file.write(good);
+    EXPECT_EQ(ipv4_range_db{ file.path() }.lookup(ipv4_address{ 13u }), 1u);
+
+    EXPECT_THROW(ipv4_range_db{ std::filesystem::path("/nonexistent/db") },
+                 std::system_error);
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_set.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv4_set;
+using reference_set = std::set<uint32_t>;
+
+// Blocks on both sides of the 64-block words of the container index, and at
+// the ends of the address space.
+constexpr uint32_t block_keys[] = { 0, 1, 62, 63, 64, 65, 127, 128, 1000,
+                                    65534, 65535 };
+
+void expect_equal(const ipv4_set &set, const reference_set &ref)
+{
+    ASSERT_EQ(set.size(), ref.size());
+    ASSERT_EQ(set.empty(), ref.empty());
+
+    auto it = ref.begin();
+
+    for (ipv4_address addr : set) {
+        ASSERT_NE(it, ref.end());
+        ASSERT_EQ(addr.to_uint(), *it);
+        ++it;
+    }
+
+    ASSERT_EQ(it, ref.end());
+}
+
+void insert(ipv4_set &set, reference_set &ref, uint32_t value)
+{
+    set.insert(ipv4_address{ value });
+    ref.insert(value);
+}
+
+// Fills a few blocks, each as a sparse array, a dense bitmap, a range that
+// may become runs or cross into the next block, or a handful of clustered
+// values, and sometimes lets optimize() turn blocks into runs.
+void generate(std::mt19937 &rng, ipv4_set &set, reference_set &ref)
+{
+    for (int blocks = 1 + rng() % 6; blocks > 0; blocks--) {
+        uint32_t key = block_keys[rng() % std::size(block_keys)] << 16;
+
+        switch (rng() % 4) {
+        case 0:
+            for (int n = rng() % 3000; n > 0; n--) {
+                insert(set, ref, key | (rng() & 0xFFFF));
+            }
+
+            break;
+        case 1:
+            for (int n = 5000 + rng() % 30000; n > 0; n--) {
+                insert(set, ref, key | (rng() & 0xFFFF));
+            }
+
+            break;
+        case 2: {
+            uint32_t first = key | (rng() & 0xFFFF);
+            uint32_t last =
+                std::min<uint64_t>(first + rng() % 70000, 0xFFFFFFFF);
+
+            set.insert(ipv4_address{ first }, ipv4_address{ last });
+
+            for (uint64_t value = first; value <= last; value++) {
+                ref.insert(value);
+            }
+
+            break;
+        }
+        default:
+            for (int n = rng() % 20; n > 0; n--) {
+                insert(set, ref, key | rng() % 64);
+            }
+        }
+    }
+
+    if (rng() % 2) {
+        set.optimize();
+    }
+}
+
+reference_set reference_op(const reference_set &a, const reference_set &b,
+                           char op)
+{
+    reference_set ret;
+    auto out = std::inserter(ret, ret.end());
+
+    switch (op) {
+    case '&':
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+        break;
+    case '|':
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+        break;
+    default:
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+    }
+
+    return ret;
+}
+
+} // namespace
+
+TEST(Ipv4Set, InsertEraseContains)
+{
+    ipv4_set empty;
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_FALSE(empty.contains(ipv4_address::any()));
+    EXPECT_FALSE(empty.erase(ipv4_address::any()));
+
+    ipv4_set set{ ipv4_address{ 5u }, ipv4_address{ 3u },
+                  ipv4_address::broadcast() };
+
+    EXPECT_EQ(set.size(), 3u);
+    EXPECT_TRUE(set.contains(ipv4_address{ 3u }));
+    EXPECT_FALSE(set.contains(ipv4_address{ 4u }));
+    EXPECT_TRUE(set.contains(ipv4_address::broadcast()));
+    EXPECT_FALSE(set.insert(ipv4_address{ 5u }));
+    EXPECT_TRUE(set.erase(ipv4_address{ 5u }));
+    EXPECT_FALSE(set.erase(ipv4_address{ 5u }));
+    EXPECT_FALSE(set.contains(ipv4_address{ 5u }));
+
+    set.insert(ipv4_address::any(), ipv4_address::broadcast());
+
+    EXPECT_EQ(set.size(), std::size_t{ 1 } << 32);
+    EXPECT_TRUE(set.erase(ipv4_address{ 70000u }));
+    EXPECT_FALSE(set.contains(ipv4_address{ 70000u }));
+    EXPECT_TRUE(set.contains(ipv4_address{ 70001u }));
+
+    set.clear();
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(ipv4_address{ 70001u }));
+}
+
+// Ranges landing on blocks already held as arrays, bitmaps and runs.
+TEST(Ipv4Set, RangeInsertIntoEachContainer)
+{
+    ipv4_set set;
+    reference_set ref;
+
+    for (uint32_t value = 0x10000; value < 0x20000; value += 7) {
+        insert(set, ref, value);
+    }
+
+    set.insert(ipv4_address{ 0x10000u }, ipv4_address{ 0x1FFFFu });
+
+    for (uint32_t value = 0x10000; value < 0x20000; value++) {
+        ref.insert(value);
+    }
+
+    insert(set, ref, 0x20005);
+    set.insert(ipv4_address{ 0x20003u }, ipv4_address{ 0x20100u });
+
+    for (uint32_t value = 0x20003; value <= 0x20100; value++) {
+        ref.insert(value);
+    }
+
+    insert(set, ref, 0x30041);
+    set.insert(ipv4_address{ 0x30040u }, ipv4_address{ 0x30040u });
+    set.optimize();
+    set.insert(ipv4_address{ 0x3003Fu }, ipv4_address{ 0x300C0u });
+
+    for (uint32_t value = 0x3003F; value <= 0x300C0; value++) {
+        ref.insert(value);
+    }
+
+    expect_equal(set, ref);
+
+    for (uint32_t value = 0xFFF0; value < 0x30200; value++) {
+        ASSERT_EQ(set.contains(ipv4_address{ value }), ref.count(value))
+            << value;
+    }
+}
+
+TEST(Ipv4Set, AlgebraMatchesStdSet)
+{
+    std::mt19937 rng(80);
+
+    for (int round = 0; round < 40; round++) {
+        ipv4_set a;
+        ipv4_set b;
+        reference_set ra;
+        reference_set rb;
+
+        generate(rng, a, ra);
+        generate(rng, b, rb);
+        expect_equal(a, ra);
+        expect_equal(b, rb);
+
+        for (int q = 0; q < 2000; q++) {
+            uint32_t key = block_keys[rng() % std::size(block_keys)];
+            uint32_t value = key << 16 | (rng() & 0xFFFF);
+
+            ASSERT_EQ(a.contains(ipv4_address{ value }), ra.count(value));
+        }
+
+        reference_set both = reference_op(ra, rb, '&');
+        reference_set either = reference_op(ra, rb, '|');
+        reference_set only = reference_op(ra, rb, '-');
+
+        expect_equal(a & b, both);
+        expect_equal(a | b, either);
+        expect_equal(a - b, only);
+
+        ipv4_set c = a;
+        c -= b;
+        expect_equal(c, only);
+        c |= b;
+        expect_equal(c, either);
+        c &= b;
+        expect_equal(c, rb);
+
+        EXPECT_EQ(a | b, b | a);
+        EXPECT_EQ(a & b, b & a);
+        EXPECT_EQ((a & b) == a,
+                  std::includes(rb.begin(), rb.end(), ra.begin(), ra.end()));
+
+        // Results answer lookups through their own index.
+        ipv4_set u = a | b;
+
+        for (uint32_t value : either) {
+            ASSERT_TRUE(u.contains(ipv4_address{ value }));
+        }
+
+        // Erase down to nothing in random order.
+        std::vector<uint32_t> values(ra.begin(), ra.end());
+        std::shuffle(values.begin(), values.end(), rng);
+        values.resize(std::min<std::size_t>(values.size(), 3000));
+
+        for (uint32_t value : values) {
+            ASSERT_TRUE(a.erase(ipv4_address{ value }));
+            ra.erase(value);
+        }
+
+        expect_equal(a, ra);
+
+        for (uint32_t value : ra) {
+            ASSERT_TRUE(a.erase(ipv4_address{ value }));
+        }
+
+        EXPECT_TRUE(a.empty());
+        EXPECT_EQ(a.begin(), a.end());
+        EXPECT_EQ(a | b, b);
+    }
+}
+
+// The SSE2 array kernels on every small shape, including blocks left over
+// after the vector loop.
+TEST(Ipv4Set, ArrayKernelsMatchStdAlgorithms)
+{
+    using nothing::detail::ipv4_set_op;
+    std::mt19937 rng(81);
+
+    for (int round = 0; round < 20000; round++) {
+        std::set<uint16_t> x;
+        std::set<uint16_t> y;
+        int range = 1 + rng() % 200;
+
+        for (int n = rng() % 60; n > 0; n--) {
+            x.insert(rng() % range);
+        }
+
+        for (int n = rng() % 60; n > 0; n--) {
+            y.insert(rng() % range);
+        }
+
+        std::vector<uint16_t> a(x.begin(), x.end());
+        std::vector<uint16_t> b(y.begin(), y.end());
+        std::vector<uint16_t> out(a.size() + b.size());
+        std::vector<uint16_t> expected;
+
+        std::size_t count =
+            nothing::detail::ipv4_set_match_arrays<ipv4_set_op::intersect>(
+                a.data(), a.size(), b.data(), b.size(), out.data());
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                              std::back_inserter(expected));
+
+        ASSERT_EQ(std::vector<uint16_t>(out.begin(), out.begin() + count),
+                  expected);
+
+        expected.clear();
+        count = nothing::detail::ipv4_set_match_arrays<ipv4_set_op::subtract>(
+            a.data(), a.size(), b.data(), b.size(), out.data());
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                            std::back_inserter(expected));
+
+        ASSERT_EQ(std::vector<uint16_t>(out.begin(), out.begin() + count),
+                  expected);
+
+        expected.clear();
+        count = nothing::detail::ipv4_set_unite_arrays(
+            a.data(), a.size(), b.data(), b.size(), out.data());
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                       std::back_inserter(expected));
+
+        ASSERT_EQ(std::vector<uint16_t>(out.begin(), out.begin() + count),
+                  expected);
+    }
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nothing/ipv4_sketch.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv4_bloom_filter;
+using nothing::ipv4_count_min_sketch;
+using nothing::ipv4_heavy_hitters;
+
+std::vector<ipv4_address> random_addresses(std::mt19937 &rng, std::size_t n)
+{
+    std::vector<ipv4_address> ret;
+
+    for (std::size_t i = 0; i < n; i++) {
+        ret.push_back(ipv4_address{ static_cast<uint32_t>(rng()) });
+    }
+
+    return ret;
+}
+
+// A stream where the address of rank `r` among `n` turns up about `1 / r`
+// times as often as the first.
+std::vector<ipv4_address> zipf_stream(std::mt19937 &rng,
+                                      const std::vector<ipv4_address> &addrs,
+                                      std::size_t length)
+{
+    std::vector<double> weights;
+
+    for (std::size_t r = 1; r <= addrs.size(); r++) {
+        weights.push_back(1.0 / r);
+    }
+
+    std::discrete_distribution<std::size_t> dist(weights.begin(),
+                                                 weights.end());
+    std::vector<ipv4_address> ret;
+
+    for (std::size_t i = 0; i < length; i++) {
+        ret.push_back(addrs[dist(rng)]);
+    }
+
+    return ret;
+}
+
+std::vector<ipv4_address> distinct_addresses(std::mt19937 &rng, std::size_t n)
+{
+    std::unordered_set<ipv4_address> seen;
+    std::vector<ipv4_address> ret;
+
+    while (ret.size() < n) {
+        ipv4_address addr{ static_cast<uint32_t>(rng()) };
+
+        if (seen.insert(addr).second) {
+            ret.push_back(addr);
+        }
+    }
+
+    return ret;
+}
+
+} // namespace
+
+TEST(Ipv4BloomFilter, NoFalseNegatives)
+{
+    std::mt19937 rng(90);
+    std::vector<ipv4_address> keys = random_addresses(rng, 20000);
+    ipv4_bloom_filter filter(keys.size() * 2);
+
+    filter.insert(std::span<const ipv4_address>(keys).first(10000));
+
+    for (std::size_t i = 10000; i < keys.size(); i++) {
+        filter.insert(keys[i]);
+    }
+
+    std::vector<uint64_t> bits((keys.size() + 63) / 64);
+    filter.contains(keys, bits);
+
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        ASSERT_TRUE(filter.contains(keys[i])) << keys[i];
+        ASSERT_TRUE(bits[i / 64] >> (i % 64) & 1) << keys[i];
+    }
+
+    // About 16 bits per key, so few other addresses may seem present.
+    std::vector<ipv4_address> others = random_addresses(rng, 100000);
+    std::size_t positives = std::count_if(
+        others.begin(), others.end(),
+        [&](const ipv4_address &addr) { return filter.contains(addr); });
+
+    EXPECT_LT(positives, others.size() / 100);
+
+    filter.clear();
+
+    EXPECT_FALSE(filter.contains(keys[0]));
+}
+
+TEST(Ipv4CountMinSketch, NeverUndercounts)
+{
+    std::mt19937 rng(91);
+    std::vector<ipv4_address> addrs = distinct_addresses(rng, 5000);
+    std::vector<ipv4_address> stream = zipf_stream(rng, addrs, 200000);
+    std::unordered_map<ipv4_address, uint32_t> counts;
+    ipv4_count_min_sketch sketch(4096);
+
+    for (std::size_t i = 0; i < stream.size(); i++) {
+        uint32_t count = ++counts[stream[i]];
+
+        if (i % 2) {
+            ASSERT_GE(sketch.add(stream[i]), count) << stream[i];
+        } else {
+            sketch.add(std::span<const ipv4_address>(&stream[i], 1));
+        }
+    }
+
+    std::vector<uint32_t> estimates(addrs.size());
+    sketch.estimate(addrs, estimates);
+
+    for (std::size_t i = 0; i < addrs.size(); i++) {
+        ASSERT_GE(estimates[i], counts[addrs[i]]) << addrs[i];
+        ASSERT_EQ(estimates[i], sketch.estimate(addrs[i])) << addrs[i];
+    }
+
+    // The heaviest address dwarfs what it shares a block with.
+    EXPECT_LT(sketch.estimate(addrs[0]), counts[addrs[0]] * 11 / 10);
+
+    sketch.clear();
+
+    EXPECT_EQ(sketch.estimate(addrs[0]), 0u);
+}
+
+TEST(Ipv4HeavyHitters, FindsTopAddresses)
+{
+    std::mt19937 rng(92);
+    std::vector<ipv4_address> addrs = distinct_addresses(rng, 20000);
+    addrs[3] = ipv4_address::any();
+    std::vector<ipv4_address> stream = zipf_stream(rng, addrs, 300000);
+    ipv4_heavy_hitters hitters(16, 1 << 16);
+
+    hitters.add(std::span<const ipv4_address>(stream).first(150000));
+
+    for (std::size_t i = 150000; i < stream.size(); i++) {
+        hitters.add(stream[i]);
+    }
+
+    auto top = hitters.top();
+    std::set<ipv4_address> tracked;
+
+    ASSERT_EQ(top.size(), 16u);
+
+    for (std::size_t i = 0; i < top.size(); i++) {
+        EXPECT_EQ(top[i].second, hitters.estimate(top[i].first));
+        EXPECT_TRUE(tracked.insert(top[i].first).second) << top[i].first;
+
+        if (i) {
+            EXPECT_GE(top[i - 1].second, top[i].second);
+        }
+    }
+
+    // The eight heaviest stand well clear of the addresses past the 16th.
+    for (std::size_t r = 0; r < 8; r++) {
+        EXPECT_TRUE(tracked.count(addrs[r])) << r;
+    }
+
+    hitters.clear();
+
+    EXPECT_TRUE(hitters.top().empty());
+    EXPECT_EQ(hitters.estimate(addrs[0]), 0u);
+}
+
+// Only `k` distinct addresses are ever tracked, however many pass through,
+// and the table still finds every one of them after many evictions.
+TEST(Ipv4HeavyHitters, EvictsLightest)
+{
+    std::mt19937 rng(93);
+    ipv4_heavy_hitters hitters(5, 1 << 20);
+    std::vector<ipv4_address> addrs = distinct_addresses(rng, 200);
+
+    // Each address outweighs all before it once it has been added `i + 1`
+    // times, so the last five end up tracked.
+    for (std::size_t i = 0; i < addrs.size(); i++) {
+        hitters.add(addrs[i], i + 1);
+
+        auto top = hitters.top();
+
+        ASSERT_LE(top.size(), 5u);
+        ASSERT_EQ(top.front().first, addrs[i]);
+    }
+
+    auto top = hitters.top();
+
+    ASSERT_EQ(top.size(), 5u);
+
+    for (std::size_t r = 0; r < 5; r++) {
+        EXPECT_EQ(top[r].first, addrs[addrs.size() - 1 - r]);
+        EXPECT_EQ(top[r].second, addrs.size() - r);
+    }
+
+    // Lighter addresses leave the tracked ones alone.
+    hitters.add(addrs[0], 10);
+
+    EXPECT_EQ(hitters.top(), top);
+}
+
+TEST(Ipv4HeavyHitters, SharedBetweenThreads)
+{
+    std::mt19937 rng(94);
+    std::vector<ipv4_address> addrs = distinct_addresses(rng, 10000);
+    std::vector<ipv4_address> stream = zipf_stream(rng, addrs, 400000);
+    std::unordered_map<ipv4_address, uint32_t> counts;
+    ipv4_heavy_hitters hitters(8, 1 << 16);
+    std::vector<std::thread> threads;
+
+    for (const auto &addr : stream) {
+        counts[addr]++;
+    }
+
+    for (std::size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            std::size_t size = stream.size() / 4;
+            hitters.add(
+                std::span<const ipv4_address>(stream).subspan(t * size, size));
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (const auto &[addr, count] : counts) {
+        ASSERT_GE(hitters.estimate(addr), count) << addr;
+    }
+
+    auto top = hitters.top();
+    std::set<ipv4_address> tracked;
+
+    for (const auto &[addr, estimate] : top) {
+        tracked.insert(addr);
+    }
+
+    EXPECT_EQ(tracked.size(), 8u);
+
+    for (std::size_t r = 0; r < 4; r++) {
+        EXPECT_TRUE(tracked.count(addrs[r])) << r;
+    }
+}
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <nothing/ipv6_address.h>
+
+namespace {
+
+using nothing::ipv4_address;
+using nothing::ipv6_address;
+
+// Returns whether inet_pton() accepts `src`, storing the address in `addr`.
+bool reference_parse(const std::string &src, ipv6_address &addr)
+{
+    in6_addr value;
+
+    if (inet_pton(AF_INET6, src.c_str(), &value) != 1) {
+        return false;
+    }
+
+    ipv6_address::bytes_type bytes;
+    std::memcpy(bytes.data(), value.s6_addr, 16);
+    addr = ipv6_address{ bytes };
+
+    return true;
+}
+
+std::string reference_format(const ipv6_address &addr)
+{
+    in6_addr value;
+    char buf[INET6_ADDRSTRLEN];
+
+    std::memcpy(value.s6_addr, addr.to_bytes().data(), 16);
+    return inet_ntop(AF_INET6, &value, buf, sizeof(buf));
+}
+
+// inet_ntop() prints the deprecated IPv4-compatible addresses, ::/96 above
+// ::ffff, in dotted decimal; format() keeps those in hex.
+bool is_v4_compatible(const ipv6_address &addr)
+{
+    return !addr.high() && addr.low() >> 32 == 0 && addr.low() > 0xFFFF;
+}
+
+// Mostly zero groups, so that runs of every length and position show up.
+ipv6_address random_address(std::mt19937 &rng)
+{
+    ipv6_address::bytes_type bytes;
+
+    for (uint8_t &byte : bytes) {
+        byte = rng() % 4 ? 0 : rng();
+    }
+
+    if (rng() % 8 == 0) {
+        std::memset(bytes.data(), 0, 10);
+        bytes[10] = bytes[11] = 0xFF;
+    }
+
+    return ipv6_address{ bytes };
+}
+
+std::string full_form(const ipv6_address &addr)
+{
+    auto bytes = addr.to_bytes();
+    std::string ret;
+
+    for (int i = 0; i < 16; i += 2) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "%s%X", i ? ":" : "",
+                      bytes[i] << 8 | bytes[i + 1]);
+        ret += buf;
+    }
+
+    return ret;
+}
+
+} // namespace
+
+TEST(Ipv6Address, ParseKnownStrings)
+{
+    const char *valid[] = {
+        "::",
+        "::1",
+        "1::",
+        "1::2",
+        "1:2:3:4:5:6:7::",
+        "::2:3:4:5:6:7:8",
+        "1:2:3:4:5:6:7:8",
+        "1:2:3::6:7:8",
+        "0:0:0:0:0:0:0:0",
+        "FFFF:ffff:FfFf:0:00:000:0000:1",
+        "2001:db8::ff00:42:8329",
+        "::ffff:1.2.3.4",
+        "::1.2.3.4",
+        "1:2:3:4:5:6:1.2.3.4",
+        "1::5:6:255.255.255.255",
+        "fe80::1",
+    };
+    const char *invalid[] = {
+        "",
+        ":",
+        ":::",
+        "1:::2",
+        "::1::",
+        "1::2::3",
+        ":1::2",
+        "1::2:",
+        ":1:2:3:4:5:6:7:8",
+        "1:2:3:4:5:6:7:8:",
+        "1:2:3:4:5:6:7",
+        "1:2:3:4:5:6:7:8:9",
+        "1:2:3:4:5:6:7:8::",
+        "::1:2:3:4:5:6:7:8",
+        "12345::",
+        "1:2:3:4:5:6:7:00000",
+        "g::",
+        "1.2.3.4",
+        "1.2.3.4::",
+        "::ffff:01.2.3.4",
+        "::ffff:1.2.3",
+        "::ffff:1.2.3.256",
+        "::1.2.3.4:5",
+        "1:2:3:4:5:6:7:1.2.3.4",
+        "1:2:3:4:5:6:7:8:1.2.3.4",
+        "1.2.3.4:1::",
+        "fe80::1%eth0",
+        "[::1]",
+        " ::1",
+        "::1 ",
+    };
+
+    for (const char *src : valid) {
+        ipv6_address expected;
+        std::error_code error;
+
+        ASSERT_TRUE(reference_parse(src, expected)) << src;
+        EXPECT_EQ(ipv6_address::from_string(src, error), expected) << src;
+        EXPECT_FALSE(error) << src;
+    }
+
+    for (const char *src : invalid) {
+        ipv6_address ignored;
+        std::error_code error;
+
+        ASSERT_FALSE(reference_parse(src, ignored)) << src;
+        ipv6_address::from_string(src, error);
+        EXPECT_EQ(error, std::errc::invalid_argument) << src;
+        EXPECT_THROW(ipv6_address::from_string(src), std::system_error) << src;
+    }
+}
+
+// Formats random addresses, then parses the text, its uppercase full form
+// and random edits of it, checking each against inet_pton().
+TEST(Ipv6Address, RoundTripMatchesInetPtonAndNtop)
+{
+    std::mt19937 rng(40);
+    const char alphabet[] = "0123456789abcdefABCDEF:.";
+
+    for (int round = 0; round < 100000; round++) {
+        ipv6_address addr = random_address(rng);
+        std::string text = addr.to_string();
+
+        if (!is_v4_compatible(addr)) {
+            ASSERT_EQ(text, reference_format(addr));
+        }
+
+        ASSERT_EQ(ipv6_address::from_string(text), addr) << text;
+        ASSERT_EQ(ipv6_address::from_string(full_form(addr)), addr) << text;
+
+        std::string edit = text;
+
+        for (int i = rng() % 4; i > 0; i--) {
+            char c = alphabet[rng() % (sizeof(alphabet) - 1)];
+            std::size_t pos = rng() % (edit.size() + 1);
+
+            switch (rng() % 3) {
+            case 0:
+                edit.insert(edit.begin() + pos, c);
+                break;
+            case 1:
+                if (pos < edit.size()) {
+                    edit.erase(pos, 1);
+                }
+                break;
+            default:
+                if (pos < edit.size()) {
+                    edit[pos] = c;
+                }
+            }
+        }
+
+        ipv6_address expected;
+        bool valid = reference_parse(edit, expected);
+        std::error_code error;
+        ipv6_address parsed = ipv6_address::from_string(edit, error);
+
+        ASSERT_EQ(!error, valid) << edit;
+
+        if (valid) {
+            ASSERT_EQ(parsed, expected) << edit;
+        }
+    }
+}
+
+TEST(Ipv6Address, FormatRfc5952)
+{
+    struct {
+        const char *src;
+        const char *text;
+    } cases[] = {
+        { "0:0:0:0:0:0:0:0", "::" },
+        { "0:0:0:0:0:0:0:1", "::1" },
+        { "1:0:0:0:0:0:0:0", "1::" },
+        { "2001:DB8:0:0:1:0:0:1", "2001:db8::1:0:0:1" },
+        { "1:0:0:2:0:0:0:3", "1:0:0:2::3" },
+        { "1:0:2:3:4:5:6:7", "1:0:2:3:4:5:6:7" },
+        { "2001:db8:0:0:0:0:2:1", "2001:db8::2:1" },
+        { "2001:0db8:0000:0001:0001:0001:0001:0001",
+          "2001:db8:0:1:1:1:1:1" },
+        { "::ffff:102:304", "::ffff:1.2.3.4" },
+        { "::102:304", "::102:304" },
+    };
+
+    for (auto [src, text] : cases) {
+        ipv6_address addr = ipv6_address::from_string(src);
+        std::string chars;
+        std::ostringstream os;
+
+        addr.to_chars(std::back_inserter(chars));
+        os << addr;
+
+        EXPECT_EQ(addr.to_string(), text) << src;
+        EXPECT_EQ(chars, text) << src;
+        EXPECT_EQ(os.str(), text) << src;
+    }
+
+    std::vector<ipv6_address> addrs{ ipv6_address::loopback(),
+                                     ipv6_address::any() };
+    char buf[2 * ipv6_address::string_size];
+
+    EXPECT_EQ(std::string(buf, nothing::format_many(addrs, buf, ',')),
+              "::1,::");
+}
+
+TEST(Ipv6Address, PrefixAndV4Mapping)
+{
+    std::string_view bracketed = "[2001:db8::1]:443";
+    std::string_view::iterator last;
+    ipv6_address addr = ipv6_address::from_string(bracketed.substr(1), last);
+
+    EXPECT_EQ(addr.to_string(), "2001:db8::1");
+    EXPECT_EQ(*last, ']');
+
+    std::string_view scoped = "fe80::1%eth0";
+    addr = ipv6_address::from_string(scoped, last);
+
+    EXPECT_TRUE(addr.is_link_local());
+    EXPECT_EQ(last - scoped.begin(), 7);
+
+    ipv4_address v4 = ipv4_address::from_string("1.2.3.4");
+    ipv6_address mapped = ipv6_address::v4_mapped(v4);
+
+    EXPECT_TRUE(mapped.is_v4_mapped());
+    EXPECT_EQ(mapped.to_v4(), v4);
+    EXPECT_EQ(ipv6_address::from_string("::ffff:1.2.3.4"), mapped);
+    EXPECT_EQ(mapped.to_string(), "::ffff:1.2.3.4");
+}
+
+TEST(Ipv6Address, ClassifiersOrderAndHash)
+{
+    EXPECT_TRUE(ipv6_address::any().is_unspecified());
+    EXPECT_TRUE(ipv6_address::loopback().is_loopback());
+    EXPECT_TRUE(ipv6_address::from_string("fd00::1").is_private());
+    EXPECT_TRUE(ipv6_address::from_string("ff02::1").is_multicast());
+    EXPECT_FALSE(ipv6_address::from_string("2001:db8::1").is_private());
+
+    EXPECT_LT(ipv6_address::from_string("::1"),
+              ipv6_address::from_string("::2"));
+    EXPECT_GT(ipv6_address::from_string("1::"),
+              ipv6_address::from_string("::ffff"));
+
+    std::unordered_set<ipv6_address> set{ ipv6_address::loopback(),
+                                          ipv6_address::any(),
+                                          ipv6_address::loopback() };
+
+    EXPECT_EQ(set.size(), 2u);
+}
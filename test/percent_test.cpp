@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021-2022 John Hunter Kohler <jhunterkohler@gmail.com>
+ */
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include <nothing/encoding.h>
+
+namespace {
+
+// Lengths on and around every vector width `percent_encode_set::span` uses.
+constexpr std::size_t max_length = 100;
+
+std::string reference_encode(const std::string &src,
+                             const nothing::percent_encode_set &set)
+{
+    const char *digits = "0123456789ABCDEF";
+    std::string ret;
+
+    for (char c : src) {
+        auto value = static_cast<unsigned char>(c);
+
+        if (value > 127 || set.contains(c)) {
+            ret += '%';
+            ret += digits[value >> 4];
+            ret += digits[value & 15];
+        } else {
+            ret += c;
+        }
+    }
+
+    return ret;
+}
+
+std::string random_text(std::mt19937 &rng, std::size_t size,
+                        std::string_view alphabet)
+{
+    std::string ret(size, '\0');
+
+    for (char &c : ret) {
+        c = alphabet[rng() % alphabet.size()];
+    }
+
+    return ret;
+}
+
+std::string contiguous_encode(const std::string &src,
+                              const nothing::percent_encode_set &set)
+{
+    std::string ret(nothing::percent_encoded_size_max(src.size()), '\0');
+    auto res = nothing::percent_encode(src, ret.data(), set);
+    ret.resize(res.out - ret.data());
+    return ret;
+}
+
+std::string scalar_encode(const std::string &src,
+                          const nothing::percent_encode_set &set)
+{
+    std::list<char> chars(src.begin(), src.end());
+    std::string ret;
+    nothing::percent_encode(chars, std::back_inserter(ret), set);
+    return ret;
+}
+
+std::string scalar_decode(const std::string &src)
+{
+    std::list<char> chars(src.begin(), src.end());
+    std::string ret;
+    nothing::percent_decode(chars, std::back_inserter(ret));
+    return ret;
+}
+
+} // namespace
+
+TEST(Percent, ReservedSet)
+{
+    for (int c = 0; c < 256; c++) {
+        bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                          (c >= '0' && c <= '9') || c == '-' || c == '.' ||
+                          c == '_' || c == '~';
+
+        ASSERT_EQ(nothing::percent_reserved.contains(static_cast<char>(c)),
+                  !unreserved)
+            << c;
+    }
+
+    EXPECT_EQ(nothing::percent_encode("a b/c?d=e&f~g"),
+              "a%20b%2Fc%3Fd%3De%26f~g");
+    EXPECT_EQ(nothing::percent_encode<nothing::hex_mode::lower>("\xE2\x82\xAC"),
+              "%e2%82%ac");
+}
+
+// Puts one escaped character at every position of every length, so each
+// lane of each vector block and the scalar tail all see it.
+TEST(Percent, EncodeFindsEscapeAtEveryPosition)
+{
+    std::mt19937 rng(20);
+    std::string_view plain = "abcXYZ019-._~";
+    std::string_view special = " /%?#\x01\x7F\x80\xFF";
+
+    for (std::size_t size = 1; size <= max_length; size++) {
+        std::string text = random_text(rng, size, plain);
+
+        ASSERT_EQ(contiguous_encode(text, nothing::percent_reserved), text);
+        ASSERT_EQ(nothing::percent_reserved.span(text.data(), text.size()),
+                  size);
+
+        for (std::size_t pos = 0; pos < size; pos++) {
+            std::string src = text;
+            src[pos] = special[rng() % special.size()];
+
+            std::string expected =
+                reference_encode(src, nothing::percent_reserved);
+
+            ASSERT_EQ(nothing::percent_reserved.span(src.data(), src.size()),
+                      pos)
+                << "size " << size;
+            ASSERT_EQ(contiguous_encode(src, nothing::percent_reserved),
+                      expected);
+            ASSERT_EQ(scalar_encode(src, nothing::percent_reserved), expected);
+        }
+    }
+}
+
+TEST(Percent, CustomSetsMatchReference)
+{
+    std::mt19937 rng(21);
+    nothing::percent_encode_set empty;
+    nothing::percent_encode_set path =
+        nothing::percent_encode_set(nothing::percent_reserved).remove("/:@");
+    nothing::percent_encode_set few =
+        nothing::percent_encode_set{}.add("aeiou ");
+
+    EXPECT_TRUE(empty.contains('\x80'));
+    EXPECT_FALSE(path.contains('/'));
+    EXPECT_TRUE(few.contains('e'));
+    EXPECT_FALSE(few.contains('%'));
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        std::string src(size, '\0');
+
+        for (char &c : src) {
+            c = static_cast<char>(rng());
+        }
+
+        for (const auto *set : { &empty, &path, &few }) {
+            std::string expected = reference_encode(src, *set);
+
+            ASSERT_EQ(contiguous_encode(src, *set), expected);
+            ASSERT_EQ(scalar_encode(src, *set), expected);
+
+            // Decoding only undoes a set that escapes '%' itself.
+            if (set->contains('%')) {
+                ASSERT_EQ(nothing::percent_decode(expected), src);
+                ASSERT_EQ(scalar_decode(expected), src);
+            }
+        }
+    }
+}
+
+TEST(Percent, DecodeAcceptsEitherCaseAndBareCharacters)
+{
+    EXPECT_EQ(nothing::percent_decode("%41%4a%4A+b"), "AJJ+b");
+    EXPECT_EQ(nothing::percent_decode(""), "");
+    EXPECT_EQ(nothing::percent_decode("%00"), std::string(1, '\0'));
+}
+
+TEST(Percent, DecodeReportsBadEscapePosition)
+{
+    std::mt19937 rng(22);
+
+    // Each bad escape with the offset, from its '%', of the character that
+    // should have been a hex digit.
+    const std::pair<const char *, std::size_t> bad[] = {
+        { "%", 1 }, { "%G0", 1 }, { "%0G", 2 }, { "%%", 1 }, { "%1", 2 },
+    };
+
+    for (std::size_t size = 0; size <= max_length; size++) {
+        // Valid text built from whole characters and escapes.
+        std::string text;
+
+        while (text.size() < size) {
+            text += rng() % 4 ? std::string(1, "abc+"[rng() % 4]) : "%7e";
+        }
+
+        for (auto [escape, digit] : bad) {
+            std::string src = text + escape + "tail";
+            std::size_t offset = text.size() + digit;
+
+            std::string out(src.size(), '\0');
+            auto res = nothing::percent_decode(src, out.data(), std::nothrow);
+
+            ASSERT_EQ(res.ec, std::errc::invalid_argument) << src;
+            ASSERT_EQ(res.offset, offset) << src;
+            ASSERT_EQ(res.in - src.begin(),
+                      static_cast<std::ptrdiff_t>(offset));
+
+            std::list<char> chars(src.begin(), src.end());
+            std::string scalar;
+            auto scalar_res = nothing::percent_decode(
+                chars, std::back_inserter(scalar), std::nothrow);
+
+            ASSERT_EQ(scalar_res.ec, std::errc::invalid_argument);
+            ASSERT_EQ(scalar_res.offset, offset);
+            ASSERT_THROW(nothing::percent_decode(src), std::invalid_argument);
+        }
+    }
+}